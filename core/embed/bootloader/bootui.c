@@ -260,11 +260,6 @@ void ui_screen_install(void) {
                       COLOR_WHITE);
 }
 
-void ui_screen_install_progress_erase(int pos, int len) {
-  display_loader(250 * pos / len, false, -20, COLOR_BL_PROCESS, COLOR_WHITE,
-                 toi_icon_install, sizeof(toi_icon_install), COLOR_BLACK);
-}
-
 void ui_screen_install_progress_upload(int pos) {
   display_loader(pos, false, -20, COLOR_BL_PROCESS, COLOR_WHITE,
                  toi_icon_install, sizeof(toi_icon_install), COLOR_BLACK);
@@ -42,7 +42,6 @@ void ui_screen_install_confirm_newvendor_or_downgrade_wipe(
     const vendor_header* const vhdr, const image_header* const hdr,
     secbool downgrade_wipe);
 void ui_screen_install(void);
-void ui_screen_install_progress_erase(int pos, int len);
 void ui_screen_install_progress_upload(int pos);
 
 void ui_screen_wipe_confirm(void);
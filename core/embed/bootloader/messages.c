@@ -34,6 +34,7 @@
 #include "bootui.h"
 #include "messages.h"
 
+#include "blake2s.h"
 #include "memzero.h"
 
 #define MSG_HEADER1_LEN 9
@@ -328,11 +329,163 @@ void process_msg_Ping(uint8_t iface_num, uint32_t msg_size, uint8_t *buf) {
 
 static uint32_t firmware_remaining, firmware_block, chunk_requested;
 
+static uint32_t chunk_size = 0;
+// SRAM is unused, so we can use it for chunk buffer
+uint8_t *const chunk_buffer = (uint8_t *const)0x20000000;
+
+// The chunk buffer is used as a ring, chunk n is received at the offset
+// n * IMAGE_CHUNK_SIZE modulo CHUNK_RING_SIZE. A verified chunk is programmed
+// while the next one is being received, which may only overwrite the part of
+// the previous chunk that has already been programmed.
+#define CHUNK_RING_SIZE (192 * 1024)
+#define CHUNK_RING_FREE (CHUNK_RING_SIZE - IMAGE_CHUNK_SIZE)
+
+// size of the pieces in which a chunk is received, hashed and programmed
+#define CHUNK_PIECE_SIZE 4096
+
+static uint32_t headers_offset = 0;
+
+// hash of the chunk being received, computed as the data arrives
+static BLAKE2S_CTX chunk_hash;
+static uint32_t chunk_hashed = 0;
+
+// the verified chunk which is being programmed
+static struct {
+  secbool active;
+  uint8_t sector;
+  uint32_t base;  // offset in the chunk ring
+  uint32_t size;
+  uint32_t done;
+} chunk_program;
+
+static inline uint32_t chunk_base(uint32_t block) {
+  return (block * IMAGE_CHUNK_SIZE) % CHUNK_RING_SIZE;
+}
+
+// Calls fn on the len bytes of the chunk ring starting at pos.
+static void chunk_ring_foreach(uint32_t pos, uint32_t len,
+                               void (*fn)(const uint8_t *data, uint32_t len,
+                                          void *ctx),
+                               void *ctx) {
+  while (len > 0) {
+    pos %= CHUNK_RING_SIZE;
+    const uint32_t n = MIN(len, CHUNK_RING_SIZE - pos);
+    fn(chunk_buffer + pos, n, ctx);
+    pos += n;
+    len -= n;
+  }
+}
+
+static void chunk_hash_piece(const uint8_t *data, uint32_t len, void *ctx) {
+  blake2s_Update(ctx, data, len);
+}
+
+// Adds the received bytes of the chunk up to the offset end to the hash.
+static void chunk_hash_update(uint32_t block, uint32_t end) {
+  if (end > chunk_hashed) {
+    chunk_ring_foreach(chunk_base(block) + chunk_hashed, end - chunk_hashed,
+                       chunk_hash_piece, &chunk_hash);
+    chunk_hashed = end;
+  }
+}
+
+// Programs at most len more bytes of the verified chunk.
+static void chunk_program_step(uint32_t len) {
+  if (sectrue != chunk_program.active) {
+    return;
+  }
+  len = MIN(len, chunk_program.size - chunk_program.done);
+  if (len == 0) {
+    return;
+  }
+  ensure(flash_unlock_write(), NULL);
+  while (len > 0) {
+    const uint32_t pos =
+        (chunk_program.base + chunk_program.done) % CHUNK_RING_SIZE;
+    const uint32_t n = MIN(len, CHUNK_RING_SIZE - pos);
+    ensure(flash_write_block(chunk_program.sector, chunk_program.done,
+                             chunk_buffer + pos, n),
+           NULL);
+    chunk_program.done += n;
+    len -= n;
+  }
+  ensure(flash_lock_write(), NULL);
+  if (chunk_program.done == chunk_program.size) {
+    chunk_program.active = secfalse;
+  }
+}
+
+static void chunk_compare_piece(const uint8_t *data, uint32_t len, void *ctx) {
+  const uint8_t **flash = ctx;
+  if (*flash != NULL) {
+    *flash = (0 == memcmp(*flash, data, len)) ? *flash + len : NULL;
+  }
+}
+
+// Returns sectrue if the sector holds exactly the len bytes of the chunk ring
+// starting at base, followed by erased flash.
+static secbool sector_matches_chunk(uint8_t sector, uint32_t base,
+                                    uint32_t len) {
+  const uint8_t *flash = flash_get_address(sector, 0, IMAGE_CHUNK_SIZE);
+  if (flash == NULL) {
+    return secfalse;
+  }
+  const uint8_t *end = flash + IMAGE_CHUNK_SIZE;
+  chunk_ring_foreach(base, len, chunk_compare_piece, &flash);
+  if (flash == NULL) {
+    return secfalse;
+  }
+  for (; flash < end; flash++) {
+    if (*flash != 0xFF) {
+      return secfalse;
+    }
+  }
+  return sectrue;
+}
+
+static secbool sector_is_erased(uint8_t sector) {
+  const uint32_t *flash = flash_get_address(sector, 0, IMAGE_CHUNK_SIZE);
+  if (flash == NULL) {
+    return secfalse;
+  }
+  for (uint32_t i = 0; i < IMAGE_CHUNK_SIZE / sizeof(uint32_t); i++) {
+    if (flash[i] != 0xFFFFFFFF) {
+      return secfalse;
+    }
+  }
+  return sectrue;
+}
+
+// Finishes programming the previous chunk and starts programming the verified
+// chunk of the given block. The sector is erased just before its first use
+// and left untouched if it already holds the chunk.
+static void chunk_program_start(uint32_t block, uint32_t size) {
+  chunk_program_step(UINT32_MAX);
+  const uint8_t sector = FIRMWARE_SECTORS[block];
+  if (sectrue == sector_matches_chunk(sector, chunk_base(block), size)) {
+    return;
+  }
+  if (sectrue != sector_is_erased(sector)) {
+    ensure(flash_erase(sector), NULL);
+  }
+  chunk_program.active = sectrue;
+  chunk_program.sector = sector;
+  chunk_program.base = chunk_base(block);
+  chunk_program.size = size;
+  chunk_program.done = 0;
+}
+
+static void chunk_program_reset(void) {
+  memzero(&chunk_program, sizeof(chunk_program));
+  chunk_program.active = secfalse;
+}
+
 void process_msg_FirmwareErase(uint8_t iface_num, uint32_t msg_size,
                                uint8_t *buf) {
   firmware_remaining = 0;
   firmware_block = 0;
   chunk_requested = 0;
+  chunk_program_reset();
 
   MSG_RECV_INIT(FirmwareErase);
   MSG_RECV(FirmwareErase);
@@ -358,10 +511,6 @@ void process_msg_FirmwareErase(uint8_t iface_num, uint32_t msg_size,
   }
 }
 
-static uint32_t chunk_size = 0;
-// SRAM is unused, so we can use it for chunk buffer
-uint8_t *const chunk_buffer = (uint8_t *const)0x20000000;
-
 /* we don't use secbool/sectrue/secfalse here as it is a nanopb api */
 static bool _read_payload(pb_istream_t *stream, const pb_field_t *field,
                           void **arg) {
@@ -369,34 +518,51 @@ static bool _read_payload(pb_istream_t *stream, const pb_field_t *field,
 
   uint32_t offset = (uint32_t)(*arg);
 
-  if (stream->bytes_left > IMAGE_CHUNK_SIZE) {
+  if (offset + stream->bytes_left > IMAGE_CHUNK_SIZE) {
     chunk_size = 0;
     return false;
   }
 
-  if (offset == 0) {
-    // clear chunk buffer
+  if (offset == 0 && firmware_block == 0) {
+    // clear chunk buffer, nothing is being programmed before the first chunk
+    chunk_program_reset();
     memset(chunk_buffer, 0xFF, IMAGE_CHUNK_SIZE);
   }
 
+  const uint32_t base = chunk_base(firmware_block);
   uint32_t chunk_written = offset;
   chunk_size = offset + stream->bytes_left;
 
+  blake2s_Init(&chunk_hash, BLAKE2S_DIGEST_LENGTH);
+  chunk_hashed = headers_offset;
+  chunk_hash_update(firmware_block, chunk_written);
+
   while (stream->bytes_left) {
     // update loader but skip first block
-    if (firmware_block > 0) {
+    if (firmware_block > 0 && chunk_written % BUFSIZE == 0) {
       ui_screen_install_progress_upload(
-          250 + 750 * (firmware_block * IMAGE_CHUNK_SIZE + chunk_written) /
-                    (firmware_block * IMAGE_CHUNK_SIZE + firmware_remaining));
+          1000 * (firmware_block * IMAGE_CHUNK_SIZE + chunk_written) /
+          (firmware_block * IMAGE_CHUNK_SIZE + firmware_remaining));
+    }
+    const uint32_t pos = (base + chunk_written) % CHUNK_RING_SIZE;
+    uint32_t n = MIN(stream->bytes_left, CHUNK_PIECE_SIZE);
+    n = MIN(n, CHUNK_RING_SIZE - pos);
+
+    // keep programming the previous chunk at the pace of the upload and make
+    // sure that the piece only overwrites its programmed part
+    chunk_program_step(n);
+    if (chunk_written + n > CHUNK_RING_FREE + chunk_program.done) {
+      chunk_program_step(chunk_written + n - CHUNK_RING_FREE -
+                         chunk_program.done);
     }
+
     // read data
-    if (!pb_read(
-            stream, (pb_byte_t *)(chunk_buffer + chunk_written),
-            (stream->bytes_left > BUFSIZE) ? BUFSIZE : stream->bytes_left)) {
+    if (!pb_read(stream, (pb_byte_t *)(chunk_buffer + pos), n)) {
       chunk_size = 0;
       return false;
     }
-    chunk_written += BUFSIZE;
+    chunk_written += n;
+    chunk_hash_update(firmware_block, chunk_written);
   }
 
   return true;
@@ -457,7 +623,6 @@ static void detect_installation(vendor_header *current_vhdr,
 }
 
 static int firmware_upload_chunk_retry = FIRMWARE_UPLOAD_CHUNK_RETRY_COUNT;
-static uint32_t headers_offset = 0;
 static uint32_t read_offset = 0;
 
 int process_msg_FirmwareUpload(uint8_t iface_num, uint32_t msg_size,
@@ -559,9 +724,6 @@ int process_msg_FirmwareUpload(uint8_t iface_num, uint32_t msg_size,
             flash_erase_sectors(STORAGE_SECTORS, STORAGE_SECTORS_COUNT, NULL),
             NULL);
       }
-      ensure(flash_erase_sectors(FIRMWARE_SECTORS, FIRMWARE_SECTORS_COUNT,
-                                 ui_screen_install_progress_erase),
-             NULL);
     }
   }
 
@@ -574,9 +736,14 @@ int process_msg_FirmwareUpload(uint8_t iface_num, uint32_t msg_size,
     return -5;
   }
 
-  if (sectrue != check_single_hash(hdr.hashes + firmware_block * 32,
-                                   chunk_buffer + headers_offset,
-                                   chunk_size - headers_offset)) {
+  // the previous chunk must be programmed before this one is verified, as a
+  // retry overwrites the whole chunk
+  chunk_program_step(UINT32_MAX);
+
+  uint8_t hash[BLAKE2S_DIGEST_LENGTH];
+  blake2s_Final(&chunk_hash, hash, BLAKE2S_DIGEST_LENGTH);
+  if (0 != memcmp(hash, hdr.hashes + firmware_block * 32,
+                  BLAKE2S_DIGEST_LENGTH)) {
     if (firmware_upload_chunk_retry > 0) {
       --firmware_upload_chunk_retry;
       MSG_SEND_INIT(FirmwareRequest);
@@ -593,16 +760,8 @@ int process_msg_FirmwareUpload(uint8_t iface_num, uint32_t msg_size,
     return -6;
   }
 
-  ensure(flash_unlock_write(), NULL);
-
-  const uint32_t *const src = (const uint32_t *const)chunk_buffer;
-  for (int i = 0; i < chunk_size / sizeof(uint32_t); i++) {
-    ensure(flash_write_word(FIRMWARE_SECTORS[firmware_block],
-                            i * sizeof(uint32_t), src[i]),
-           NULL);
-  }
-
-  ensure(flash_lock_write(), NULL);
+  // the chunk is programmed while the next one is being received
+  chunk_program_start(firmware_block, chunk_size);
 
   headers_offset = 0;
   firmware_remaining -= chunk_requested;
@@ -618,6 +777,13 @@ int process_msg_FirmwareUpload(uint8_t iface_num, uint32_t msg_size,
     MSG_SEND_ASSIGN_VALUE(length, chunk_requested);
     MSG_SEND(FirmwareRequest);
   } else {
+    // program the last chunk and erase the rest of the firmware area
+    chunk_program_step(UINT32_MAX);
+    for (uint32_t i = firmware_block; i < FIRMWARE_SECTORS_COUNT; i++) {
+      if (sectrue != sector_is_erased(FIRMWARE_SECTORS[i])) {
+        ensure(flash_erase(FIRMWARE_SECTORS[i]), NULL);
+      }
+    }
     MSG_SEND_INIT(Success);
     MSG_SEND(Success);
   }
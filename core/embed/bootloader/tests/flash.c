@@ -0,0 +1,159 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include "common.h"
+#include "flash.h"
+
+// The flash is mapped at its STM32 address, because the bootloader reads the
+// installed firmware from FIRMWARE_START directly.
+static const uint32_t FLASH_SECTOR_TABLE[FLASH_SECTOR_COUNT + 1] = {
+    [0] = 0x08000000,   // - 0x08003FFF |  16 KiB
+    [1] = 0x08004000,   // - 0x08007FFF |  16 KiB
+    [2] = 0x08008000,   // - 0x0800BFFF |  16 KiB
+    [3] = 0x0800C000,   // - 0x0800FFFF |  16 KiB
+    [4] = 0x08010000,   // - 0x0801FFFF |  64 KiB
+    [5] = 0x08020000,   // - 0x0803FFFF | 128 KiB
+    [6] = 0x08040000,   // - 0x0805FFFF | 128 KiB
+    [7] = 0x08060000,   // - 0x0807FFFF | 128 KiB
+    [8] = 0x08080000,   // - 0x0809FFFF | 128 KiB
+    [9] = 0x080A0000,   // - 0x080BFFFF | 128 KiB
+    [10] = 0x080C0000,  // - 0x080DFFFF | 128 KiB
+    [11] = 0x080E0000,  // - 0x080FFFFF | 128 KiB
+    [12] = 0x08100000,  // - 0x08103FFF |  16 KiB
+    [13] = 0x08104000,  // - 0x08107FFF |  16 KiB
+    [14] = 0x08108000,  // - 0x0810BFFF |  16 KiB
+    [15] = 0x0810C000,  // - 0x0810FFFF |  16 KiB
+    [16] = 0x08110000,  // - 0x0811FFFF |  64 KiB
+    [17] = 0x08120000,  // - 0x0813FFFF | 128 KiB
+    [18] = 0x08140000,  // - 0x0815FFFF | 128 KiB
+    [19] = 0x08160000,  // - 0x0817FFFF | 128 KiB
+    [20] = 0x08180000,  // - 0x0819FFFF | 128 KiB
+    [21] = 0x081A0000,  // - 0x081BFFFF | 128 KiB
+    [22] = 0x081C0000,  // - 0x081DFFFF | 128 KiB
+    [23] = 0x081E0000,  // - 0x081FFFFF | 128 KiB
+    [24] = 0x08200000,  // last element - not a valid sector
+};
+
+const uint8_t FIRMWARE_SECTORS[FIRMWARE_SECTORS_COUNT] = {
+    FLASH_SECTOR_FIRMWARE_START,
+    7,
+    8,
+    9,
+    10,
+    FLASH_SECTOR_FIRMWARE_END,
+    FLASH_SECTOR_FIRMWARE_EXTRA_START,
+    18,
+    19,
+    20,
+    21,
+    22,
+    FLASH_SECTOR_FIRMWARE_EXTRA_END,
+};
+
+const uint8_t STORAGE_SECTORS[STORAGE_SECTORS_COUNT] = {
+    FLASH_SECTOR_STORAGE_1,
+    FLASH_SECTOR_STORAGE_2,
+};
+
+// The number of erases of every sector and the number of programmed bytes.
+uint32_t FLASH_ERASE_COUNT[FLASH_SECTOR_COUNT];
+uint32_t FLASH_WRITE_BYTES = 0;
+
+static secbool flash_unlocked = secfalse;
+
+void flash_init(void) {
+  const uint32_t size =
+      FLASH_SECTOR_TABLE[FLASH_SECTOR_COUNT] - FLASH_SECTOR_TABLE[0];
+  void *start = (void *)(uintptr_t)FLASH_SECTOR_TABLE[0];
+  void *map = mmap(start, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  ensure(sectrue * (map == start), "mmap failed");
+  memset(map, 0xFF, size);
+}
+
+secbool flash_unlock_write(void) {
+  flash_unlocked = sectrue;
+  return sectrue;
+}
+
+secbool flash_lock_write(void) {
+  flash_unlocked = secfalse;
+  return sectrue;
+}
+
+const void *flash_get_address(uint8_t sector, uint32_t offset, uint32_t size) {
+  if (sector >= FLASH_SECTOR_COUNT) {
+    return NULL;
+  }
+  const uint32_t addr = FLASH_SECTOR_TABLE[sector] + offset;
+  const uint32_t next = FLASH_SECTOR_TABLE[sector + 1];
+  if (addr + size > next) {
+    return NULL;
+  }
+  return (const void *)(uintptr_t)addr;
+}
+
+secbool flash_erase_sectors(const uint8_t *sectors, int len,
+                            void (*progress)(int pos, int len)) {
+  if (progress) {
+    progress(0, len);
+  }
+  for (int i = 0; i < len; i++) {
+    const uint8_t sector = sectors[i];
+    if (sector >= FLASH_SECTOR_COUNT) {
+      return secfalse;
+    }
+    memset((void *)(uintptr_t)FLASH_SECTOR_TABLE[sector], 0xFF,
+           FLASH_SECTOR_TABLE[sector + 1] - FLASH_SECTOR_TABLE[sector]);
+    FLASH_ERASE_COUNT[sector]++;
+    if (progress) {
+      progress(i + 1, len);
+    }
+  }
+  return sectrue;
+}
+
+secbool flash_write_block(uint8_t sector, uint32_t offset, const uint8_t *data,
+                          uint32_t len) {
+  uint8_t *flash = (uint8_t *)flash_get_address(sector, offset, len);
+  if (sectrue != flash_unlocked || flash == NULL) {
+    return secfalse;
+  }
+  // programming can only clear bits
+  for (uint32_t i = 0; i < len; i++) {
+    if (data[i] != (data[i] & flash[i])) {
+      return secfalse;
+    }
+  }
+  memcpy(flash, data, len);
+  FLASH_WRITE_BYTES += len;
+  return sectrue;
+}
+
+secbool flash_write_byte(uint8_t sector, uint32_t offset, uint8_t data) {
+  return flash_write_block(sector, offset, &data, sizeof(data));
+}
+
+secbool flash_write_word(uint8_t sector, uint32_t offset, uint32_t data) {
+  return flash_write_block(sector, offset, (const uint8_t *)&data,
+                           sizeof(data));
+}
@@ -0,0 +1,418 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host test of the firmware upload of the bootloader. The messages of a
+// firmware update are passed to messages.c in USB packets, the images are
+// signed with test keys and the flash is checked after every upload.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "blake2s.h"
+#include "bootui.h"
+#include "common.h"
+#include "ed25519-donna/ed25519.h"
+#include "flash.h"
+#include "image.h"
+#include "messages.h"
+#include "messages.pb.h"
+#include "usb.h"
+
+#define CHUNK_BUFFER_START 0x20000000
+#define CHUNK_BUFFER_SIZE (192 * 1024)  // SRAM1 to SRAM3
+
+extern uint32_t FLASH_ERASE_COUNT[FLASH_SECTOR_COUNT];
+extern uint32_t FLASH_WRITE_BYTES;
+
+static const ed25519_secret_key BOOTLOADER_SK = {1};
+static const ed25519_secret_key VENDOR_SK = {2};
+static ed25519_public_key bootloader_pk, vendor_pk;
+
+#define VENDOR_HEADER_SIZE 512
+
+#define test_assert(expr)                                                  \
+  ((expr) ? (void)0                                                        \
+          : (fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, \
+                     #expr),                                               \
+             exit(1)))
+
+// stubs
+
+void __fatal_error(const char *expr, const char *msg, const char *file,
+                   int line, const char *func) {
+  fprintf(stderr, "FATAL ERROR: %s %s %s:%d %s\n", expr, msg ? msg : "",
+          file, line, func);
+  exit(1);
+}
+
+void error_shutdown(const char *line1, const char *line2, const char *line3,
+                    const char *line4) {
+  fprintf(stderr, "ERROR: %s %s %s %s\n", line1, line2, line3, line4);
+  exit(1);
+}
+
+void ui_screen_info(secbool buttons, const vendor_header *const vhdr,
+                    const image_header *const hdr) {
+  (void)buttons, (void)vhdr, (void)hdr;
+}
+
+void ui_screen_install_confirm_upgrade(const vendor_header *const vhdr,
+                                       const image_header *const hdr) {
+  (void)vhdr, (void)hdr;
+}
+
+void ui_screen_install_confirm_newvendor_or_downgrade_wipe(
+    const vendor_header *const vhdr, const image_header *const hdr,
+    secbool downgrade_wipe) {
+  (void)vhdr, (void)hdr, (void)downgrade_wipe;
+}
+
+void ui_screen_install(void) {}
+void ui_screen_install_progress_upload(int pos) { (void)pos; }
+void ui_screen_wipe(void) {}
+void ui_screen_wipe_progress(int pos, int len) { (void)pos, (void)len; }
+void ui_fadein(void) {}
+void ui_fadeout(void) {}
+int ui_user_input(int zones) {
+  (void)zones;
+  return INPUT_CONFIRM;
+}
+
+secbool load_vendor_header_keys(const uint8_t *const data,
+                                vendor_header *const vhdr) {
+  const uint8_t *const keys[] = {bootloader_pk};
+  return load_vendor_header(data, 1, 1, keys, vhdr);
+}
+
+// USB
+
+static uint8_t *usb_in = NULL;
+static uint32_t usb_in_len = 0, usb_in_pos = 0;
+
+static uint8_t usb_out[4 * USB_PACKET_SIZE];
+static uint32_t usb_out_len = 0;
+
+int usb_webusb_read_blocking(uint8_t iface_num, uint8_t *buf, uint32_t len,
+                             int timeout) {
+  (void)iface_num, (void)timeout;
+  test_assert(len == USB_PACKET_SIZE && usb_in_pos + len <= usb_in_len);
+  memcpy(buf, usb_in + usb_in_pos, len);
+  usb_in_pos += len;
+  return len;
+}
+
+int usb_webusb_write_blocking(uint8_t iface_num, const uint8_t *buf,
+                              uint32_t len, int timeout) {
+  (void)iface_num, (void)timeout;
+  test_assert(len == USB_PACKET_SIZE &&
+              usb_out_len + len <= sizeof(usb_out));
+  memcpy(usb_out + usb_out_len, buf, len);
+  usb_out_len += len;
+  return len;
+}
+
+static uint32_t put_varint(uint8_t *buf, uint32_t v) {
+  uint32_t n = 0;
+  do {
+    buf[n++] = (v & 0x7F) | (v > 0x7F ? 0x80 : 0);
+    v >>= 7;
+  } while (v);
+  return n;
+}
+
+static uint32_t get_varint(const uint8_t **p) {
+  uint32_t v = 0;
+  for (int shift = 0;; shift += 7) {
+    const uint8_t b = *(*p)++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return v;
+  }
+}
+
+typedef struct {
+  uint16_t id;
+  uint32_t offset;
+  uint32_t length;
+  uint32_t code;
+  char message[256];
+} response;
+
+// Sends the message in USB packets and returns the response.
+static response call(uint16_t id, const uint8_t *msg, uint32_t len) {
+  const uint32_t packets =
+      1 + (len + USB_PACKET_SIZE - 1) / (USB_PACKET_SIZE - 1);
+  free(usb_in);
+  usb_in = calloc(packets, USB_PACKET_SIZE);
+  test_assert(usb_in != NULL);
+  const uint8_t header[] = {'?', '#', '#', id >> 8, id & 0xFF, len >> 24,
+                            len >> 16, len >> 8, len & 0xFF};
+  memcpy(usb_in, header, sizeof(header));
+  uint32_t in = sizeof(header);
+  for (uint32_t i = 0; i < len; i++) {
+    if (in % USB_PACKET_SIZE == 0) {
+      usb_in[in++] = '?';
+    }
+    usb_in[in++] = msg[i];
+  }
+  usb_in_len = packets * USB_PACKET_SIZE;
+  usb_in_pos = USB_PACKET_SIZE;
+  usb_out_len = 0;
+
+  uint8_t buf[USB_PACKET_SIZE];
+  memcpy(buf, usb_in, USB_PACKET_SIZE);
+  uint16_t msg_id;
+  uint32_t msg_size;
+  test_assert(sectrue == msg_parse_header(buf, &msg_id, &msg_size));
+  switch (msg_id) {
+    case MessageType_MessageType_FirmwareErase:
+      process_msg_FirmwareErase(0, msg_size, buf);
+      break;
+    case MessageType_MessageType_FirmwareUpload:
+      process_msg_FirmwareUpload(0, msg_size, buf);
+      break;
+    default:
+      test_assert(false);
+  }
+
+  // the responses of the upload fit in a single packet
+  response r = {0};
+  test_assert(usb_out_len == USB_PACKET_SIZE);
+  test_assert(sectrue == msg_parse_header(usb_out, &r.id, &msg_size));
+  test_assert(msg_size <= USB_PACKET_SIZE - 9);
+  const uint8_t *p = usb_out + 9, *end = p + msg_size;
+  while (p < end) {
+    const uint32_t key = get_varint(&p);
+    if ((key & 7) == 0) {
+      const uint32_t v = get_varint(&p);
+      if (key >> 3 == 1) {
+        r.offset = r.code = v;
+      } else if (key >> 3 == 2) {
+        r.length = v;
+      }
+    } else {
+      const uint32_t n = get_varint(&p);
+      memcpy(r.message, p, MIN(n, sizeof(r.message) - 1));
+      p += n;
+    }
+  }
+  return r;
+}
+
+// firmware images
+
+static void sign_header(uint8_t *header, uint32_t len,
+                        const ed25519_secret_key sk,
+                        const ed25519_public_key pk) {
+  uint8_t hash[BLAKE2S_DIGEST_LENGTH];
+  memset(header + len - IMAGE_SIG_SIZE, 0, IMAGE_SIG_SIZE);
+  blake2s(header, len, hash, BLAKE2S_DIGEST_LENGTH);
+  header[len - IMAGE_SIG_SIZE] = 1;  // sigmask
+  ed25519_sign(hash, sizeof(hash), sk, pk,
+               header + len - IMAGE_SIG_SIZE + 1);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) { memcpy(p, &v, sizeof(v)); }
+
+// Builds a signed firmware image with codelen bytes of code and returns its
+// length.
+static uint32_t build_image(uint8_t *image, uint32_t codelen, uint32_t version,
+                            uint32_t seed) {
+  memset(image, 0, VENDOR_HEADER_SIZE + IMAGE_HEADER_SIZE);
+
+  uint8_t *vhdr = image;
+  put_u32(vhdr, 0x565A5254);  // TRZV
+  put_u32(vhdr + 4, VENDOR_HEADER_SIZE);
+  vhdr[14] = 1;  // vsig_m
+  vhdr[15] = 1;  // vsig_n
+  memcpy(vhdr + 32, vendor_pk, 32);
+  vhdr[64] = 4;
+  memcpy(vhdr + 65, "test", 4);
+  sign_header(vhdr, VENDOR_HEADER_SIZE, BOOTLOADER_SK, bootloader_pk);
+
+  const uint32_t headers = VENDOR_HEADER_SIZE + IMAGE_HEADER_SIZE;
+  const uint32_t len = headers + codelen;
+  uint32_t x = seed;
+  for (uint32_t i = headers; i < len; i++) {
+    x = x * 1103515245 + 12345;
+    image[i] = x >> 16;
+  }
+
+  uint8_t *hdr = image + VENDOR_HEADER_SIZE;
+  put_u32(hdr, FIRMWARE_IMAGE_MAGIC);
+  put_u32(hdr + 4, IMAGE_HEADER_SIZE);
+  put_u32(hdr + 12, codelen);
+  put_u32(hdr + 16, version);
+  put_u32(hdr + 20, version);
+  for (uint32_t i = 0; i * IMAGE_CHUNK_SIZE < len; i++) {
+    const uint32_t start = (i == 0) ? headers : i * IMAGE_CHUNK_SIZE;
+    const uint32_t end = MIN(len, (i + 1) * IMAGE_CHUNK_SIZE);
+    blake2s(image + start, end - start, hdr + 32 + i * 32,
+            BLAKE2S_DIGEST_LENGTH);
+  }
+  sign_header(hdr, IMAGE_HEADER_SIZE, VENDOR_SK, vendor_pk);
+  return len;
+}
+
+// Uploads the image the way trezorlib does, the chunk of block corrupt_block
+// (not the first one, which holds the headers) is corrupted corrupt_times
+// times. Returns the final response.
+static response upload(const uint8_t *image, uint32_t len,
+                       uint32_t corrupt_block, int corrupt_times) {
+  uint8_t msg[8];
+  const uint32_t n = put_varint(msg + 1, len);
+  msg[0] = (FirmwareErase_length_tag << 3) | 0;
+  response r = call(MessageType_MessageType_FirmwareErase, msg, 1 + n);
+
+  static uint8_t upload_msg[IMAGE_CHUNK_SIZE + 8];
+  uint32_t expected = 0;
+  while (r.id == MessageType_MessageType_FirmwareRequest) {
+    test_assert(r.length > 0 && r.offset + r.length <= len);
+    // the requests are contiguous, except for the retries
+    test_assert(r.offset == expected || r.offset % IMAGE_CHUNK_SIZE == 0);
+    expected = r.offset + r.length;
+
+    upload_msg[0] = (FirmwareUpload_payload_tag << 3) | 2;
+    const uint32_t h = 1 + put_varint(upload_msg + 1, r.length);
+    memcpy(upload_msg + h, image + r.offset, r.length);
+    if (r.offset / IMAGE_CHUNK_SIZE == corrupt_block && corrupt_times > 0) {
+      corrupt_times--;
+      upload_msg[h + r.length / 2] ^= 1;
+    }
+    r = call(MessageType_MessageType_FirmwareUpload, upload_msg,
+             h + r.length);
+  }
+  return r;
+}
+
+static void reset_counters(void) {
+  memset(FLASH_ERASE_COUNT, 0, sizeof(FLASH_ERASE_COUNT));
+  FLASH_WRITE_BYTES = 0;
+}
+
+static uint32_t firmware_erase_count(void) {
+  uint32_t count = 0;
+  for (int i = 0; i < FIRMWARE_SECTORS_COUNT; i++) {
+    count += FLASH_ERASE_COUNT[FIRMWARE_SECTORS[i]];
+  }
+  return count;
+}
+
+// Checks that the firmware sectors hold the image followed by erased flash
+// and that the bootloader accepts the installed firmware.
+static void check_installed(const uint8_t *image, uint32_t len) {
+  for (int i = 0; i < FIRMWARE_SECTORS_COUNT; i++) {
+    const uint8_t *flash =
+        flash_get_address(FIRMWARE_SECTORS[i], 0, IMAGE_CHUNK_SIZE);
+    for (uint32_t j = 0; j < IMAGE_CHUNK_SIZE; j++) {
+      const uint32_t pos = i * IMAGE_CHUNK_SIZE + j;
+      test_assert(flash[j] == (pos < len ? image[pos] : 0xFF));
+    }
+  }
+
+  vendor_header vhdr;
+  image_header hdr;
+  test_assert(sectrue ==
+              load_vendor_header_keys((const uint8_t *)FIRMWARE_START, &vhdr));
+  test_assert(sectrue ==
+              load_image_header((const uint8_t *)FIRMWARE_START + vhdr.hdrlen,
+                                FIRMWARE_IMAGE_MAGIC, FIRMWARE_IMAGE_MAXSIZE,
+                                vhdr.vsig_m, vhdr.vsig_n, vhdr.vpub, &hdr));
+  test_assert(sectrue == check_image_contents(
+                             &hdr, IMAGE_HEADER_SIZE + vhdr.hdrlen,
+                             FIRMWARE_SECTORS, FIRMWARE_SECTORS_COUNT));
+}
+
+static void report(const char *name, uint32_t len) {
+  printf("%-40s %7u bytes: %2u firmware sector erases, %7u bytes programmed\n",
+         name, len, firmware_erase_count(), FLASH_WRITE_BYTES);
+}
+
+int main(void) {
+  void *sram =
+      mmap((void *)CHUNK_BUFFER_START, CHUNK_BUFFER_SIZE,
+           PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  test_assert(sram == (void *)CHUNK_BUFFER_START);
+  flash_init();
+  ed25519_publickey(BOOTLOADER_SK, bootloader_pk);
+  ed25519_publickey(VENDOR_SK, vendor_pk);
+
+  const uint32_t maxlen = FIRMWARE_SECTORS_COUNT * IMAGE_CHUNK_SIZE;
+  uint8_t *fw1 = malloc(maxlen), *fw2 = malloc(maxlen);
+  test_assert(fw1 != NULL && fw2 != NULL);
+  const uint32_t len1 = build_image(fw1, 700 * 1024, 0x00010902, 1);
+  const uint32_t len2 = build_image(
+      fw2, maxlen - VENDOR_HEADER_SIZE - IMAGE_HEADER_SIZE, 0x00010903, 2);
+
+  // old data in all firmware sectors
+  test_assert(sectrue == flash_unlock_write());
+  for (int i = 0; i < FIRMWARE_SECTORS_COUNT; i++) {
+    static const uint8_t old[4096] = {0x5A};
+    for (uint32_t j = 0; j < IMAGE_CHUNK_SIZE; j += sizeof(old)) {
+      test_assert(sectrue ==
+                  flash_write_block(FIRMWARE_SECTORS[i], j, old, sizeof(old)));
+    }
+  }
+  test_assert(sectrue == flash_lock_write());
+
+  response r;
+
+  reset_counters();
+  r = upload(fw1, len1, UINT32_MAX, 0);
+  test_assert(r.id == MessageType_MessageType_Success);
+  check_installed(fw1, len1);
+  test_assert(firmware_erase_count() == FIRMWARE_SECTORS_COUNT);
+  test_assert(FLASH_WRITE_BYTES == len1);
+  report("new installation over old data", len1);
+
+  // the sectors which already hold their chunk are left untouched
+  reset_counters();
+  r = upload(fw1, len1, UINT32_MAX, 0);
+  test_assert(r.id == MessageType_MessageType_Success);
+  check_installed(fw1, len1);
+  test_assert(firmware_erase_count() == 0 && FLASH_WRITE_BYTES == 0);
+  report("same firmware again", len1);
+
+  // maximal size, the chunk ring wraps around several times
+  reset_counters();
+  r = upload(fw2, len2, 3, 1);
+  test_assert(r.id == MessageType_MessageType_Success);
+  check_installed(fw2, len2);
+  report("maximal upgrade, chunk 3 resent once", len2);
+
+  // a chunk which is corrupted more often than retried is rejected
+  reset_counters();
+  r = upload(fw1, len1, 2, FIRMWARE_UPLOAD_CHUNK_RETRY_COUNT + 1);
+  test_assert(r.id == MessageType_MessageType_Failure);
+  test_assert(r.code == FailureType_Failure_ProcessError);
+  test_assert(0 == strcmp(r.message, "Invalid chunk hash"));
+  report("downgrade, chunk 2 always corrupted", len1);
+
+  // and the next upload succeeds
+  reset_counters();
+  r = upload(fw1, len1, UINT32_MAX, 0);
+  test_assert(r.id == MessageType_MessageType_Success);
+  check_installed(fw1, len1);
+  report("downgrade after the failed upload", len1);
+
+  printf("OK\n");
+  return 0;
+}
@@ -369,6 +369,46 @@ STATIC mp_obj_t mod_trezorconfig_next_counter(size_t n_args,
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_trezorconfig_next_counter_obj, 2,
                                            3, mod_trezorconfig_next_counter);
 
+/// def pressure() -> int:
+///     """
+///     Returns how full the storage is in percent.
+///     """
+STATIC mp_obj_t mod_trezorconfig_pressure(void) {
+  return mp_obj_new_int_from_uint(storage_pressure());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mod_trezorconfig_pressure_obj,
+                                 mod_trezorconfig_pressure);
+
+/// def compact_step(max_items: int) -> bool:
+///     """
+///     Performs a part of the storage compaction, copying at most max_items
+///     items. Returns True if the compaction has not finished yet.
+///     """
+STATIC mp_obj_t mod_trezorconfig_compact_step(mp_obj_t max_items) {
+  mp_uint_t items = trezor_obj_get_uint(max_items);
+  if (items > UINT16_MAX) {
+    items = UINT16_MAX;
+  }
+  if (sectrue != storage_compact_step(items)) {
+    return mp_const_false;
+  }
+  return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_trezorconfig_compact_step_obj,
+                                 mod_trezorconfig_compact_step);
+
+/// def idle() -> None:
+///     """
+///     Continues the storage compaction or starts it if the storage is
+///     getting full. Meant to be called while the device is idle.
+///     """
+STATIC mp_obj_t mod_trezorconfig_idle(void) {
+  storage_idle();
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mod_trezorconfig_idle_obj,
+                                 mod_trezorconfig_idle);
+
 /// def wipe() -> None:
 ///     """
 ///     Erases the whole config. Use with caution!
@@ -407,6 +447,10 @@ STATIC const mp_rom_map_elem_t mp_module_trezorconfig_globals_table[] = {
      MP_ROM_PTR(&mod_trezorconfig_set_counter_obj)},
     {MP_ROM_QSTR(MP_QSTR_next_counter),
      MP_ROM_PTR(&mod_trezorconfig_next_counter_obj)},
+    {MP_ROM_QSTR(MP_QSTR_pressure), MP_ROM_PTR(&mod_trezorconfig_pressure_obj)},
+    {MP_ROM_QSTR(MP_QSTR_compact_step),
+     MP_ROM_PTR(&mod_trezorconfig_compact_step_obj)},
+    {MP_ROM_QSTR(MP_QSTR_idle), MP_ROM_PTR(&mod_trezorconfig_idle_obj)},
     {MP_ROM_QSTR(MP_QSTR_wipe), MP_ROM_PTR(&mod_trezorconfig_wipe_obj)},
 };
 STATIC MP_DEFINE_CONST_DICT(mp_module_trezorconfig_globals,
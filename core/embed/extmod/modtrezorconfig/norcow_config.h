@@ -36,6 +36,12 @@
 #define NORCOW_SECTORS \
   { FLASH_SECTOR_STORAGE_1, FLASH_SECTOR_STORAGE_2 }
 
+/*
+ * The maximum number of keys in the RAM index of the norcow sector, every
+ * entry takes 4 bytes of RAM.
+ */
+#define NORCOW_INDEX_SIZE 512
+
 /*
  * Current storage version.
  */
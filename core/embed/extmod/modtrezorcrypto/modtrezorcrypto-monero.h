@@ -1254,6 +1254,249 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
     mod_trezorcrypto_monero_xmr_add_keys3_vartime_obj, 4, 5,
     mod_trezorcrypto_monero_xmr_add_keys3_vartime);
 
+STATIC mp_obj_t xmr_multiexp_common(size_t n_args, const mp_obj_t *args,
+                                    bool vartime) {
+  const bool res_arg = n_args == 4;
+  const int off = res_arg ? 0 : -1;
+  mp_obj_t res = mp_obj_new_ge25519_r(res_arg ? args[0] : mp_const_none);
+  mp_buffer_info_t scalars, points;
+  mp_get_buffer_raise(args[1 + off], &scalars, MP_BUFFER_READ);
+  mp_get_buffer_raise(args[2 + off], &points, MP_BUFFER_READ);
+  const mp_int_t n = mp_obj_get_int(args[3 + off]);
+  if (n < 0 || scalars.len / 32 < (size_t)n || points.len / 32 < (size_t)n) {
+    mp_raise_ValueError("Invalid length");
+  }
+  const int ok = vartime ? xmr_multiexp_vartime(&MP_OBJ_GE25519(res),
+                                                scalars.buf, points.buf, n)
+                         : xmr_multiexp(&MP_OBJ_GE25519(res), scalars.buf,
+                                        points.buf, n);
+  if (!ok) {
+    mp_raise_ValueError("Point decoding error");
+  }
+  return res;
+}
+
+/// def xmr_multiexp(
+///     r: Optional[Ge25519], scalars: bytes, points: bytes, n: int
+/// ) -> Ge25519:
+///     """
+///     s_0 P_0 + ... + s_{n-1} P_{n-1} over packed 32-byte scalars and points
+///     in constant time with respect to the scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_multiexp(size_t n_args,
+                                                     const mp_obj_t *args) {
+  return xmr_multiexp_common(n_args, args, false);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_multiexp_obj, 3, 4,
+    mod_trezorcrypto_monero_xmr_multiexp);
+
+/// def xmr_multiexp_vartime(
+///     r: Optional[Ge25519], scalars: bytes, points: bytes, n: int
+/// ) -> Ge25519:
+///     """
+///     s_0 P_0 + ... + s_{n-1} P_{n-1} over packed 32-byte scalars and points
+///     in variable time, only for public scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_multiexp_vartime(
+    size_t n_args, const mp_obj_t *args) {
+  return xmr_multiexp_common(n_args, args, true);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_multiexp_vartime_obj, 3, 4,
+    mod_trezorcrypto_monero_xmr_multiexp_vartime);
+
+// Returns the buffer of a vector of at least n packed 32-byte keys
+STATIC void *mp_get_key_vector(const mp_obj_t arg, size_t n, mp_uint_t flags) {
+  mp_buffer_info_t buff;
+  mp_get_buffer_raise(arg, &buff, flags);
+  if (buff.len / 32 < n) {
+    mp_raise_ValueError("Invalid length of the key vector");
+  }
+  return buff.buf;
+}
+
+// Returns the number of packed 32-byte keys in a vector
+STATIC size_t mp_get_key_vector_len(const mp_obj_t arg, mp_uint_t flags) {
+  mp_buffer_info_t buff;
+  mp_get_buffer_raise(arg, &buff, flags);
+  return buff.len / 32;
+}
+
+/// def xmr_sc_add_vec(r: bytearray, a: bytes, b: bytes) -> None:
+///     """
+///     r_i = a_i + b_i over len(r) // 32 packed scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_sc_add_vec(const mp_obj_t r,
+                                                       const mp_obj_t a,
+                                                       const mp_obj_t b) {
+  const size_t n = mp_get_key_vector_len(r, MP_BUFFER_WRITE);
+  xmr_sc_add_vec(mp_get_key_vector(r, n, MP_BUFFER_WRITE),
+                 mp_get_key_vector(a, n, MP_BUFFER_READ),
+                 mp_get_key_vector(b, n, MP_BUFFER_READ), n);
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mod_trezorcrypto_monero_xmr_sc_add_vec_obj,
+                                 mod_trezorcrypto_monero_xmr_sc_add_vec);
+
+/// def xmr_sc_sub_vec(r: bytearray, a: bytes, b: bytes) -> None:
+///     """
+///     r_i = a_i - b_i over len(r) // 32 packed scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_sc_sub_vec(const mp_obj_t r,
+                                                       const mp_obj_t a,
+                                                       const mp_obj_t b) {
+  const size_t n = mp_get_key_vector_len(r, MP_BUFFER_WRITE);
+  xmr_sc_sub_vec(mp_get_key_vector(r, n, MP_BUFFER_WRITE),
+                 mp_get_key_vector(a, n, MP_BUFFER_READ),
+                 mp_get_key_vector(b, n, MP_BUFFER_READ), n);
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mod_trezorcrypto_monero_xmr_sc_sub_vec_obj,
+                                 mod_trezorcrypto_monero_xmr_sc_sub_vec);
+
+/// def xmr_sc_mul_vec(r: bytearray, a: bytes, b: bytes) -> None:
+///     """
+///     r_i = a_i * b_i over len(r) // 32 packed scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_sc_mul_vec(const mp_obj_t r,
+                                                       const mp_obj_t a,
+                                                       const mp_obj_t b) {
+  const size_t n = mp_get_key_vector_len(r, MP_BUFFER_WRITE);
+  xmr_sc_mul_vec(mp_get_key_vector(r, n, MP_BUFFER_WRITE),
+                 mp_get_key_vector(a, n, MP_BUFFER_READ),
+                 mp_get_key_vector(b, n, MP_BUFFER_READ), n);
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mod_trezorcrypto_monero_xmr_sc_mul_vec_obj,
+                                 mod_trezorcrypto_monero_xmr_sc_mul_vec);
+
+/// def xmr_sc_muladd_vec(r: bytearray, a: bytes, b: bytes, c: bytes) -> None:
+///     """
+///     r_i = a_i * b_i + c_i over len(r) // 32 packed scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_sc_muladd_vec(
+    size_t n_args, const mp_obj_t *args) {
+  const size_t n = mp_get_key_vector_len(args[0], MP_BUFFER_WRITE);
+  xmr_sc_muladd_vec(mp_get_key_vector(args[0], n, MP_BUFFER_WRITE),
+                    mp_get_key_vector(args[1], n, MP_BUFFER_READ),
+                    mp_get_key_vector(args[2], n, MP_BUFFER_READ),
+                    mp_get_key_vector(args[3], n, MP_BUFFER_READ), n);
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_sc_muladd_vec_obj, 4, 4,
+    mod_trezorcrypto_monero_xmr_sc_muladd_vec);
+
+/// def xmr_sc_fold_vec(
+///     r: bytearray,
+///     a: bytes,
+///     s: Sc25519,
+///     b: Optional[bytes] = None,
+///     t: Optional[Sc25519] = None,
+/// ) -> None:
+///     """
+///     r_i = s a_i + t b_i, or s a_i without b, over len(r) // 32 packed
+///     scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_sc_fold_vec(size_t n_args,
+                                                        const mp_obj_t *args) {
+  const size_t n = mp_get_key_vector_len(args[0], MP_BUFFER_WRITE);
+  const bool folded = n_args == 5 && args[3] != mp_const_none;
+  assert_scalar(args[2]);
+  if (folded) {
+    assert_scalar(args[4]);
+  }
+  xmr_sc_fold_vec(mp_get_key_vector(args[0], n, MP_BUFFER_WRITE),
+                  mp_get_key_vector(args[1], n, MP_BUFFER_READ),
+                  MP_OBJ_C_SCALAR(args[2]),
+                  folded ? mp_get_key_vector(args[3], n, MP_BUFFER_READ) : NULL,
+                  folded ? MP_OBJ_C_SCALAR(args[4]) : NULL, n);
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_sc_fold_vec_obj, 3, 5,
+    mod_trezorcrypto_monero_xmr_sc_fold_vec);
+
+/// def xmr_sc_inner_product(
+///     r: Optional[Sc25519], a: bytes, b: bytes
+/// ) -> Sc25519:
+///     """
+///     a_0 b_0 + ... + a_{n-1} b_{n-1} over the packed scalars a and b
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_sc_inner_product(
+    size_t n_args, const mp_obj_t *args) {
+  const bool res_arg = n_args == 3;
+  const int off = res_arg ? 0 : -1;
+  mp_obj_t res = mp_obj_new_scalar_r(res_arg ? args[0] : mp_const_none);
+  const size_t n = mp_get_key_vector_len(args[1 + off], MP_BUFFER_READ);
+  xmr_sc_inner_product(MP_OBJ_SCALAR(res),
+                       mp_get_key_vector(args[1 + off], n, MP_BUFFER_READ),
+                       mp_get_key_vector(args[2 + off], n, MP_BUFFER_READ), n);
+  return res;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_sc_inner_product_obj, 2, 3,
+    mod_trezorcrypto_monero_xmr_sc_inner_product);
+
+/// def xmr_ge25519_fold_vec(
+///     r: bytearray,
+///     P: bytes,
+///     s: Sc25519,
+///     Q: Optional[bytes] = None,
+///     t: Optional[Sc25519] = None,
+/// ) -> None:
+///     """
+///     R_i = s P_i + t Q_i, or s P_i without Q, over len(r) // 32 packed
+///     points
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_ge25519_fold_vec(
+    size_t n_args, const mp_obj_t *args) {
+  const size_t n = mp_get_key_vector_len(args[0], MP_BUFFER_WRITE);
+  const bool folded = n_args == 5 && args[3] != mp_const_none;
+  assert_scalar(args[2]);
+  if (folded) {
+    assert_scalar(args[4]);
+  }
+  if (!xmr_ge25519_fold_vec(
+          mp_get_key_vector(args[0], n, MP_BUFFER_WRITE),
+          mp_get_key_vector(args[1], n, MP_BUFFER_READ),
+          MP_OBJ_C_SCALAR(args[2]),
+          folded ? mp_get_key_vector(args[3], n, MP_BUFFER_READ) : NULL,
+          folded ? MP_OBJ_C_SCALAR(args[4]) : NULL, n)) {
+    mp_raise_ValueError("Point decoding error");
+  }
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_ge25519_fold_vec_obj, 3, 5,
+    mod_trezorcrypto_monero_xmr_ge25519_fold_vec);
+
+/// def xmr_hash_to_scalar_range(
+///     r: bytearray, buff: bytearray, idx_off: int, start: int
+/// ) -> None:
+///     """
+///     r_i = H_s(buff) with varint(start + i) written at idx_off and the rest
+///     of buff zeroed, over len(r) // 32 scalars
+///     """
+STATIC mp_obj_t mod_trezorcrypto_monero_xmr_hash_to_scalar_range(
+    size_t n_args, const mp_obj_t *args) {
+  const size_t n = mp_get_key_vector_len(args[0], MP_BUFFER_WRITE);
+  mp_buffer_info_t buff;
+  mp_get_buffer_raise(args[1], &buff, MP_BUFFER_WRITE);
+  const mp_int_t idx_off = mp_obj_get_int(args[2]);
+  const mp_int_t start = mp_obj_get_int(args[3]);
+  if (idx_off < 0 || start < 0 ||
+      !xmr_hash_to_scalar_range(mp_get_key_vector(args[0], n, MP_BUFFER_WRITE),
+                                buff.buf, buff.len, idx_off, start, n)) {
+    mp_raise_ValueError("Invalid index");
+  }
+  return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(
+    mod_trezorcrypto_monero_xmr_hash_to_scalar_range_obj, 4, 4,
+    mod_trezorcrypto_monero_xmr_hash_to_scalar_range);
+
 /// def xmr_get_subaddress_secret_key(
 ///     r: Optional[Sc25519], major: int, minor: int, m: Sc25519
 /// ) -> Sc25519:
@@ -2675,6 +2918,26 @@ STATIC const mp_rom_map_elem_t mod_trezorcrypto_monero_globals_table[] = {
      MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_add_keys3_vartime_obj)},
     {MP_ROM_QSTR(MP_QSTR_xmr_get_subaddress_secret_key),
      MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_get_subaddress_secret_key_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_multiexp),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_multiexp_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_multiexp_vartime),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_multiexp_vartime_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_sc_add_vec),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_sc_add_vec_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_sc_sub_vec),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_sc_sub_vec_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_sc_mul_vec),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_sc_mul_vec_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_sc_muladd_vec),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_sc_muladd_vec_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_sc_fold_vec),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_sc_fold_vec_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_sc_inner_product),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_sc_inner_product_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_ge25519_fold_vec),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_ge25519_fold_vec_obj)},
+    {MP_ROM_QSTR(MP_QSTR_xmr_hash_to_scalar_range),
+     MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_hash_to_scalar_range_obj)},
     {MP_ROM_QSTR(MP_QSTR_xmr_gen_c),
      MP_ROM_PTR(&mod_trezorcrypto_monero_xmr_gen_c_obj)},
     {MP_ROM_QSTR(MP_QSTR_ct_equals),
@@ -53,6 +53,11 @@ STATIC mp_obj_t mod_trezorio_poll(mp_obj_t ifaces, mp_obj_t list_ref,
   mp_obj_iter_buf_t iterbuf;
 
   for (;;) {
+#ifdef TREZOR_EMULATOR
+    // interfaces the emulator can block on until the deadline
+    uint8_t wait_read = 0;
+    bool wait_touch = false, wait_write = false;
+#endif
     mp_obj_t iter = mp_getiter(ifaces, &iterbuf);
     mp_obj_t item;
     while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
@@ -60,6 +65,16 @@ STATIC mp_obj_t mod_trezorio_poll(mp_obj_t ifaces, mp_obj_t list_ref,
       const mp_uint_t iface = i & 0x00FF;
       const mp_uint_t mode = i & 0xFF00;
 
+#ifdef TREZOR_EMULATOR
+      if (iface == TOUCH_IFACE) {
+        wait_touch = true;
+      } else if (mode == POLL_READ && iface < 8 * sizeof(wait_read)) {
+        wait_read |= 1 << iface;
+      } else {
+        wait_write = true;
+      }
+#endif
+
       if (iface == TOUCH_IFACE) {
         const uint32_t evt = touch_read();
         if (evt) {
@@ -125,11 +140,21 @@ STATIC mp_obj_t mod_trezorio_poll(mp_obj_t ifaces, mp_obj_t list_ref,
       }
     }
 
-    if (mp_hal_ticks_ms() >= deadline) {
+    const mp_uint_t now = mp_hal_ticks_ms();
+    if (now >= deadline) {
       break;
-    } else {
-      MICROPY_EVENT_POLL_HOOK
     }
+#ifdef TREZOR_EMULATOR
+    // sleep in poll() instead of waking up every millisecond, writes are
+    // almost always possible and keep the short polling interval
+    if (!wait_write) {
+      uint32_t timeout = deadline - now;
+      int fd = wait_touch ? touch_wait_fd(&timeout) : -1;
+      usb_emulated_wait(wait_read, fd, timeout);
+      continue;
+    }
+#endif
+    MICROPY_EVENT_POLL_HOOK
   }
 
   return mp_const_false;
@@ -19,6 +19,7 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include <SDL2/SDL_syswm.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "profile.h"
@@ -58,6 +59,8 @@ static SDL_Surface *PREV_SAVED;
 
 int sdl_display_res_x = DISPLAY_RESX, sdl_display_res_y = DISPLAY_RESY;
 int sdl_touch_offset_x, sdl_touch_offset_y;
+// connection to the windowing system, readable when it has new events
+int sdl_event_fd = -1;
 
 static struct {
   struct {
@@ -119,6 +122,14 @@ void display_init(void) {
     printf("%s\n", SDL_GetError());
     ensure(secfalse, "SDL_CreateWindow error");
   }
+#ifdef SDL_VIDEO_DRIVER_X11
+  SDL_SysWMinfo wminfo;
+  SDL_VERSION(&wminfo.version);
+  if (SDL_GetWindowWMInfo(win, &wminfo) &&
+      wminfo.subsystem == SDL_SYSWM_X11) {
+    sdl_event_fd = ConnectionNumber(wminfo.info.x11.display);
+  }
+#endif
   RENDERER = SDL_CreateRenderer(win, -1, SDL_RENDERER_SOFTWARE);
   if (!RENDERER) {
     printf("%s\n", SDL_GetError());
@@ -626,6 +626,58 @@ static const uint8_t *get_glyph(int font, uint8_t c) {
   return 0;
 }
 
+// color tables of the two most recently used fgcolor/bgcolor pairs
+static struct {
+  uint16_t fgcolor, bgcolor;
+  uint16_t colortable[16];
+} text_colors[2] = {{0, 0, {0}}, {0, 0, {0}}};
+
+static const uint16_t *text_color_table(uint16_t fgcolor, uint16_t bgcolor) {
+  static int last = 0;
+  for (int i = 0; i < 2; i++) {
+    if (text_colors[i].fgcolor == fgcolor &&
+        text_colors[i].bgcolor == bgcolor) {
+      last = i;
+      return text_colors[i].colortable;
+    }
+  }
+  // replace the table that has not been used last
+  last ^= 1;
+  text_colors[last].fgcolor = fgcolor;
+  text_colors[last].bgcolor = bgcolor;
+  set_color_table(text_colors[last].colortable, fgcolor, bgcolor);
+  return text_colors[last].colortable;
+}
+
+#if TREZOR_FONT_BPP == 1
+#define GLYPH_SHADE(v) ((v)*15)
+#elif TREZOR_FONT_BPP == 2
+#define GLYPH_SHADE(v) ((v)*5)
+#elif TREZOR_FONT_BPP == 4
+#define GLYPH_SHADE(v) (v)
+#elif TREZOR_FONT_BPP == 8
+#define GLYPH_SHADE(v) ((v) >> 4)
+#else
+#error Unsupported TREZOR_FONT_BPP value
+#endif
+#define GLYPH_MASK ((1 << TREZOR_FONT_BPP) - 1)
+
+// Sends count pixels of the glyph data starting with pixel a. The pixels are
+// packed MSB first, so the data is walked with a running byte and shift.
+static inline void glyph_blit_run(const uint8_t *data, int a, int count,
+                                  const uint16_t *colortable) {
+  const uint8_t *p = data + a * TREZOR_FONT_BPP / 8;
+  int shift = 8 - TREZOR_FONT_BPP - (a * TREZOR_FONT_BPP) % 8;
+  for (int k = 0; k < count; k++) {
+    PIXELDATA(colortable[GLYPH_SHADE((*p >> shift) & GLYPH_MASK)]);
+    shift -= TREZOR_FONT_BPP;
+    if (shift < 0) {
+      shift += 8;
+      p++;
+    }
+  }
+}
+
 static void display_text_render(int x, int y, const char *text, int textlen,
                                 int font, uint16_t fgcolor, uint16_t bgcolor) {
   // determine text length if not provided
@@ -633,8 +685,7 @@ static void display_text_render(int x, int y, const char *text, int textlen,
     textlen = strlen(text);
   }
 
-  uint16_t colortable[16];
-  set_color_table(colortable, fgcolor, bgcolor);
+  const uint16_t *colortable = text_color_table(fgcolor, bgcolor);
 
   // render glyphs
   for (int i = 0; i < textlen; i++) {
@@ -650,24 +701,18 @@ static void display_text_render(int x, int y, const char *text, int textlen,
       const int sy = y - bearY;
       int x0, y0, x1, y1;
       clamp_coords(sx, sy, w, h, &x0, &y0, &x1, &y1);
+      if (x0 > x1 || y0 > y1) {
+        x += adv;
+        continue;
+      }
       display_set_window(x0, y0, x1, y1);
-      for (int j = y0; j <= y1; j++) {
-        for (int i = x0; i <= x1; i++) {
-          const int rx = i - sx;
-          const int ry = j - sy;
-          const int a = rx + ry * w;
-#if TREZOR_FONT_BPP == 1
-          const uint8_t c = ((g[5 + a / 8] >> (7 - (a % 8) * 1)) & 0x01) * 15;
-#elif TREZOR_FONT_BPP == 2
-          const uint8_t c = ((g[5 + a / 4] >> (6 - (a % 4) * 2)) & 0x03) * 5;
-#elif TREZOR_FONT_BPP == 4
-          const uint8_t c = (g[5 + a / 2] >> (4 - (a % 2) * 4)) & 0x0F;
-#elif TREZOR_FONT_BPP == 8
-          const uint8_t c = g[5 + a / 1] >> 4;
-#else
-#error Unsupported TREZOR_FONT_BPP value
-#endif
-          PIXELDATA(colortable[c]);
+      if (x0 == sx && x1 == sx + w - 1) {
+        // whole rows are visible, the window is one continuous run
+        glyph_blit_run(g + 5, (y0 - sy) * w, (y1 - y0 + 1) * w, colortable);
+      } else {
+        for (int j = y0; j <= y1; j++) {
+          glyph_blit_run(g + 5, (x0 - sx) + (j - sy) * w, x1 - x0 + 1,
+                         colortable);
         }
       }
     }
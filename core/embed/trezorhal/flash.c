@@ -177,6 +177,47 @@ secbool flash_write_word(uint8_t sector, uint32_t offset, uint32_t data) {
   return sectrue;
 }
 
+secbool flash_write_block(uint8_t sector, uint32_t offset, const uint8_t *data,
+                          uint32_t len) {
+  const uint8_t *flash = flash_get_address(sector, offset, len);
+  if (flash == NULL) {
+    return secfalse;
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    if (data[i] != (data[i] & flash[i])) {
+      return secfalse;
+    }
+  }
+  const uint32_t address = (uint32_t)flash;
+  uint32_t i = 0;
+  // bytes before the first word boundary
+  for (; i < len && (address + i) % sizeof(uint32_t); i++) {
+    if (data[i] != flash[i] &&
+        HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, address + i,
+                                    data[i])) {
+      return secfalse;
+    }
+  }
+  for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+    uint32_t word = 0;
+    memcpy(&word, data + i, sizeof(word));
+    if (word != *((const uint32_t *)(address + i)) &&
+        HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i,
+                                    word)) {
+      return secfalse;
+    }
+  }
+  // bytes after the last word boundary
+  for (; i < len; i++) {
+    if (data[i] != flash[i] &&
+        HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE, address + i,
+                                    data[i])) {
+      return secfalse;
+    }
+  }
+  return sectrue * (memcmp(flash, data, len) == 0);
+}
+
 #define FLASH_OTP_LOCK_BASE 0x1FFF7A00U
 
 secbool flash_otp_read(uint8_t block, uint8_t offset, uint8_t *data,
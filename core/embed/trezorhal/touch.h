@@ -33,6 +33,11 @@ void touch_sensitivity(uint8_t value);
 uint32_t touch_read(void);
 uint32_t touch_click(void);
 uint32_t touch_is_detected(void);
+#ifdef TREZOR_EMULATOR
+// Returns a file descriptor that becomes readable on new input events or -1,
+// lowers timeout if the events are pending or have to be polled.
+int touch_wait_fd(uint32_t *timeout);
+#endif
 static inline uint16_t touch_unpack_x(uint32_t evt) {
   return (evt >> 12) & 0xFFF;
 }
@@ -144,4 +144,11 @@ void usb_deinit(void);
 void usb_start(void);
 void usb_stop(void);
 
+#ifdef TREZOR_EMULATOR
+// Blocks until one of the interfaces set in the read_ifaces bitmask has
+// received data, fd becomes readable (if not negative) or timeout
+// milliseconds elapse.
+void usb_emulated_wait(uint8_t read_ifaces, int fd, uint32_t timeout);
+#endif
+
 #endif
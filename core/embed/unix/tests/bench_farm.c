@@ -0,0 +1,218 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark of the emulator farm. It starts instances that run the
+// flash and USB startup of the unix port: map the flash, read the storage,
+// write a few words to it, bind the interfaces to free ports and signal
+// readiness. The instances use either a private flash file each or one
+// shared flash template. It prints the time until every instance is ready
+// and the memory of the flash mappings.
+//
+//   make -C embed/unix/tests bench_farm && embed/unix/tests/bench_farm 32
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "flash.h"
+#include "usb.h"
+
+#define MAX_INSTANCES 256
+#define STORAGE_SECTOR_SIZE 0x10000
+#define STORAGE_WRITES 16
+
+void __attribute__((noreturn))
+__fatal_error(const char *expr, const char *msg, const char *file, int line,
+              const char *func) {
+  printf("FATAL ERROR: %s %s (%s:%d %s)\n", expr, msg ? msg : "", file, line,
+         func);
+  exit(1);
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int instance(void) {
+  flash_init();
+
+  // the storage scans both of its sectors and appends to one of them
+  volatile uint32_t sum = 0;
+  for (int i = 0; i < STORAGE_SECTORS_COUNT; i++) {
+    const uint32_t *data =
+        flash_get_address(STORAGE_SECTORS[i], 0, STORAGE_SECTOR_SIZE);
+    ensure(sectrue * (data != NULL), NULL);
+    for (uint32_t j = 0; j < STORAGE_SECTOR_SIZE / sizeof(uint32_t); j++) {
+      sum += data[j];
+    }
+  }
+  ensure(flash_unlock_write(), NULL);
+  for (int i = 0; i < STORAGE_WRITES; i++) {
+    ensure(flash_write_word(STORAGE_SECTORS[0], i * sizeof(uint32_t), i),
+           NULL);
+  }
+  ensure(flash_lock_write(), NULL);
+
+  usb_init(NULL);
+  for (uint8_t iface = 0; iface < 2; iface++) {
+    usb_webusb_info_t info = {.iface_num = iface};
+    usb_webusb_add(&info);
+  }
+  usb_start();
+
+  // idle until the launcher terminates this instance
+  for (;;) {
+    usb_emulated_wait(0x03, -1, 1000);
+  }
+}
+
+// sums a field of the smaps entries of a process whose path contains name
+static unsigned long smaps_kb(pid_t pid, const char *name, const char *field) {
+  char path[64], line[512];
+  snprintf(path, sizeof(path), "/proc/%d/smaps", pid);
+  FILE *f = fopen(path, "r");
+  ensure(sectrue * (f != NULL), NULL);
+  unsigned long total = 0;
+  bool match = false;
+  const size_t len = strlen(field);
+  while (fgets(line, sizeof(line), f)) {
+    // a mapping starts with its address range, its fields follow
+    if (line[strcspn(line, " ")] == ' ' && strchr(line, '-') != NULL &&
+        strchr(line, '-') < strchr(line, ' ')) {
+      match = strstr(line, name) != NULL;
+    } else if (match && strncmp(line, field, len) == 0 && line[len] == ':') {
+      total += strtoul(line + len + 1, NULL, 10);
+    }
+  }
+  fclose(f);
+  return total;
+}
+
+static void farm(const char *self, const char *dir, bool shared, int count) {
+  static pid_t pids[MAX_INSTANCES];
+  static int ready_fds[MAX_INSTANCES];
+  static double started[MAX_INSTANCES];
+  char path[256];
+
+  const uint32_t flash_size = 0x08200000 - 0x08000000;
+  snprintf(path, sizeof(path), "%s/template.flash", dir);
+  if (shared) {
+    // the launcher prepares the template once
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    ensure(sectrue * (fd >= 0), NULL);
+    static uint8_t erased[0x10000];
+    memset(erased, 0xFF, sizeof(erased));
+    for (uint32_t i = 0; i < flash_size; i += sizeof(erased)) {
+      ensure(sectrue * (write(fd, erased, sizeof(erased)) == sizeof(erased)),
+             NULL);
+    }
+    ensure(sectrue * (fsync(fd) == 0), NULL);
+    close(fd);
+  }
+
+  const double start = now();
+  for (int i = 0; i < count; i++) {
+    int fds[2];
+    ensure(sectrue * (pipe(fds) == 0), NULL);
+    started[i] = now();
+    pids[i] = fork();
+    ensure(sectrue * (pids[i] >= 0), NULL);
+    if (pids[i] == 0) {
+      char value[256];
+      close(fds[0]);
+      snprintf(value, sizeof(value), "%d", fds[1]);
+      setenv("TREZOR_READY_FD", value, 1);
+      setenv("TREZOR_UDP_PORT", "0", 1);
+      if (shared) {
+        setenv("TREZOR_FLASH_TEMPLATE", path, 1);
+      } else {
+        snprintf(value, sizeof(value), "%s/%d", dir, i);
+        mkdir(value, 0700);
+        setenv("TREZOR_PROFILE_DIR", value, 1);
+      }
+      execl(self, self, "instance", NULL);
+      _exit(1);
+    }
+    close(fds[1]);
+    ready_fds[i] = fds[0];
+  }
+
+  double sum = 0, max = 0;
+  for (int i = 0; i < count; i++) {
+    char line[16] = {0};
+    ensure(sectrue * (read(ready_fds[i], line, sizeof(line) - 1) > 0),
+           "instance failed");
+    close(ready_fds[i]);
+    const double t = now() - started[i];
+    sum += t;
+    if (t > max) {
+      max = t;
+    }
+  }
+  const double total = now() - start;
+
+  unsigned long pss = 0, dirty = 0;
+  for (int i = 0; i < count; i++) {
+    const char *name = shared ? "template.flash" : "trezor.flash";
+    pss += smaps_kb(pids[i], name, "Pss");
+    dirty += smaps_kb(pids[i], name, "Private_Dirty");
+  }
+  for (int i = 0; i < count; i++) {
+    kill(pids[i], SIGTERM);
+    waitpid(pids[i], NULL, 0);
+  }
+
+  printf("%-8s %3d instances: all ready in %6.1f ms, per instance "
+         "mean %5.1f ms max %5.1f ms; flash Pss %5lu KiB, private dirty %4lu "
+         "KiB, flash files %5u KiB\n",
+         shared ? "template" : "private", count, total * 1e3,
+         sum / count * 1e3, max * 1e3, pss, dirty,
+         (shared ? 1 : count) * flash_size / 1024);
+}
+
+int main(int argc, char **argv) {
+  if (argc == 2 && strcmp(argv[1], "instance") == 0) {
+    return instance();
+  }
+  const int count = argc > 1 ? atoi(argv[1]) : 16;
+  ensure(sectrue * (count > 0 && count <= MAX_INSTANCES), "1-256 instances");
+
+  char dir[] = "/tmp/bench_farm.XXXXXX";
+  ensure(sectrue * (mkdtemp(dir) != NULL), NULL);
+  char self[256] = {0};
+  ensure(sectrue * (readlink("/proc/self/exe", self, sizeof(self) - 1) > 0),
+         NULL);
+
+  farm(self, dir, false, count);
+  farm(self, dir, true, count);
+
+  char cmd[64];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+  return system(cmd);
+}
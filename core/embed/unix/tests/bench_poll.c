@@ -0,0 +1,177 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark of the idle wait of io.poll on the unix port. The loop of
+// mod_trezorio_poll is reproduced for a headless emulator reading its two
+// USB interfaces, once sleeping 1 ms per round as MICROPY_EVENT_POLL_HOOK
+// did, once blocking in usb_emulated_wait(). It prints the wakeups and the
+// CPU time of an idle emulator and the latency of incoming packets.
+//
+//   make -C embed/unix/tests bench_poll && embed/unix/tests/bench_poll
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+
+#include "common.h"
+#include "usb.h"
+
+#define IDLE_SECONDS 3
+#define PACKETS 200
+#define POLL_TIMEOUT 1000
+
+void __attribute__((noreturn))
+__fatal_error(const char *expr, const char *msg, const char *file, int line,
+              const char *func) {
+  printf("FATAL ERROR: %s %s (%s:%d %s)\n", expr, msg ? msg : "", file, line,
+         func);
+  exit(1);
+}
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static double cpu_seconds(void) {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+         (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static uint32_t wakeups;
+
+// returns the interface that became readable, or -1 after timeout ms
+static int poll_read(bool blocking, uint32_t timeout) {
+  const uint32_t deadline = now_us() / 1000 + timeout;
+  for (;;) {
+    wakeups++;
+    for (uint8_t iface = 0; iface < 2; iface++) {
+      if (sectrue == usb_webusb_can_read(iface)) {
+        return iface;
+      }
+    }
+    const uint32_t now = now_us() / 1000;
+    if (now >= deadline) {
+      return -1;
+    }
+    if (blocking) {
+      usb_emulated_wait(0x03, -1, deadline - now);
+    } else {
+      usleep(1000);
+    }
+  }
+}
+
+// sends a packet with its send time to the first interface every 5-25 ms
+static void sender(uint16_t port) {
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  struct sockaddr_in si = {0};
+  si.sin_family = AF_INET;
+  si.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  si.sin_port = htons(port);
+  srand(1);
+  for (int i = 0; i < PACKETS; i++) {
+    usleep(5000 + rand() % 20000);
+    uint8_t buf[64] = {0};
+    uint64_t t = now_us();
+    memcpy(buf, &t, sizeof(t));
+    sendto(sock, buf, sizeof(buf), 0, (struct sockaddr *)&si, sizeof(si));
+  }
+  _exit(0);
+}
+
+static int compare(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void bench(bool blocking, uint16_t port) {
+  // idle, nobody talks to the emulator
+  wakeups = 0;
+  double cpu = cpu_seconds();
+  uint64_t start = now_us();
+  while (now_us() - start < IDLE_SECONDS * 1000000) {
+    poll_read(blocking, POLL_TIMEOUT);
+  }
+  cpu = cpu_seconds() - cpu;
+  const double wall = (now_us() - start) / 1e6;
+  const uint32_t idle_wakeups = wakeups;
+
+  // latency from sendto() until io.poll reports the interface readable
+  static uint64_t latency[PACKETS];
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    sender(port);
+  }
+  for (int i = 0; i < PACKETS;) {
+    if (poll_read(blocking, POLL_TIMEOUT) == 0) {
+      uint64_t t = now_us();
+      uint8_t buf[64];
+      usb_webusb_read(0, buf, sizeof(buf));
+      memcpy(&latency[i], buf, sizeof(latency[i]));
+      latency[i] = t - latency[i];
+      i++;
+    }
+  }
+  waitpid(pid, NULL, 0);
+  qsort(latency, PACKETS, sizeof(latency[0]), compare);
+
+  printf("%-9s idle: %7.0f wakeups/s, %5.1f %% CPU; latency: median %5llu "
+         "us, p99 %5llu us\n",
+         blocking ? "blocking" : "1 ms", idle_wakeups / wall, cpu / wall * 100,
+         (unsigned long long)latency[PACKETS / 2],
+         (unsigned long long)latency[PACKETS * 99 / 100]);
+}
+
+int main(void) {
+  // the wire interface and the debug link, on free ports
+  setenv("TREZOR_UDP_PORT", "0", 1);
+  int fds[2];
+  ensure(sectrue * (pipe(fds) == 0), NULL);
+  char ready[16];
+  snprintf(ready, sizeof(ready), "%d", fds[1]);
+  setenv("TREZOR_READY_FD", ready, 1);
+
+  usb_init(NULL);
+  for (uint8_t iface = 0; iface < 2; iface++) {
+    usb_webusb_info_t info = {.iface_num = iface};
+    usb_webusb_add(&info);
+  }
+  usb_start();
+
+  char line[16] = {0};
+  ensure(sectrue * (read(fds[0], line, sizeof(line) - 1) > 0), NULL);
+  const uint16_t port = atoi(line);
+
+  bench(false, port);
+  bench(true, port);
+  return 0;
+}
@@ -19,11 +19,16 @@
 
 #include <SDL2/SDL.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "touch.h"
 
 extern int sdl_display_res_x, sdl_display_res_y;
 extern int sdl_touch_offset_x, sdl_touch_offset_y;
+extern int sdl_event_fd;
+
+// how often the events are polled when they cannot be waited for
+#define TOUCH_POLL_INTERVAL 16
 
 extern void __shutdown(void);
 extern const char *display_save(const char *prefix);
@@ -112,3 +117,27 @@ uint32_t touch_read(void) {
   }
   return 0;
 }
+
+int touch_wait_fd(uint32_t *timeout) {
+  if (!SDL_WasInit(SDL_INIT_VIDEO)) {
+    return -1;
+  }
+  SDL_PumpEvents();
+  if (SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)) {
+    *timeout = 0;
+    return -1;
+  }
+  if (sdl_event_fd >= 0) {
+    return sdl_event_fd;
+  }
+  // headless drivers have no input, the others are polled
+  const char *driver = SDL_GetCurrentVideoDriver();
+  if (driver == NULL || strcmp(driver, "dummy") == 0 ||
+      strcmp(driver, "offscreen") == 0) {
+    return -1;
+  }
+  if (*timeout > TOUCH_POLL_INTERVAL) {
+    *timeout = TOUCH_POLL_INTERVAL;
+  }
+  return -1;
+}
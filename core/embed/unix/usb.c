@@ -20,11 +20,14 @@
 #include <arpa/inet.h>
 #include <assert.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "touch.h"
 #include "usb.h"
@@ -43,9 +46,12 @@ __fatal_error(const char *expr, const char *msg, const char *file, int line,
 // emulator opens UDP server on TREZOR_UDP_PORT port
 // and emulates HID/WebUSB interface TREZOR_UDP_IFACE
 // gracefully ignores all other USB interfaces
+// TREZOR_UDP_PORT=0 picks free ports, the first one is written to the file
+// descriptor in TREZOR_READY_FD once the interfaces are bound
 
 #define USBD_MAX_NUM_INTERFACES 8
 #define TREZOR_UDP_PORT 21324
+#define USB_PORT_TRIES 16
 
 static struct {
   usb_iface_type_t type;
@@ -67,11 +73,9 @@ void usb_init(const usb_dev_info_t *dev_info) {
 
 void usb_deinit(void) {}
 
-void usb_start(void) {
-  const char *ip = getenv("TREZOR_UDP_IP");
-  const char *port = getenv("TREZOR_UDP_PORT");
-
-  // iterate interfaces
+// binds the sockets of all enabled interfaces to consecutive ports starting
+// at port, returns secfalse if one of them is in use
+static secbool usb_emulated_bind(const char *ip, uint16_t port) {
   for (int i = 0; i < USBD_MAX_NUM_INTERFACES; i++) {
     // skip if not HID or WebUSB interface
     if (usb_ifaces[i].type != USB_IFACE_TYPE_HID &&
@@ -90,16 +94,68 @@ void usb_start(void) {
     } else {
       usb_ifaces[i].si_me.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
     }
-    if (port) {
-      usb_ifaces[i].si_me.sin_port = htons(atoi(port) + i);
-    } else {
-      usb_ifaces[i].si_me.sin_port = htons(TREZOR_UDP_PORT + i);
+    usb_ifaces[i].si_me.sin_port = htons(port + i);
+
+    if (0 != bind(usb_ifaces[i].sock, (struct sockaddr *)&usb_ifaces[i].si_me,
+                  sizeof(struct sockaddr_in))) {
+      for (int j = 0; j <= i; j++) {
+        if (usb_ifaces[j].sock >= 0) {
+          close(usb_ifaces[j].sock);
+          usb_ifaces[j].sock = -1;
+        }
+      }
+      return secfalse;
     }
+  }
+  return sectrue;
+}
+
+// lets the kernel pick a free port for the first interface
+static uint16_t usb_emulated_free_port(const char *ip) {
+  struct sockaddr_in si = {0};
+  socklen_t sl = sizeof(si);
+  si.sin_family = AF_INET;
+  si.sin_addr.s_addr = ip ? inet_addr(ip) : htonl(INADDR_LOOPBACK);
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  ensure(sectrue * (sock >= 0), NULL);
+  ensure(sectrue * (0 == bind(sock, (struct sockaddr *)&si, sizeof(si))),
+         NULL);
+  ensure(sectrue * (0 == getsockname(sock, (struct sockaddr *)&si, &sl)),
+         NULL);
+  close(sock);
+  return ntohs(si.sin_port);
+}
 
-    ensure(sectrue * (0 == bind(usb_ifaces[i].sock,
-                                (struct sockaddr *)&usb_ifaces[i].si_me,
-                                sizeof(struct sockaddr_in))),
-           NULL);
+void usb_start(void) {
+  const char *ip = getenv("TREZOR_UDP_IP");
+  const char *port = getenv("TREZOR_UDP_PORT");
+  static uint16_t usb_port = 0;
+
+  if (usb_port == 0) {
+    usb_port = port ? atoi(port) : TREZOR_UDP_PORT;
+  }
+  if (usb_port != 0) {
+    ensure(usb_emulated_bind(ip, usb_port), NULL);
+  } else {
+    // port 0 asks for automatic allocation, a free port may be taken by
+    // another instance before all interfaces are bound
+    for (int tries = 0; usb_port == 0; tries++) {
+      ensure(sectrue * (tries < USB_PORT_TRIES), "no free port");
+      uint16_t p = usb_emulated_free_port(ip);
+      if (p <= 0xFFFF - USBD_MAX_NUM_INTERFACES &&
+          sectrue == usb_emulated_bind(ip, p)) {
+        usb_port = p;
+      }
+    }
+  }
+
+  // tell the launcher that the emulator is reachable and on which port
+  const char *ready = getenv("TREZOR_READY_FD");
+  if (ready) {
+    int fd = atoi(ready);
+    dprintf(fd, "%d\n", usb_port);
+    close(fd);
+    unsetenv("TREZOR_READY_FD");
   }
 }
 
@@ -137,6 +193,27 @@ static secbool usb_emulated_poll(uint8_t iface_num, short dir) {
   return sectrue * (r > 0);
 }
 
+void usb_emulated_wait(uint8_t read_ifaces, int fd, uint32_t timeout) {
+  struct pollfd fds[USBD_MAX_NUM_INTERFACES + 1];
+  nfds_t n = 0;
+  for (int i = 0; i < USBD_MAX_NUM_INTERFACES; i++) {
+    if ((read_ifaces & (1 << i)) && usb_ifaces[i].sock >= 0) {
+      fds[n].fd = usb_ifaces[i].sock;
+      fds[n].events = POLLIN;
+      fds[n].revents = 0;
+      n++;
+    }
+  }
+  if (fd >= 0) {
+    fds[n].fd = fd;
+    fds[n].events = POLLIN;
+    fds[n].revents = 0;
+    n++;
+  }
+  // an interrupting signal just ends the wait early
+  poll(fds, n, timeout > INT_MAX ? INT_MAX : (int)timeout);
+}
+
 static int usb_emulated_read(uint8_t iface_num, uint8_t *buf, uint32_t len) {
   struct sockaddr_in si;
   socklen_t sl = sizeof(si);
@@ -134,6 +134,29 @@ def next_counter(
     """
 
 
+# extmod/modtrezorconfig/modtrezorconfig.c
+def pressure() -> int:
+    """
+    Returns how full the storage is in percent.
+    """
+
+
+# extmod/modtrezorconfig/modtrezorconfig.c
+def compact_step(max_items: int) -> bool:
+    """
+    Performs a part of the storage compaction, copying at most max_items
+    items. Returns True if the compaction has not finished yet.
+    """
+
+
+# extmod/modtrezorconfig/modtrezorconfig.c
+def idle() -> None:
+    """
+    Continues the storage compaction or starts it if the storage is
+    getting full. Meant to be called while the device is idle.
+    """
+
+
 # extmod/modtrezorconfig/modtrezorconfig.c
 def wipe() -> None:
     """
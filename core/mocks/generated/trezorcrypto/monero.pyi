@@ -386,6 +386,101 @@ def xmr_add_keys3_vartime(
     """
 
 
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_multiexp(
+    r: Optional[Ge25519], scalars: bytes, points: bytes, n: int
+) -> Ge25519:
+    """
+    s_0 P_0 + ... + s_{n-1} P_{n-1} over packed 32-byte scalars and points
+    in constant time with respect to the scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_multiexp_vartime(
+    r: Optional[Ge25519], scalars: bytes, points: bytes, n: int
+) -> Ge25519:
+    """
+    s_0 P_0 + ... + s_{n-1} P_{n-1} over packed 32-byte scalars and points
+    in variable time, only for public scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_sc_add_vec(r: bytearray, a: bytes, b: bytes) -> None:
+    """
+    r_i = a_i + b_i over len(r) // 32 packed scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_sc_sub_vec(r: bytearray, a: bytes, b: bytes) -> None:
+    """
+    r_i = a_i - b_i over len(r) // 32 packed scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_sc_mul_vec(r: bytearray, a: bytes, b: bytes) -> None:
+    """
+    r_i = a_i * b_i over len(r) // 32 packed scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_sc_muladd_vec(r: bytearray, a: bytes, b: bytes, c: bytes) -> None:
+    """
+    r_i = a_i * b_i + c_i over len(r) // 32 packed scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_sc_fold_vec(
+    r: bytearray,
+    a: bytes,
+    s: Sc25519,
+    b: Optional[bytes] = None,
+    t: Optional[Sc25519] = None,
+) -> None:
+    """
+    r_i = s a_i + t b_i, or s a_i without b, over len(r) // 32 packed
+    scalars
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_sc_inner_product(
+    r: Optional[Sc25519], a: bytes, b: bytes
+) -> Sc25519:
+    """
+    a_0 b_0 + ... + a_{n-1} b_{n-1} over the packed scalars a and b
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_ge25519_fold_vec(
+    r: bytearray,
+    P: bytes,
+    s: Sc25519,
+    Q: Optional[bytes] = None,
+    t: Optional[Sc25519] = None,
+) -> None:
+    """
+    R_i = s P_i + t Q_i, or s P_i without Q, over len(r) // 32 packed
+    points
+    """
+
+
+# extmod/modtrezorcrypto/modtrezorcrypto-monero.h
+def xmr_hash_to_scalar_range(
+    r: bytearray, buff: bytearray, idx_off: int, start: int
+) -> None:
+    """
+    r_i = H_s(buff) with varint(start + i) written at idx_off and the rest
+    of buff zeroed, over len(r) // 32 scalars
+    """
+
+
 # extmod/modtrezorcrypto/modtrezorcrypto-monero.h
 def xmr_get_subaddress_secret_key(
     r: Optional[Sc25519], major: int, minor: int, m: Sc25519
@@ -0,0 +1,68 @@
+# Benchmark of text rendering and measuring in the display driver.
+#
+# Run it with the unix port from the core directory:
+#
+#   ./emu.py --headless --main prof/bench_text.py
+#
+# and compare the pixels per second of builds with and without a change
+# to modtrezorui.
+
+import utime
+from trezorui import Display
+
+ROUNDS = 200
+
+LABELS = (
+    "Confirm sending",
+    "Amount",
+    "Fee",
+    "Hold to confirm",
+    "Really send 0.12345678 BTC",
+    "to bc1qar0srrr7xfkvy5l643lydnw9re59gtzzwf5mdq",
+)
+
+display = Display()
+fg = 0xFFFF
+bg = 0x0000
+
+
+def bench_render(font, colors):
+    height = 23
+    pixels = 0
+    start = utime.ticks_us()
+    for r in range(ROUNDS):
+        for i, label in enumerate(LABELS):
+            c = colors[(r + i) % len(colors)]
+            y = 20 + (i * height) % (display.HEIGHT - 20)
+            w = display.text(0, y, label, font, c, bg)
+            pixels += w * height
+    elapsed = utime.ticks_diff(utime.ticks_us(), start)
+    return pixels, elapsed
+
+
+def bench_measure(font):
+    start = utime.ticks_us()
+    for _ in range(ROUNDS):
+        for label in LABELS:
+            display.text_width(label, font)
+            display.text_split(label, font, display.WIDTH - 24)
+    elapsed = utime.ticks_diff(utime.ticks_us(), start)
+    return ROUNDS * len(LABELS) * 2, elapsed
+
+
+for name, font in (
+    ("normal", Display.FONT_NORMAL),
+    ("bold", Display.FONT_BOLD),
+    ("mono", Display.FONT_MONO),
+):
+    for colors in ((fg,), (fg, 0x07E0), (fg, 0x07E0, 0xF800)):
+        pixels, elapsed = bench_render(font, colors)
+        print(
+            "render %-6s %d colors: %8d pixels/s"
+            % (name, len(colors), pixels * 1000000 // max(elapsed, 1))
+        )
+    calls, elapsed = bench_measure(font)
+    print("measure %-6s: %8d calls/s" % (name, calls * 1000000 // max(elapsed, 1)))
+
+display.clear()
+display.refresh()
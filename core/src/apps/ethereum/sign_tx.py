@@ -20,6 +20,9 @@ from apps.ethereum.layout import (
 # maximum supported chain id
 MAX_CHAIN_ID = 2147483629
 
+# maximum number of data chunks requested at once
+MAX_CHUNK_WINDOW = 16
+
 
 @with_keychain_from_chain_id
 async def sign_tx(ctx, msg, keychain):
@@ -80,10 +83,14 @@ async def sign_tx(ctx, msg, keychain):
         sha.extend(rlp.encode_length(data_total, False))
         sha.extend(rlp.encode(data, False))
 
+    chunk_window = min(msg.chunk_window or 1, MAX_CHUNK_WINDOW)
     while data_left > 0:
-        resp = await send_request_chunk(ctx, data_left)
-        data_left -= len(resp.data_chunk)
-        sha.extend(resp.data_chunk)
+        # the chunks of a window are hashed as they arrive
+        count = await send_request_chunk(ctx, data_left, chunk_window)
+        for _ in range(count):
+            resp = await ctx.read(EthereumTxAck)
+            data_left -= len(resp.data_chunk)
+            sha.extend(resp.data_chunk)
 
     # eip 155 replay protection
     if msg.chain_id:
@@ -126,7 +133,7 @@ def get_total_length(msg: EthereumSignTx, data_total: int) -> int:
     return length
 
 
-async def send_request_chunk(ctx, data_left: int):
+async def send_request_chunk(ctx, data_left: int, chunk_window: int) -> int:
     # TODO: layoutProgress ?
     req = EthereumTxRequest()
     if data_left <= 1024:
@@ -134,7 +141,13 @@ async def send_request_chunk(ctx, data_left: int):
     else:
         req.data_length = 1024
 
-    return await ctx.call(req, EthereumTxAck)
+    # the host sends this many chunks without waiting for another request
+    count = min((data_left + 1023) // 1024, chunk_window)
+    if count > 1:
+        req.chunk_count = count
+
+    await ctx.write(req)
+    return count
 
 
 def sign_digest(msg: EthereumSignTx, keychain, digest):
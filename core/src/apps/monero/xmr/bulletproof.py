@@ -50,6 +50,21 @@ _tmp_sc_2 = crypto.new_scalar()
 _tmp_sc_3 = crypto.new_scalar()
 _tmp_sc_4 = crypto.new_scalar()
 
+# Packed scalars and points of up to _MULTIEXP_CHUNK pairs evaluated by a
+# single native multiexp call
+_MULTIEXP_CHUNK = const(16)
+_tmp_me_sc = bytearray(32 * _MULTIEXP_CHUNK)
+_tmp_me_pt = bytearray(32 * _MULTIEXP_CHUNK)
+
+# Vector operations run natively over blocks of up to _VEC_CHUNK keys, the
+# blocks of vectors that are not stored contiguously are packed here
+_VEC_CHUNK = const(16)
+_tmp_vb_0 = bytearray(32 * _VEC_CHUNK)
+_tmp_vb_1 = bytearray(32 * _VEC_CHUNK)
+_tmp_vb_2 = bytearray(32 * _VEC_CHUNK)
+_tmp_vb_3 = bytearray(32 * _VEC_CHUNK)
+_tmp_vb_r = bytearray(32 * _VEC_CHUNK)
+
 
 def _ensure_dst_key(dst=None):
     if dst is None:
@@ -771,33 +786,94 @@ def _const_vector(val, elems=_BP_N, copy=True):
     return KeyVConst(elems, val, copy)
 
 
+def _vct_view(v, start, n):
+    """
+    Memoryview of the packed keys v[start : start + n] if v stores them
+    contiguously, None otherwise
+    """
+    while isinstance(v, KeyVSliced):
+        start += v.offset
+        v = v.wrapped
+    if not isinstance(v, KeyV):
+        return None
+    if not v.chunked:
+        return v.mv[start << 5 : (start + n) << 5]
+    if start >> _CHBITS != (start + n - 1) >> _CHBITS:
+        return None
+    off = (start & (_CHSIZE - 1)) << 5
+    return memoryview(v.d[start >> _CHBITS])[off : off + (n << 5)]
+
+
+def _vct_block(v, start, n, buff):
+    """
+    Packed keys v[start : start + n], copied to buff if v does not store them
+    contiguously
+    """
+    mv = _vct_view(v, start, n)
+    if mv is not None:
+        return mv
+    for i in range(n):
+        memcpy(buff, i << 5, v.to(start + i), 0, 32)
+    return memoryview(buff)[: n << 5]
+
+
+def _vct_out(v, start, n):
+    """
+    Destination block for v[start : start + n], either the storage of v or
+    _tmp_vb_r that has to be stored by _vct_store afterwards
+    """
+    mv = _vct_view(v, start, n)
+    return mv if mv is not None else memoryview(_tmp_vb_r)[: n << 5]
+
+
+def _vct_store(v, start, n):
+    if _vct_view(v, start, n) is None:
+        for i in range(n):
+            v.read(start + i, _tmp_vb_r, i << 5)
+
+
 def _vector_exponent_custom(A, B, a, b, dst=None, a_raw=None, b_raw=None):
     """
     \\sum_{i=0}^{|A|}  a_i A_i + b_i B_i
+
+    The scalars are secret in the prover, the constant-time multiexp is used.
     """
     dst = _ensure_dst_key(dst)
     crypto.identity_into(_tmp_pt_2)
 
+    n = 0
     for i in range(len(a or a_raw)):
         if a:
-            crypto.decodeint_into_noreduce(_tmp_sc_1, a.to(i))
-        crypto.decodepoint_into(_tmp_pt_3, A.to(i))
+            memcpy(_tmp_me_sc, n << 5, a.to(i), 0, 32)
+        else:
+            crypto.encodeint_into(_tmp_bf_0, a_raw.to(i))
+            memcpy(_tmp_me_sc, n << 5, _tmp_bf_0, 0, 32)
+        memcpy(_tmp_me_pt, n << 5, A.to(i), 0, 32)
         if b:
-            crypto.decodeint_into_noreduce(_tmp_sc_2, b.to(i))
-        crypto.decodepoint_into(_tmp_pt_4, B.to(i))
-        crypto.add_keys3_into(
-            _tmp_pt_1,
-            _tmp_sc_1 if a else a_raw.to(i),
-            _tmp_pt_3,
-            _tmp_sc_2 if b else b_raw.to(i),
-            _tmp_pt_4,
-        )
-        crypto.point_add_into(_tmp_pt_2, _tmp_pt_2, _tmp_pt_1)
+            memcpy(_tmp_me_sc, (n + 1) << 5, b.to(i), 0, 32)
+        else:
+            crypto.encodeint_into(_tmp_bf_0, b_raw.to(i))
+            memcpy(_tmp_me_sc, (n + 1) << 5, _tmp_bf_0, 0, 32)
+        memcpy(_tmp_me_pt, (n + 1) << 5, B.to(i), 0, 32)
+        n += 2
+        if n == _MULTIEXP_CHUNK:
+            _multiexp_acc(_tmp_pt_2, n)
+            n = 0
         _gc_iter(i)
+    if n:
+        _multiexp_acc(_tmp_pt_2, n)
     crypto.encodepoint_into(dst, _tmp_pt_2)
     return dst
 
 
+def _multiexp_acc(acc, n):
+    """
+    acc += the multiexp of the first n pairs in _tmp_me_sc and _tmp_me_pt
+    """
+    crypto.multiexp_into(_tmp_pt_1, _tmp_me_sc, _tmp_me_pt, n)
+    crypto.point_add_into(acc, acc, _tmp_pt_1)
+
+
 def _vector_powers(x, n, dst=None, dynamic=False, **kwargs):
     """
     r_i = x^i
@@ -854,10 +930,12 @@ def _inner_product(a, b, dst=None):
     dst = _ensure_dst_key(dst)
     crypto.sc_init_into(_tmp_sc_1, 0)
 
-    for i in range(len(a)):
-        crypto.decodeint_into_noreduce(_tmp_sc_2, a.to(i))
-        crypto.decodeint_into_noreduce(_tmp_sc_3, b.to(i))
-        crypto.sc_muladd_into(_tmp_sc_1, _tmp_sc_2, _tmp_sc_3, _tmp_sc_1)
+    for i in range(0, len(a), _VEC_CHUNK):
+        n = min(_VEC_CHUNK, len(a) - i)
+        crypto.sc_inner_product_into(
+            _tmp_sc_2, _vct_block(a, i, n, _tmp_vb_0), _vct_block(b, i, n, _tmp_vb_1)
+        )
+        crypto.sc_add_into(_tmp_sc_1, _tmp_sc_1, _tmp_sc_2)
         _gc_iter(i)
 
     crypto.encodeint_into(dst, _tmp_sc_1)
@@ -875,13 +953,19 @@ def _hadamard_fold(v, a, b, into=None, into_offset=0, vR=None, vRoff=0):
     crypto.decodeint_into_noreduce(_tmp_sc_1, a)
     crypto.decodeint_into_noreduce(_tmp_sc_2, b)
     into = into if into else v
-
-    for i in range(h):
-        crypto.decodepoint_into(_tmp_pt_1, v.to(i))
-        crypto.decodepoint_into(_tmp_pt_2, v.to(h + i) if not vR else vR.to(i + vRoff))
-        crypto.add_keys3_into(_tmp_pt_3, _tmp_sc_1, _tmp_pt_1, _tmp_sc_2, _tmp_pt_2)
-        crypto.encodepoint_into(_tmp_bf_0, _tmp_pt_3)
-        into.read(i + into_offset, _tmp_bf_0)
+    if not vR:
+        vR, vRoff = v, h
+
+    for i in range(0, h, _VEC_CHUNK):
+        n = min(_VEC_CHUNK, h - i)
+        crypto.point_fold_vec(
+            _vct_out(into, i + into_offset, n),
+            _vct_block(v, i, n, _tmp_vb_0),
+            _tmp_sc_1,
+            _vct_block(vR, i + vRoff, n, _tmp_vb_1),
+            _tmp_sc_2,
+        )
+        _vct_store(into, i + into_offset, n)
         _gc_iter(i)
 
     return into
@@ -929,14 +1013,16 @@ def _scalar_fold(v, a, b, into=None, into_offset=0):
     crypto.decodeint_into_noreduce(_tmp_sc_2, b)
     into = into if into else v
 
-    for i in range(h):
-        crypto.decodeint_into_noreduce(_tmp_sc_3, v.to(i))
-        crypto.decodeint_into_noreduce(_tmp_sc_4, v.to(h + i))
-        crypto.sc_mul_into(_tmp_sc_3, _tmp_sc_3, _tmp_sc_1)
-        crypto.sc_mul_into(_tmp_sc_4, _tmp_sc_4, _tmp_sc_2)
-        crypto.sc_add_into(_tmp_sc_3, _tmp_sc_3, _tmp_sc_4)
-        crypto.encodeint_into(_tmp_bf_0, _tmp_sc_3)
-        into.read(i + into_offset, _tmp_bf_0)
+    for i in range(0, h, _VEC_CHUNK):
+        n = min(_VEC_CHUNK, h - i)
+        crypto.sc_fold_vec(
+            _vct_out(into, i + into_offset, n),
+            _vct_block(v, i, n, _tmp_vb_0),
+            _tmp_sc_1,
+            _vct_block(v, h + i, n, _tmp_vb_1),
+            _tmp_sc_2,
+        )
+        _vct_store(into, i + into_offset, n)
         _gc_iter(i)
 
     return into
@@ -949,19 +1035,21 @@ def _cross_inner_product(l0, r0, l1, r1):
     """
     sc_t1 = crypto.new_scalar()
     sc_t2 = crypto.new_scalar()
-    tl = crypto.new_scalar()
-    tr = crypto.new_scalar()
-
-    for i in range(len(l0)):
-        crypto.decodeint_into_noreduce(tl, l0.to(i))
-        crypto.decodeint_into_noreduce(tr, r1.to(i))
-        crypto.sc_muladd_into(sc_t1, tl, tr, sc_t1)
-
-        crypto.decodeint_into_noreduce(tl, l1.to(i))
-        crypto.sc_muladd_into(sc_t2, tl, tr, sc_t2)
-
-        crypto.decodeint_into_noreduce(tr, r0.to(i))
-        crypto.sc_muladd_into(sc_t1, tl, tr, sc_t1)
+    tmp = crypto.new_scalar()
+
+    for i in range(0, len(l0), _VEC_CHUNK):
+        n = min(_VEC_CHUNK, len(l0) - i)
+        bl0 = _vct_block(l0, i, n, _tmp_vb_0)
+        br0 = _vct_block(r0, i, n, _tmp_vb_1)
+        bl1 = _vct_block(l1, i, n, _tmp_vb_2)
+        br1 = _vct_block(r1, i, n, _tmp_vb_3)
+
+        crypto.sc_inner_product_into(tmp, bl0, br1)
+        crypto.sc_add_into(sc_t1, sc_t1, tmp)
+        crypto.sc_inner_product_into(tmp, bl1, br0)
+        crypto.sc_add_into(sc_t1, sc_t1, tmp)
+        crypto.sc_inner_product_into(tmp, bl1, br1)
+        crypto.sc_add_into(sc_t2, sc_t2, tmp)
 
         _gc_iter(i)
 
@@ -1017,7 +1105,11 @@ class MultiExpSequential:
     Moreover, Monero needs speed for very fast verification for blockchain verification which is not
     priority in this use case.
 
-    MultiExp holder with sequential evaluation
+    MultiExp holder with sequential evaluation, the pairs are evaluated
+    natively in chunks of _MULTIEXP_CHUNK. It uses the variable-time
+    multiexp, so it is only used by the verification, whose scalars are
+    public. The prover calls _vector_exponent_custom, which uses the
+    constant-time multiexp.
     """
 
     def __init__(self, size=None, points=None, point_fnc=None):
@@ -1032,6 +1124,9 @@ class MultiExpSequential:
 
         self.acc = crypto.identity()
         self.tmp = _ensure_dst_key()
+        self.scalars = bytearray(32 * _MULTIEXP_CHUNK)
+        self.pts = bytearray(32 * _MULTIEXP_CHUNK)
+        self.pending = 0
 
     def get_point(self, idx):
         return (
@@ -1045,15 +1140,25 @@ class MultiExpSequential:
         self._acc(scalar, self.get_point(self.current_idx))
 
     def _acc(self, scalar, point):
-        crypto.decodeint_into_noreduce(_tmp_sc_1, scalar)
-        crypto.decodepoint_into(_tmp_pt_2, point)
-        crypto.scalarmult_into(_tmp_pt_3, _tmp_pt_2, _tmp_sc_1)
-        crypto.point_add_into(self.acc, self.acc, _tmp_pt_3)
+        memcpy(self.scalars, self.pending << 5, scalar, 0, 32)
+        memcpy(self.pts, self.pending << 5, point, 0, 32)
+        self.pending += 1
+        if self.pending == _MULTIEXP_CHUNK:
+            self._flush()
         self.current_idx += 1
         self.size += 1
 
+    def _flush(self):
+        if self.pending:
+            crypto.multiexp_vartime_into(
+                _tmp_pt_3, self.scalars, self.pts, self.pending
+            )
+            crypto.point_add_into(self.acc, self.acc, _tmp_pt_3)
+            self.pending = 0
+
     def eval(self, dst, GiHi=False):
         dst = _ensure_dst_key(dst)
+        self._flush()
         return crypto.encodepoint_into(dst, self.acc)
 
 
@@ -1114,10 +1219,7 @@ class BulletProofBuilder:
         if self.fnc_det_mask:
             return self.fnc_det_mask(i, is_sL, dst)
         self.tmp_det_buff[64] = int(is_sL)
-        memcpy(self.tmp_det_buff, 65, _ZERO, 0, 4)
-        dump_uvarint_b_into(i, self.tmp_det_buff, 65)
-        crypto.hash_to_scalar_into(self.tmp_sc_1, self.tmp_det_buff)
-        crypto.encodeint_into(dst, self.tmp_sc_1)
+        crypto.hash_to_scalar_range(dst, self.tmp_det_buff, 65, i)
         return dst
 
     def _gprec_aux(self, size):
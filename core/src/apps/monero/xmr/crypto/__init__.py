@@ -226,6 +226,22 @@ add_keys2_into = tcry.xmr_add_keys2_vartime
 add_keys3 = tcry.xmr_add_keys3_vartime
 add_keys3_into = tcry.xmr_add_keys3_vartime
 gen_commitment = tcry.xmr_gen_c
+multiexp = tcry.xmr_multiexp
+multiexp_into = tcry.xmr_multiexp
+multiexp_vartime = tcry.xmr_multiexp_vartime
+multiexp_vartime_into = tcry.xmr_multiexp_vartime
+
+# operations on vectors of packed 32-byte keys, the results are written into
+# the first argument
+sc_add_vec = tcry.xmr_sc_add_vec
+sc_sub_vec = tcry.xmr_sc_sub_vec
+sc_mul_vec = tcry.xmr_sc_mul_vec
+sc_muladd_vec = tcry.xmr_sc_muladd_vec
+sc_fold_vec = tcry.xmr_sc_fold_vec
+sc_inner_product = tcry.xmr_sc_inner_product
+sc_inner_product_into = tcry.xmr_sc_inner_product
+point_fold_vec = tcry.xmr_ge25519_fold_vec
+hash_to_scalar_range = tcry.xmr_hash_to_scalar_range
 
 
 def generate_key_derivation(pub: Ge25519, sec: Sc25519) -> Ge25519:
@@ -19,11 +19,13 @@ class EthereumTxRequest(p.MessageType):
         signature_v: int = None,
         signature_r: bytes = None,
         signature_s: bytes = None,
+        chunk_count: int = None,
     ) -> None:
         self.data_length = data_length
         self.signature_v = signature_v
         self.signature_r = signature_r
         self.signature_s = signature_s
+        self.chunk_count = chunk_count
 
     @classmethod
     def get_fields(cls) -> Dict:
@@ -32,4 +34,5 @@ class EthereumTxRequest(p.MessageType):
             2: ('signature_v', p.UVarintType, 0),
             3: ('signature_r', p.BytesType, 0),
             4: ('signature_s', p.BytesType, 0),
+            5: ('chunk_count', p.UVarintType, 0),
         }
@@ -24,6 +24,7 @@ class SignTx(p.MessageType):
         version_group_id: int = None,
         timestamp: int = None,
         branch_id: int = None,
+        batch_size: int = None,
     ) -> None:
         self.outputs_count = outputs_count
         self.inputs_count = inputs_count
@@ -34,6 +35,7 @@ class SignTx(p.MessageType):
         self.version_group_id = version_group_id
         self.timestamp = timestamp
         self.branch_id = branch_id
+        self.batch_size = batch_size
 
     @classmethod
     def get_fields(cls) -> Dict:
@@ -47,4 +49,5 @@ class SignTx(p.MessageType):
             8: ('version_group_id', p.UVarintType, 0),
             9: ('timestamp', p.UVarintType, 0),
             10: ('branch_id', p.UVarintType, 0),
+            11: ('batch_size', p.UVarintType, 0),
         }
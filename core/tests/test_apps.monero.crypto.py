@@ -237,5 +237,72 @@ class TestMoneroCrypto(unittest.TestCase):
         self.assertEqual(pkey_ex, crypto.encodepoint(pkey_comp))
 
 
+    def test_multiexp(self):
+        scalars = bytearray()
+        points = bytearray()
+        exp = crypto.identity()
+        for i in range(9):
+            s = crypto.random_scalar()
+            P = crypto.scalarmult_base(crypto.random_scalar())
+            scalars += crypto.encodeint(s)
+            points += crypto.encodepoint(P)
+            crypto.point_add_into(exp, exp, crypto.scalarmult(P, s))
+            res = crypto.multiexp(scalars, points, i + 1)
+            self.assertTrue(crypto.point_eq(exp, res))
+            res = crypto.multiexp_vartime(scalars, points, i + 1)
+            self.assertTrue(crypto.point_eq(exp, res))
+
+        crypto.multiexp_into(res, scalars, points, 0)
+        self.assertTrue(crypto.point_eq(crypto.identity(), res))
+        crypto.multiexp_vartime_into(res, scalars, points, 0)
+        self.assertTrue(crypto.point_eq(crypto.identity(), res))
+        with self.assertRaises(ValueError):
+            crypto.multiexp(scalars, points, 10)
+        with self.assertRaises(ValueError):
+            crypto.multiexp_vartime(scalars, points, 10)
+
+    def test_vector_ops(self):
+        n = 5
+        a = [crypto.random_scalar() for _ in range(n)]
+        b = [crypto.random_scalar() for _ in range(n)]
+        P = [crypto.scalarmult_base(crypto.random_scalar()) for _ in range(n)]
+        Q = [crypto.scalarmult_base(crypto.random_scalar()) for _ in range(n)]
+        va = b"".join(crypto.encodeint(x) for x in a)
+        vb = b"".join(crypto.encodeint(x) for x in b)
+        vP = b"".join(crypto.encodepoint(x) for x in P)
+        vQ = b"".join(crypto.encodepoint(x) for x in Q)
+        s = crypto.random_scalar()
+        t = crypto.random_scalar()
+
+        exp = crypto.sc_0()
+        for i in range(n):
+            exp = crypto.sc_add(exp, crypto.sc_mul(a[i], b[i]))
+        res = crypto.sc_inner_product(va, vb)
+        self.assertTrue(crypto.sc_eq(exp, res))
+
+        r = bytearray(32 * n)
+        crypto.sc_fold_vec(r, va, s, vb, t)
+        for i in range(n):
+            exp = crypto.sc_add(crypto.sc_mul(a[i], s), crypto.sc_mul(b[i], t))
+            res = crypto.decodeint(r[32 * i : 32 * (i + 1)])
+            self.assertTrue(crypto.sc_eq(exp, res))
+
+        r = bytearray(vP)
+        crypto.point_fold_vec(r, r, s, vQ, t)
+        for i in range(n):
+            exp = crypto.add_keys3(s, P[i], t, Q[i])
+            res = crypto.decodepoint(r[32 * i : 32 * (i + 1)])
+            self.assertTrue(crypto.point_eq(exp, res))
+
+        buff = bytearray(b"\x01" * 69)
+        r = bytearray(32 * n)
+        crypto.hash_to_scalar_range(r, buff, 65, 200)
+        for i in range(n):
+            data = bytearray(b"\x01" * 65) + bytearray(4)
+            data[65:67] = bytes([(200 + i) & 0x7F | 0x80, (200 + i) >> 7])
+            exp = crypto.hash_to_scalar(data)
+            res = crypto.decodeint(r[32 * i : 32 * (i + 1)])
+            self.assertTrue(crypto.sc_eq(exp, res))
+
 if __name__ == "__main__":
     unittest.main()
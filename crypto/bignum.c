@@ -690,11 +690,237 @@ void bn_multiply_reduce(bignum256 *x, uint32_t res[2 * BN_LIMBS],
   }
 }
 
+#if USE_BN_64
+/*
+ The 64-bit backend of bn_multiply. On hosts with unsigned __int128 the field
+ multiplication modulo the primes of secp256k1 and nist256p1 converts the
+ operands to four 64-bit limbs, multiplies them into eight limbs and reduces
+ the product using the special form of the prime. The result is converted back
+ to base 2**29, so the representation of bignum256 doesn't change. Multiplying
+ modulo any other prime uses the 29-bit code below.
+ */
+
+#ifndef __SIZEOF_INT128__
+#error "USE_BN_64 requires unsigned __int128"
+#endif
+
+static const bignum256 bn_prime_secp256k1 = {
+    {0x1ffffc2f, 0x1ffffff7, 0x1fffffff, 0x1fffffff, 0x1fffffff, 0x1fffffff,
+     0x1fffffff, 0x1fffffff, 0xffffff}};
+
+static const bignum256 bn_prime_nist256p1 = {
+    {0x1fffffff, 0x1fffffff, 0x1fffffff, 0x000001ff, 0x00000000, 0x00000000,
+     0x00040000, 0x1fe00000, 0xffffff}};
+
+// 2**256 - secp256k1 prime
+#define BN_SECP256K1_C 0x1000003d1ull
+
+// w = x % 2**256, returns x // 2**256
+// Assumes x is normalized
+// Guarantees the result is less than 2**5
+static uint64_t bn_to_limbs64(const bignum256 *x, uint64_t w[4]) {
+  unsigned __int128 acc = 0;
+  int bits = 0, j = 0;
+
+  for (int i = 0; i < BN_LIMBS; i++) {
+    acc |= (unsigned __int128)x->val[i] << bits;
+    bits += BN_BITS_PER_LIMB;
+    if (bits >= 64) {
+      w[j++] = (uint64_t)acc;
+      acc >>= 64;
+      bits -= 64;
+    }
+  }
+
+  return (uint64_t)acc;
+}
+
+// x = w
+// Guarantees x is normalized
+static void bn_from_limbs64(const uint64_t w[4], bignum256 *x) {
+  unsigned __int128 acc = 0;
+  int bits = 0, j = 0;
+
+  for (int i = 0; i < BN_LIMBS; i++) {
+    if (bits < BN_BITS_PER_LIMB && j < 4) {
+      acc |= (unsigned __int128)w[j++] << bits;
+      bits += 64;
+    }
+    x->val[i] = (uint32_t)acc & BN_LIMB_MASK;
+    acc >>= BN_BITS_PER_LIMB;
+    bits -= BN_BITS_PER_LIMB;
+  }
+}
+
+// res = a * b
+static void bn_multiply_long64(const uint64_t a[4], const uint64_t b[4],
+                               uint64_t res[8]) {
+  for (int i = 0; i < 8; i++) {
+    res[i] = 0;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    uint64_t carry = 0;
+    for (int j = 0; j < 4; j++) {
+      unsigned __int128 acc =
+          (unsigned __int128)a[i] * b[j] + res[i + j] + carry;
+      // acc <= (2**64 - 1)**2 + 2 * (2**64 - 1) < 2**128
+      res[i + j] = (uint64_t)acc;
+      carry = acc >> 64;
+    }
+    res[i + 4] = carry;
+  }
+}
+
+// w = w + t * (2**256 - prime) % 2**256, returns the carry
+// Guarantees the carry is at most 1
+static uint64_t bn_fold_secp256k1(uint64_t w[4], uint64_t t) {
+  unsigned __int128 acc = (unsigned __int128)t * BN_SECP256K1_C + w[0];
+  w[0] = (uint64_t)acc;
+  acc >>= 64;
+  for (int i = 1; i < 4; i++) {
+    acc += w[i];
+    w[i] = (uint64_t)acc;
+    acc >>= 64;
+  }
+  return (uint64_t)acc;
+}
+
+// w = res % prime
+// Guarantees w < 2**256, that is w is partly reduced modulo prime
+static void bn_reduce_secp256k1(const uint64_t res[8], uint64_t w[4]) {
+  // 2**256 == 2**256 - prime (mod prime)
+  unsigned __int128 acc = 0;
+  for (int i = 0; i < 4; i++) {
+    acc += (unsigned __int128)res[i + 4] * BN_SECP256K1_C + res[i];
+    w[i] = (uint64_t)acc;
+    acc >>= 64;
+  }
+
+  // acc < 2**34, the first fold adds less than 2**67. If it carries, w is less
+  // than 2**67 afterwards and the second fold cannot carry.
+  uint64_t carry = bn_fold_secp256k1(w, (uint64_t)acc);
+  bn_fold_secp256k1(w, carry);
+}
+
+// w = w + t * (2**256 - prime) % 2**256, returns the signed carry
+// 2**256 - prime == 2**224 - 2**192 - 2**96 + 1
+static int64_t bn_fold_nist256p1(uint64_t w[4], int64_t t) {
+  const __int128 t32 = (__int128)t * ((__int128)1 << 32);
+  __int128 acc = (__int128)w[0] + t;
+  w[0] = (uint64_t)acc;
+  acc >>= 64;
+  acc += (__int128)w[1] - t32;
+  w[1] = (uint64_t)acc;
+  acc >>= 64;
+  acc += w[2];
+  w[2] = (uint64_t)acc;
+  acc >>= 64;
+  acc += (__int128)w[3] + t32 - t;
+  w[3] = (uint64_t)acc;
+  acc >>= 64;
+  return (int64_t)acc;
+}
+
+// w = res % prime
+// Guarantees w < 2**256, that is w is partly reduced modulo prime
+// Assumes res < 2**512
+static void bn_reduce_nist256p1(const uint64_t res[8], uint64_t w[4]) {
+  // Uses the fast reduction of FIPS 186-4, D.2.3, on 32-bit words c[i]:
+  // res == s1 + 2*s2 + 2*s3 + s4 + s5 - s6 - s7 - s8 - s9 (mod prime)
+  int64_t c[16] = {0};
+  for (int i = 0; i < 8; i++) {
+    c[2 * i] = (uint32_t)res[i];
+    c[2 * i + 1] = res[i] >> 32;
+  }
+
+  const int64_t s[8] = {
+      c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14],
+      c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15],
+      c[2] + c[10] + c[11] - c[13] - c[14] - c[15],
+      c[3] + 2 * c[11] + 2 * c[12] + c[13] - c[15] - c[8] - c[9],
+      c[4] + 2 * c[12] + 2 * c[13] + c[14] - c[9] - c[10],
+      c[5] + 2 * c[13] + 2 * c[14] + c[15] - c[10] - c[11],
+      c[6] + c[13] + 3 * c[14] + 2 * c[15] - c[8] - c[9],
+      c[7] + c[8] + 3 * c[15] - c[10] - c[11] - c[12] - c[13],
+  };
+
+  int64_t acc = 0;
+  for (int i = 0; i < 4; i++) {
+    acc += s[2 * i];
+    uint64_t low = (uint32_t)acc;
+    acc >>= 32;
+    acc += s[2 * i + 1];
+    w[i] = low | ((uint64_t)(uint32_t)acc << 32);
+    acc >>= 32;
+  }
+
+  // -8 < acc < 8, so the first fold leaves w + carry * 2**256 in
+  // (-2**227, 2**256 + 2**227). If it carries or borrows, w is at most 2**227
+  // away from zero or 2**256 and the second fold moves it back within range.
+  int64_t carry = bn_fold_nist256p1(w, acc);
+  bn_fold_nist256p1(w, carry);
+
+  memzero(c, sizeof(c));
+}
+
+// x = k * x % prime using 64-bit limbs, returns false if prime is neither the
+// prime of secp256k1 nor that of nist256p1
+// Assumes k, x are normalized
+// Guarantees x is normalized and partly reduced modulo prime
+static bool bn_multiply64(const bignum256 *k, bignum256 *x,
+                          const bignum256 *prime) {
+  uint64_t a[4] = {0}, b[4] = {0}, res[8] = {0}, w[4] = {0};
+  uint64_t a_high = 0, b_high = 0;
+
+  // The primes are public, so comparing them doesn't leak anything
+  const bool secp256k1 =
+      memcmp(prime, &bn_prime_secp256k1, sizeof(bignum256)) == 0;
+  const bool nist256p1 =
+      memcmp(prime, &bn_prime_nist256p1, sizeof(bignum256)) == 0;
+  if (!secp256k1 && !nist256p1) {
+    return false;
+  }
+
+  // Reduces the operands below 2**256 first, the high parts are less than
+  // 2**5 and it takes at most two folds as in bn_reduce_secp256k1
+  a_high = bn_to_limbs64(k, a);
+  b_high = bn_to_limbs64(x, b);
+  if (secp256k1) {
+    bn_fold_secp256k1(a, bn_fold_secp256k1(a, a_high));
+    bn_fold_secp256k1(b, bn_fold_secp256k1(b, b_high));
+  } else {
+    bn_fold_nist256p1(a, bn_fold_nist256p1(a, a_high));
+    bn_fold_nist256p1(b, bn_fold_nist256p1(b, b_high));
+  }
+
+  bn_multiply_long64(a, b, res);
+  if (secp256k1) {
+    bn_reduce_secp256k1(res, w);
+  } else {
+    bn_reduce_nist256p1(res, w);
+  }
+  bn_from_limbs64(w, x);
+
+  memzero(a, sizeof(a));
+  memzero(b, sizeof(b));
+  memzero(res, sizeof(res));
+  memzero(w, sizeof(w));
+  return true;
+}
+#endif
+
 // x = k * x % prime
 // Assumes k, x are normalized, k * x < 2**519
 // Guarantees x is normalized and partly reduced modulo prime
 // Assumes prime is normalized, 2**256 - 2**224 <= prime <= 2**256
 void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime) {
+#if USE_BN_64
+  if (bn_multiply64(k, x, prime)) {
+    return;
+  }
+#endif
+
   uint32_t res[2 * BN_LIMBS] = {0};
 
   bn_multiply_long(k, x, res);
@@ -1825,3 +2051,42 @@ void bn_inverse(bignum256 *x, const bignum256 *prime) {
   bn_inverse_slow(x, prime);
 }
 #endif
+
+// x[i] = 1/x[i] % prime for all i < count
+// Uses a single bn_inverse and 3 * (count - 1) multiplications (Montgomery's
+//   trick), scratch must have room for count numbers
+// Assumes x[i] are normalized and nonzero modulo prime
+// Assumes prime is a prime number
+// Guarantees x[i] are normalized and fully reduced modulo prime
+// Assumes prime is normalized, 2**256 - 2**224 <= prime <= 2**256
+void bn_inverse_batch(bignum256 *x, bignum256 *scratch, size_t count,
+                      const bignum256 *prime) {
+  bignum256 inv = {0}, tmp = {0};
+  size_t i = 0;
+
+  if (count == 0) {
+    return;
+  }
+
+  // scratch[i] = x[0] * ... * x[i]
+  scratch[0] = x[0];
+  for (i = 1; i < count; i++) {
+    scratch[i] = scratch[i - 1];
+    bn_multiply(&x[i], &scratch[i], prime);
+  }
+
+  inv = scratch[count - 1];
+  bn_mod(&inv, prime);
+  bn_inverse(&inv, prime);
+
+  for (i = count - 1; i > 0; i--) {
+    // inv = 1 / (x[0] * ... * x[i])
+    tmp = inv;
+    bn_multiply(&scratch[i - 1], &tmp, prime);  // tmp = 1 / x[i]
+    bn_multiply(&x[i], &inv, prime);
+    bn_mod(&tmp, prime);
+    x[i] = tmp;
+  }
+  bn_mod(&inv, prime);
+  x[0] = inv;
+}
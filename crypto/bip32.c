@@ -160,7 +160,7 @@ int hdnode_from_xprv(uint32_t depth, uint32_t child_num,
 
 int hdnode_from_seed(const uint8_t *seed, int seed_len, const char *curve,
                      HDNode *out) {
-  static CONFIDENTIAL uint8_t I[32 + 32];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t I[32 + 32];
   memzero(out, sizeof(HDNode));
   out->depth = 0;
   out->child_num = 0;
@@ -173,7 +173,7 @@ int hdnode_from_seed(const uint8_t *seed, int seed_len, const char *curve,
     return 1;
   }
 #endif
-  static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+  static THREAD_LOCAL CONFIDENTIAL HMAC_SHA512_CTX ctx;
   hmac_sha512_Init(&ctx, (const uint8_t *)out->curve->bip32_name,
                    strlen(out->curve->bip32_name));
   hmac_sha512_Update(&ctx, seed, seed_len);
@@ -214,9 +214,9 @@ uint32_t hdnode_fingerprint(HDNode *node) {
 }
 
 int hdnode_private_ckd(HDNode *inout, uint32_t i) {
-  static CONFIDENTIAL uint8_t data[1 + 32 + 4];
-  static CONFIDENTIAL uint8_t I[32 + 32];
-  static CONFIDENTIAL bignum256 a, b;
+  static THREAD_LOCAL CONFIDENTIAL uint8_t data[1 + 32 + 4];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t I[32 + 32];
+  static THREAD_LOCAL CONFIDENTIAL bignum256 a, b;
 
   if (i & 0x80000000) {  // private derivation
     data[0] = 0;
@@ -232,7 +232,7 @@ int hdnode_private_ckd(HDNode *inout, uint32_t i) {
 
   bn_read_be(inout->private_key, &a);
 
-  static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+  static THREAD_LOCAL CONFIDENTIAL HMAC_SHA512_CTX ctx;
   hmac_sha512_Init(&ctx, inout->chain_code, 32);
   hmac_sha512_Update(&ctx, data, sizeof(data));
   hmac_sha512_Final(&ctx, I);
@@ -311,10 +311,10 @@ int hdnode_private_ckd_cardano(HDNode *inout, uint32_t index) {
     keysize = 64;
   }
 
-  static CONFIDENTIAL uint8_t data[1 + 64 + 4];
-  static CONFIDENTIAL uint8_t z[32 + 32];
-  static CONFIDENTIAL uint8_t priv_key[64];
-  static CONFIDENTIAL uint8_t res_key[64];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t data[1 + 64 + 4];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t z[32 + 32];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t priv_key[64];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t res_key[64];
 
   write_le(data + keysize + 1, index);
 
@@ -331,12 +331,12 @@ int hdnode_private_ckd_cardano(HDNode *inout, uint32_t index) {
     memcpy(data + 1, inout->public_key + 1, 32);
   }
 
-  static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+  static THREAD_LOCAL CONFIDENTIAL HMAC_SHA512_CTX ctx;
   hmac_sha512_Init(&ctx, inout->chain_code, 32);
   hmac_sha512_Update(&ctx, data, 1 + keysize + 4);
   hmac_sha512_Final(&ctx, z);
 
-  static CONFIDENTIAL uint8_t zl8[32];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t zl8[32];
   memzero(zl8, 32);
 
   /* get 8 * Zl */
@@ -395,9 +395,9 @@ static int hdnode_from_secret_cardano(const uint8_t *k,
 // Derives the root Cardano HDNode from a master secret, aka seed, as defined in
 // SLIP-0023.
 int hdnode_from_seed_cardano(const uint8_t *seed, int seed_len, HDNode *out) {
-  static CONFIDENTIAL uint8_t I[SHA512_DIGEST_LENGTH];
-  static CONFIDENTIAL uint8_t k[SHA512_DIGEST_LENGTH];
-  static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+  static THREAD_LOCAL CONFIDENTIAL uint8_t I[SHA512_DIGEST_LENGTH];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t k[SHA512_DIGEST_LENGTH];
+  static THREAD_LOCAL CONFIDENTIAL HMAC_SHA512_CTX ctx;
 
   hmac_sha512_Init(&ctx, (const uint8_t *)ED25519_CARDANO_NAME,
                    strlen(ED25519_CARDANO_NAME));
@@ -420,7 +420,7 @@ int hdnode_from_seed_cardano(const uint8_t *seed, int seed_len, HDNode *out) {
 int hdnode_from_entropy_cardano_icarus(const uint8_t *pass, int pass_len,
                                        const uint8_t *entropy, int entropy_len,
                                        HDNode *out) {
-  static CONFIDENTIAL uint8_t secret[96];
+  static THREAD_LOCAL CONFIDENTIAL uint8_t secret[96];
   pbkdf2_hmac_sha512(pass, pass_len, entropy, entropy_len, 4096, secret, 96);
 
   int ret = hdnode_from_secret_cardano(secret, secret + 64, out);
@@ -468,6 +468,67 @@ int hdnode_public_ckd_cp(const ecdsa_curve *curve, const curve_point *parent,
   }
 }
 
+// number of children hdnode_public_ckd_cp_batch derives at once
+#define BIP32_CKD_BATCH_SIZE 16
+
+// Derives the public children i, i + 1, ..., i + count - 1 of parent.
+// Does not use any static state except in the negligibly rare fallback for
+// invalid children, so it can be called from several threads at once.
+// The child points are converted to affine coordinates in batches and the
+// HMAC key schedule is shared, the child chain codes are not computed.
+// returns 0 if any of the indices is hardened
+int hdnode_public_ckd_cp_batch(const ecdsa_curve *curve,
+                               const curve_point *parent,
+                               const uint8_t *parent_chain_code, uint32_t i,
+                               size_t count, curve_point *children) {
+  uint8_t data[(1 + 32) + 4] = {0};
+  uint8_t I[32 + 32] = {0};
+  bignum256 c[BIP32_CKD_BATCH_SIZE] = {0};
+  HMAC_SHA512_CTX hmac_base = {0}, hmac_ctx = {0};
+  size_t offset = 0, j = 0;
+
+  if ((i & 0x80000000) || count > 0x80000000 - i) {  // private derivation
+    return 0;
+  }
+
+  data[0] = 0x02 | (parent->y.val[0] & 0x01);
+  bn_write_be(&parent->x, data + 1);
+  hmac_sha512_Init(&hmac_base, parent_chain_code, 32);
+
+  for (offset = 0; offset < count; offset += BIP32_CKD_BATCH_SIZE) {
+    size_t chunk = count - offset;
+    if (chunk > BIP32_CKD_BATCH_SIZE) {
+      chunk = BIP32_CKD_BATCH_SIZE;
+    }
+    for (j = 0; j < chunk; j++) {
+      write_be(data + 33, i + offset + j);
+      hmac_ctx = hmac_base;
+      hmac_sha512_Update(&hmac_ctx, data, sizeof(data));
+      hmac_sha512_Final(&hmac_ctx, I);
+      bn_read_be(I, &c[j]);
+      if (!bn_is_less(&c[j], &curve->order)) {
+        bn_zero(&c[j]);
+      }
+    }
+    scalar_multiply_add_batch(curve, c, parent, children + offset, chunk);
+    for (j = 0; j < chunk; j++) {
+      if (bn_is_zero(&c[j]) || point_is_infinity(&children[offset + j])) {
+        // invalid child, let hdnode_public_ckd_cp handle it
+        hdnode_public_ckd_cp(curve, parent, parent_chain_code, i + offset + j,
+                             &children[offset + j], NULL);
+      }
+    }
+  }
+
+  // Wipe all stack data.
+  memzero(data, sizeof(data));
+  memzero(I, sizeof(I));
+  memzero(c, sizeof(c));
+  memzero(&hmac_base, sizeof(hmac_base));
+  memzero(&hmac_ctx, sizeof(hmac_ctx));
+  return 1;
+}
+
 int hdnode_public_ckd(HDNode *inout, uint32_t i) {
   curve_point parent = {0}, child = {0};
 
@@ -517,11 +578,11 @@ void hdnode_public_ckd_address_optimized(const curve_point *pub,
 }
 
 #if USE_BIP32_CACHE
-static bool private_ckd_cache_root_set = false;
-static CONFIDENTIAL HDNode private_ckd_cache_root;
-static int private_ckd_cache_index = 0;
+static THREAD_LOCAL bool private_ckd_cache_root_set = false;
+static THREAD_LOCAL CONFIDENTIAL HDNode private_ckd_cache_root;
+static THREAD_LOCAL int private_ckd_cache_index = 0;
 
-static CONFIDENTIAL struct {
+static THREAD_LOCAL CONFIDENTIAL struct {
   bool set;
   size_t depth;
   uint32_t i[BIP32_CACHE_MAXDEPTH];
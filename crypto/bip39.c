@@ -40,9 +40,9 @@
 
 #if USE_BIP39_CACHE
 
-static int bip39_cache_index = 0;
+static THREAD_LOCAL int bip39_cache_index = 0;
 
-static CONFIDENTIAL struct {
+static THREAD_LOCAL CONFIDENTIAL struct {
   bool set;
   char mnemonic[256];
   char passphrase[64];
@@ -62,7 +62,7 @@ const char *mnemonic_generate(int strength) {
   return r;
 }
 
-static CONFIDENTIAL char mnemo[24 * 10];
+static THREAD_LOCAL CONFIDENTIAL char mnemo[24 * 10];
 
 const char *mnemonic_from_data(const uint8_t *data, int len) {
   if (len % 4 || len < 16 || len > 32) {
@@ -213,7 +213,7 @@ void mnemonic_to_seed(const char *mnemonic, const char *passphrase,
   uint8_t salt[8 + 256] = {0};
   memcpy(salt, "mnemonic", 8);
   memcpy(salt + 8, passphrase, passphraselen);
-  static CONFIDENTIAL PBKDF2_HMAC_SHA512_CTX pctx;
+  static THREAD_LOCAL CONFIDENTIAL PBKDF2_HMAC_SHA512_CTX pctx;
   pbkdf2_hmac_sha512_Init(&pctx, (const uint8_t *)mnemonic, mnemoniclen, salt,
                           passphraselen + 8, 1);
   if (progress_callback) {
@@ -240,6 +240,40 @@ void mnemonic_to_seed(const char *mnemonic, const char *passphrase,
 #endif
 }
 
+// number of seeds mnemonic_to_seed_many computes at once
+#define BIP39_SEED_BATCH_SIZE 4
+
+// Same as calling mnemonic_to_seed on every pair of mnemonics[i] and
+// passphrases[i], but the PBKDF2 rounds of BIP39_SEED_BATCH_SIZE seeds are
+// computed at once with the multi-buffer SHA-512 transforms.
+// Neither the seed cache nor the secure element are used.
+void mnemonic_to_seed_many(const char *const *mnemonics,
+                           const char *const *passphrases, size_t count,
+                           uint8_t (*seeds)[512 / 8]) {
+  PBKDF2_HMAC_SHA512_CTX pctx[BIP39_SEED_BATCH_SIZE] = {0};
+  uint8_t salt[8 + 256] = {0};
+  memcpy(salt, "mnemonic", 8);
+  for (size_t offset = 0; offset < count; offset += BIP39_SEED_BATCH_SIZE) {
+    size_t lanes = count - offset;
+    if (lanes > BIP39_SEED_BATCH_SIZE) {
+      lanes = BIP39_SEED_BATCH_SIZE;
+    }
+    for (size_t i = 0; i < lanes; i++) {
+      int passphraselen = strnlen(passphrases[offset + i], 256);
+      memcpy(salt + 8, passphrases[offset + i], passphraselen);
+      pbkdf2_hmac_sha512_Init(&pctx[i], (const uint8_t *)mnemonics[offset + i],
+                              strlen(mnemonics[offset + i]), salt,
+                              passphraselen + 8, 1);
+    }
+    pbkdf2_hmac_sha512_Update_lanes(pctx, lanes, BIP39_PBKDF2_ROUNDS);
+    for (size_t i = 0; i < lanes; i++) {
+      pbkdf2_hmac_sha512_Final(&pctx[i], seeds[offset + i]);
+    }
+  }
+  memzero(salt, sizeof(salt));
+  memzero(pctx, sizeof(pctx));
+}
+
 // binary search for finding the word in the wordlist
 int mnemonic_find_word(const char *word) {
   int lo = 0, hi = BIP39_WORDS - 1;
@@ -25,6 +25,7 @@
 #define __BIP39_H__
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define BIP39_WORDS 2048
@@ -44,6 +45,11 @@ void mnemonic_to_seed(const char *mnemonic, const char *passphrase,
                       void (*progress_callback)(uint32_t current,
                                                 uint32_t total));
 
+// computes count seeds at once, see mnemonic_to_seed
+void mnemonic_to_seed_many(const char *const *mnemonics,
+                           const char *const *passphrases, size_t count,
+                           uint8_t (*seeds)[512 / 8]);
+
 int mnemonic_find_word(const char *word);
 const char *mnemonic_complete_word(const char *prefix, int len);
 const char *mnemonic_get_word(int index);
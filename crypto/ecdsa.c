@@ -170,10 +170,6 @@ int point_is_negative_of(const curve_point *p, const curve_point *q) {
   return !bn_is_equal(&(p->y), &(q->y));
 }
 
-typedef struct jacobian_curve_point {
-  bignum256 x, y, z;
-} jacobian_curve_point;
-
 // generate random K for signing/side-channel noise
 static void generate_k_random(bignum256 *k, const bignum256 *prime) {
   do {
@@ -220,6 +216,66 @@ void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p,
   bn_mod(&p->y, prime);
 }
 
+// p[i] = jp[i] in affine coordinates for all i < count using a single
+// inversion (Montgomery's trick), points with z == 0 are set to infinity
+// jp and p must not overlap
+void jacobian_to_curve_batch(const jacobian_curve_point *jp, curve_point *p,
+                             size_t count, const bignum256 *prime) {
+  bignum256 inv = {0}, z = {0};
+  size_t i = 0;
+
+  if (count == 0) {
+    return;
+  }
+
+  // p[i].y = z[0] * ... * z[i], where zero z are replaced by one
+  // p[i].x = 1 if z[i] is zero else 0
+  for (i = 0; i < count; i++) {
+    z = jp[i].z;
+    bn_mod(&z, prime);
+    p[i].x.val[0] = bn_is_zero(&z);
+    if (p[i].x.val[0]) {
+      bn_one(&z);
+    }
+    if (i == 0) {
+      p[i].y = z;
+    } else {
+      p[i].y = p[i - 1].y;
+      bn_multiply(&z, &p[i].y, prime);
+    }
+  }
+
+  inv = p[count - 1].y;
+  bn_mod(&inv, prime);
+  bn_inverse(&inv, prime);
+
+  for (i = count; i-- > 0;) {
+    if (p[i].x.val[0]) {
+      // z[i] was replaced by one, inv stays the same
+      point_set_infinity(&p[i]);
+      continue;
+    }
+    // inv = 1 / (z[0] * ... * z[i])
+    p[i].y = inv;
+    if (i > 0) {
+      bn_multiply(&p[i - 1].y, &p[i].y, prime);
+      bn_multiply(&jp[i].z, &inv, prime);
+    }
+    // p[i].y = z[i]^-1
+    p[i].x = p[i].y;
+    bn_multiply(&p[i].x, &p[i].x, prime);
+    // p[i].x = z[i]^-2
+    bn_multiply(&p[i].x, &p[i].y, prime);
+    // p[i].y = z[i]^-3
+    bn_multiply(&jp[i].x, &p[i].x, prime);
+    // p[i].x = jp[i].x * z[i]^-2
+    bn_multiply(&jp[i].y, &p[i].y, prime);
+    // p[i].y = jp[i].y * z[i]^-3
+    bn_mod(&p[i].x, prime);
+    bn_mod(&p[i].y, prime);
+  }
+}
+
 void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2,
                         const ecdsa_curve *curve) {
   bignum256 r = {0}, h = {0}, r2 = {0};
@@ -372,11 +428,13 @@ void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve) {
   bn_multiply(&m, &m, prime);
   bn_mult_k(&m, 3, prime);
 
-  az4 = p->z;
-  bn_multiply(&az4, &az4, prime);
-  bn_multiply(&az4, &az4, prime);
-  bn_mult_k(&az4, -curve->a, prime);
-  bn_subtractmod(&m, &az4, &m, prime);
+  if (curve->a != 0) {
+    az4 = p->z;
+    bn_multiply(&az4, &az4, prime);
+    bn_multiply(&az4, &az4, prime);
+    bn_mult_k(&az4, -curve->a, prime);
+    bn_subtractmod(&m, &az4, &m, prime);
+  }
   bn_mult_half(&m, prime);
 
   // msq = m^2
@@ -417,13 +475,13 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k,
   assert(bn_is_less(k, &curve->order));
 
   int i = 0, j = 0;
-  static CONFIDENTIAL bignum256 a;
+  static THREAD_LOCAL CONFIDENTIAL bignum256 a;
   uint32_t *aptr = NULL;
   uint32_t abits = 0;
   int ashift = 0;
   uint32_t is_even = (k->val[0] & 1) - 1;
   uint32_t bits = {0}, sign = {0}, nsign = {0};
-  static CONFIDENTIAL jacobian_curve_point jres;
+  static THREAD_LOCAL CONFIDENTIAL jacobian_curve_point jres;
   curve_point pmult[8] = {0};
   const bignum256 *prime = &curve->prime;
 
@@ -531,90 +589,112 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k,
 
 #if USE_PRECOMPUTED_CP
 
-// res = k * G
+// jres = k * G in jacobian coordinates
 // k must be a normalized number with 0 <= k < curve->order
-void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
-                     curve_point *res) {
+// a is scratch space owned by the caller, it is wiped before returning
+// returns 0 and leaves jres untouched if k is zero
+static int scalar_multiply_jacobian(const ecdsa_curve *curve,
+                                    const bignum256 *k,
+                                    jacobian_curve_point *jres,
+                                    bignum256 *a) {
   assert(bn_is_less(k, &curve->order));
 
   int i = {0}, j = {0};
-  static CONFIDENTIAL bignum256 a;
   uint32_t is_even = (k->val[0] & 1) - 1;
   uint32_t lowbits = 0;
-  static CONFIDENTIAL jacobian_curve_point jres;
   const bignum256 *prime = &curve->prime;
 
   // is_even = 0xffffffff if k is even, 0 otherwise.
 
-  // add 2^256.
+  // add 2^TOP, where TOP = ROWS * WINDOW is the number of bits covered by the
+  // windows, 256 <= TOP <= 260.
   // make number odd: subtract curve->order if even
+  const int window = PRECOMPUTED_CP_WINDOW;
+  const uint32_t window_mask = (1 << window) - 1;
+  const int top = PRECOMPUTED_CP_ROWS * PRECOMPUTED_CP_WINDOW;
   uint32_t tmp = 1;
   uint32_t is_non_zero = 0;
   for (j = 0; j < 8; j++) {
     is_non_zero |= k->val[j];
     tmp += (BN_BASE - 1) + k->val[j] - (curve->order.val[j] & is_even);
-    a.val[j] = tmp & (BN_BASE - 1);
+    a->val[j] = tmp & (BN_BASE - 1);
     tmp >>= BN_BITS_PER_LIMB;
   }
   is_non_zero |= k->val[j];
-  a.val[j] = tmp + 0xffffff + k->val[j] - (curve->order.val[j] & is_even);
-  assert((a.val[0] & 1) != 0);
+  a->val[j] = tmp + ((1u << (top - 8 * BN_BITS_PER_LIMB)) - 1) + k->val[j] -
+              (curve->order.val[j] & is_even);
+  assert((a->val[0] & 1) != 0);
 
   // special case 0*G:  just return zero. We don't care about constant time.
   if (!is_non_zero) {
-    point_set_infinity(res);
-    return;
+    memzero(a, sizeof(*a));
+    return 0;
   }
 
-  // Now a = k + 2^256 (mod curve->order) and a is odd.
+  // Now a = k + 2^TOP (mod curve->order) and a is odd.
   //
   // The idea is to bring the new a into the form.
-  // sum_{i=0..64} a[i] 16^i,  where |a[i]| < 16 and a[i] is odd.
-  // a[0] is odd, since a is odd.  If a[i] would be even, we can
-  // add 1 to it and subtract 16 from a[i-1].  Afterwards,
-  // a[64] = 1, which is the 2^256 that we added before.
+  // sum_{i=0..ROWS} a[i] B^i,  where B = 2^WINDOW, |a[i]| < B and a[i] is
+  // odd. a[0] is odd, since a is odd.  If a[i] would be even, we can
+  // add 1 to it and subtract B from a[i-1].  Afterwards,
+  // a[ROWS] = 1, which is the 2^TOP that we added before.
   //
-  // Since k = a - 2^256 (mod curve->order), we can compute
-  //   k*G = sum_{i=0..63} a[i] 16^i * G
+  // Since k = a - 2^TOP (mod curve->order), we can compute
+  //   k*G = sum_{i=0..ROWS-1} a[i] B^i * G
   //
   // We have a big table curve->cp that stores all possible
-  // values of |a[i]| 16^i * G.
-  // curve->cp[i][j] = (2*j+1) * 16^i * G
+  // values of |a[i]| B^i * G.
+  // curve->cp[i][j] = (2*j+1) * B^i * G
 
-  // now compute  res = sum_{i=0..63} a[i] * 16^i * G step by step.
-  // initial res = |a[0]| * G.  Note that a[0] = a & 0xf if (a&0x10) != 0
-  // and - (16 - (a & 0xf)) otherwise.   We can compute this as
-  //   ((a ^ (((a >> 4) & 1) - 1)) & 0xf) >> 1
+  // now compute  res = sum_{i=0..ROWS-1} a[i] * B^i * G step by step.
+  // initial res = |a[0]| * G.  Note that a[0] = a & (B-1) if (a&B) != 0
+  // and - (B - (a & (B-1))) otherwise.   We can compute this as
+  //   ((a ^ (((a >> WINDOW) & 1) - 1)) & (B-1)) >> 1
   // since a is odd.
-  lowbits = a.val[0] & ((1 << 5) - 1);
-  lowbits ^= (lowbits >> 4) - 1;
-  lowbits &= 15;
-  curve_to_jacobian(&curve->cp[0][lowbits >> 1], &jres, prime);
-  for (i = 1; i < 64; i++) {
-    // invariant res = sign(a[i-1]) sum_{j=0..i-1} (a[j] * 16^j * G)
-
-    // shift a by 4 places.
+  lowbits = a->val[0] & ((window_mask << 1) | 1);
+  lowbits ^= (lowbits >> window) - 1;
+  lowbits &= window_mask;
+  curve_to_jacobian(&curve->cp[0][lowbits >> 1], jres, prime);
+  for (i = 1; i < PRECOMPUTED_CP_ROWS; i++) {
+    // invariant res = sign(a[i-1]) sum_{j=0..i-1} (a[j] * B^j * G)
+
+    // shift a by WINDOW places.
     for (j = 0; j < 8; j++) {
-      a.val[j] =
-          (a.val[j] >> 4) | ((a.val[j + 1] & 0xf) << (BN_BITS_PER_LIMB - 4));
+      a->val[j] =
+          (a->val[j] >> window) |
+          ((a->val[j + 1] & window_mask) << (BN_BITS_PER_LIMB - window));
     }
-    a.val[j] >>= 4;
-    // a = old(a)>>(4*i)
+    a->val[j] >>= window;
+    // a = old(a)>>(WINDOW*i)
     // a is even iff sign(a[i-1]) = -1
 
-    lowbits = a.val[0] & ((1 << 5) - 1);
-    lowbits ^= (lowbits >> 4) - 1;
-    lowbits &= 15;
+    lowbits = a->val[0] & ((window_mask << 1) | 1);
+    lowbits ^= (lowbits >> window) - 1;
+    lowbits &= window_mask;
     // negate last result to make signs of this round and the
     // last round equal.
-    bn_cnegate(~lowbits & 1, &jres.y, prime);
+    bn_cnegate(~lowbits & 1, &jres->y, prime);
 
     // add odd factor
-    point_jacobian_add(&curve->cp[i][lowbits >> 1], &jres, curve);
+    point_jacobian_add(&curve->cp[i][lowbits >> 1], jres, curve);
   }
-  bn_cnegate(~(a.val[0] >> 4) & 1, &jres.y, prime);
-  jacobian_to_curve(&jres, res, prime);
-  memzero(&a, sizeof(a));
+  bn_cnegate(~(a->val[0] >> window) & 1, &jres->y, prime);
+  memzero(a, sizeof(*a));
+  return 1;
+}
+
+// res = k * G
+// k must be a normalized number with 0 <= k < curve->order
+void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
+                     curve_point *res) {
+  static THREAD_LOCAL CONFIDENTIAL bignum256 a;
+  static THREAD_LOCAL CONFIDENTIAL jacobian_curve_point jres;
+
+  if (!scalar_multiply_jacobian(curve, k, &jres, &a)) {
+    point_set_infinity(res);
+    return;
+  }
+  jacobian_to_curve(&jres, res, &curve->prime);
   memzero(&jres, sizeof(jres));
 }
 
@@ -625,8 +705,64 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
   point_multiply(curve, k, &curve->G, res);
 }
 
+static int scalar_multiply_jacobian(const ecdsa_curve *curve,
+                                    const bignum256 *k,
+                                    jacobian_curve_point *jres,
+                                    bignum256 *a) {
+  curve_point p = {0};
+
+  (void)a;
+  if (bn_is_zero(k)) {
+    return 0;
+  }
+  point_multiply(curve, k, &curve->G, &p);
+  curve_to_jacobian(&p, jres, &curve->prime);
+  memzero(&p, sizeof(p));
+  return 1;
+}
+
 #endif
 
+// number of points scalar_multiply_add_batch converts to affine coordinates
+// at once
+#define SCALAR_MULTIPLY_BATCH_SIZE 16
+
+// res[i] = k[i] * G + p for all i < count
+// The results are converted to affine coordinates in batches, so that there is
+// one inversion per SCALAR_MULTIPLY_BATCH_SIZE points instead of one per point.
+// k[i] must be normalized numbers with 0 <= k[i] < curve->order
+// Keeps all its state on the stack, so it can be called from several threads
+// at once when USE_PRECOMPUTED_CP is enabled.
+void scalar_multiply_add_batch(const ecdsa_curve *curve, const bignum256 *k,
+                               const curve_point *p, curve_point *res,
+                               size_t count) {
+  jacobian_curve_point jres[SCALAR_MULTIPLY_BATCH_SIZE] = {0};
+  bignum256 a = {0};
+  curve_point q = *p;
+  size_t offset = 0, i = 0;
+
+  for (offset = 0; offset < count; offset += SCALAR_MULTIPLY_BATCH_SIZE) {
+    size_t chunk = count - offset;
+    if (chunk > SCALAR_MULTIPLY_BATCH_SIZE) {
+      chunk = SCALAR_MULTIPLY_BATCH_SIZE;
+    }
+    for (i = 0; i < chunk; i++) {
+      if (!scalar_multiply_jacobian(curve, &k[offset + i], &jres[i], &a)) {
+        // 0 * G + q = q
+        jres[i].x = q.x;
+        jres[i].y = q.y;
+        bn_one(&jres[i].z);
+      } else if (!point_is_infinity(&q)) {
+        point_jacobian_add(&q, &jres[i], curve);
+      }
+    }
+    jacobian_to_curve_batch(jres, res + offset, chunk, &curve->prime);
+  }
+
+  memzero(jres, sizeof(jres));
+  memzero(&q, sizeof(q));
+}
+
 int ecdh_multiply(const ecdsa_curve *curve, const uint8_t *priv_key,
                   const uint8_t *pub_key, uint8_t *session_key) {
   curve_point point = {0};
@@ -1125,6 +1261,251 @@ int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key,
   return result;
 }
 
+// number of signatures ecdsa_verify_digest_batch processes at once
+#define ECDSA_VERIFY_BATCH_SIZE 8
+
+// Computes the width-5 non-adjacent form of k, i.e. digits naf[i] that are
+// either zero or odd numbers between -15 and 15 with k = sum(naf[i] * 2**i)
+// Assumes k is normalized and k < 2**256
+// Returns the number of digits
+// The function doesn't have neither constant control flow nor constant memory
+//   access flow with regard to k
+static int bn_wnaf5(const bignum256 *k, int8_t naf[257]) {
+  bignum256 a = *k;
+  int len = 0;
+
+  while (!bn_is_zero(&a)) {
+    int8_t digit = 0;
+    if (bn_is_odd(&a)) {
+      digit = a.val[0] & 31;
+      if (digit >= 16) {
+        digit -= 32;
+        bn_addi(&a, -digit);
+      } else {
+        a.val[0] -= digit;
+      }
+    }
+    naf[len++] = digit;
+    bn_rshift(&a);
+  }
+  return len;
+}
+
+// res += digit * P, where table[i] = (2 * i + 1) * P and digit is odd
+// The function doesn't have constant control flow.
+static void point_jacobian_add_digit(const curve_point *table, int8_t digit,
+                                     jacobian_curve_point *res,
+                                     int *res_is_infinity,
+                                     const ecdsa_curve *curve) {
+  curve_point p = table[(digit < 0 ? -digit : digit) >> 1];
+  if (digit < 0) {
+    bn_subtract(&curve->prime, &p.y, &p.y);
+  }
+  if (*res_is_infinity) {
+    res->x = p.x;
+    res->y = p.y;
+    bn_one(&res->z);
+    *res_is_infinity = 0;
+  } else {
+    point_jacobian_add(&p, res, curve);
+  }
+}
+
+// Returns whether jp is a finite point whose affine x coordinate is congruent
+// to r modulo curve->order
+// Assumes r is normalized and r < curve->order
+static int jacobian_x_is_equal_mod_order(const jacobian_curve_point *jp,
+                                         const bignum256 *r,
+                                         const ecdsa_curve *curve) {
+  const bignum256 *prime = &curve->prime;
+  bignum256 zz = jp->z, x = jp->x, rzz = {0};
+
+  bn_mod(&zz, prime);
+  if (bn_is_zero(&zz)) {
+    return 0;
+  }
+  bn_multiply(&zz, &zz, prime);
+  bn_mod(&x, prime);
+
+  // x / z^2 == r
+  rzz = *r;
+  bn_multiply(&zz, &rzz, prime);
+  bn_mod(&rzz, prime);
+  if (bn_is_equal(&rzz, &x)) {
+    return 1;
+  }
+
+  // x / z^2 == r + order, possible only if r + order < prime
+  rzz = *r;
+  bn_add(&rzz, &curve->order);
+  if (!bn_is_less(&rzz, prime)) {
+    return 0;
+  }
+  bn_multiply(&zz, &rzz, prime);
+  bn_mod(&rzz, prime);
+  return bn_is_equal(&rzz, &x);
+}
+
+// Verifies up to ECDSA_VERIFY_BATCH_SIZE signatures, see
+// ecdsa_verify_digest_batch
+static int ecdsa_verify_digest_chunk(const ecdsa_curve *curve, size_t count,
+                                     const uint8_t *const *pub_keys,
+                                     const uint8_t *const *sigs,
+                                     const uint8_t *const *digests,
+                                     int *results) {
+  const bignum256 *prime = &curve->prime;
+  const bignum256 *order = &curve->order;
+  int status[ECDSA_VERIFY_BATCH_SIZE] = {0};
+  size_t idx[ECDSA_VERIFY_BATCH_SIZE] = {0};
+  curve_point pub[ECDSA_VERIFY_BATCH_SIZE + 1] = {0};
+  bignum256 r[ECDSA_VERIFY_BATCH_SIZE] = {0};
+  bignum256 u1[ECDSA_VERIFY_BATCH_SIZE] = {0};
+  bignum256 u2[ECDSA_VERIFY_BATCH_SIZE] = {0};
+  bignum256 scratch[ECDSA_VERIFY_BATCH_SIZE] = {0};
+  jacobian_curve_point jp[(ECDSA_VERIFY_BATCH_SIZE + 1) * 8] = {0};
+  curve_point twice[ECDSA_VERIFY_BATCH_SIZE + 1] = {0};
+  curve_point table[(ECDSA_VERIFY_BATCH_SIZE + 1) * 8] = {0};
+  const curve_point *gtable = NULL;
+  int8_t naf1[257] = {0}, naf2[257] = {0};
+  size_t i = 0, j = 0, m = 0, points = 0;
+  int failed = 0;
+
+  // parse the inputs, idx[0..m-1] are the items that still may verify
+  for (i = 0; i < count; i++) {
+    if (!ecdsa_read_pubkey(curve, pub_keys[i], &pub[m])) {
+      status[i] = 1;
+      continue;
+    }
+    bn_read_be(sigs[i], &r[m]);
+    bn_read_be(sigs[i] + 32, &u2[m]);
+    bn_read_be(digests[i], &u1[m]);
+    if (bn_is_zero(&r[m]) || bn_is_zero(&u2[m]) || !bn_is_less(&r[m], order) ||
+        !bn_is_less(&u2[m], order)) {
+      status[i] = 2;
+      continue;
+    }
+    idx[m++] = i;
+  }
+
+  // u2 = s^-1 for all items at the cost of one inversion
+  bn_inverse_batch(u2, scratch, m, order);
+
+  for (i = 0, j = 0; i < m; i++) {
+    bn_multiply(&u2[i], &u1[i], order);  // z*s^-1
+    bn_mod(&u1[i], order);
+    if (bn_is_zero(&u1[i])) {
+      // our message hashes to zero
+      status[idx[i]] = 3;
+      continue;
+    }
+    bn_multiply(&r[i], &u2[i], order);  // r*s^-1
+    bn_mod(&u2[i], order);
+    idx[j] = idx[i];
+    pub[j] = pub[i];
+    r[j] = r[i];
+    u1[j] = u1[i];
+    u2[j] = u2[i];
+    j++;
+  }
+  m = j;
+
+  // precompute (2*j+1) * pub for j = 0..7 for all public keys and, if there
+  // is no precomputed table, for G
+  points = m;
+#if USE_PRECOMPUTED_CP
+  gtable = curve->cp[0];
+#else
+  pub[points++] = curve->G;
+#endif
+  for (i = 0; i < points; i++) {
+    jp[i].x = pub[i].x;
+    jp[i].y = pub[i].y;
+    bn_one(&jp[i].z);
+    point_jacobian_double(&jp[i], curve);
+  }
+  jacobian_to_curve_batch(jp, twice, points, prime);
+  for (i = 0; i < points; i++) {
+    jacobian_curve_point *jt = &jp[i * 8];
+    jt[0].x = pub[i].x;
+    jt[0].y = pub[i].y;
+    bn_one(&jt[0].z);
+    for (j = 1; j < 8; j++) {
+      jt[j] = jt[j - 1];
+      point_jacobian_add(&twice[i], &jt[j], curve);
+    }
+  }
+  jacobian_to_curve_batch(jp, table, points * 8, prime);
+#if !USE_PRECOMPUTED_CP
+  gtable = &table[m * 8];
+#endif
+
+  // res = u1 * G + u2 * pub with the doublings shared between both scalars
+  for (i = 0; i < m; i++) {
+    jacobian_curve_point res = {0};
+    int res_is_infinity = 1;
+    int len1 = bn_wnaf5(&u1[i], naf1);
+    int len2 = bn_wnaf5(&u2[i], naf2);
+    int k = 0;
+    for (k = (len1 > len2 ? len1 : len2) - 1; k >= 0; k--) {
+      if (!res_is_infinity) {
+        point_jacobian_double(&res, curve);
+      }
+      if (k < len1 && naf1[k] != 0) {
+        point_jacobian_add_digit(gtable, naf1[k], &res, &res_is_infinity,
+                                 curve);
+      }
+      if (k < len2 && naf2[k] != 0) {
+        point_jacobian_add_digit(&table[i * 8], naf2[k], &res,
+                                 &res_is_infinity, curve);
+      }
+    }
+    if (res_is_infinity || !jacobian_x_is_equal_mod_order(&res, &r[i], curve)) {
+      // the batch computation skips the special cases of point addition,
+      // let ecdsa_verify_digest decide
+      status[idx[i]] = -1;
+    }
+  }
+
+  for (i = 0; i < count; i++) {
+    if (status[i] == -1) {
+      status[i] = ecdsa_verify_digest(curve, pub_keys[i], sigs[i], digests[i]);
+    }
+    if (status[i] != 0) {
+      failed++;
+    }
+    if (results) {
+      results[i] = status[i];
+    }
+  }
+
+  return failed;
+}
+
+// Verifies count signatures at once, the i-th item is the signature sigs[i]
+// of digests[i] by pub_keys[i].
+// If results is not NULL, results[i] is set to the value ecdsa_verify_digest
+// returns for the i-th item.
+// returns the number of signatures that failed to verify
+int ecdsa_verify_digest_batch(const ecdsa_curve *curve, size_t count,
+                              const uint8_t *const *pub_keys,
+                              const uint8_t *const *sigs,
+                              const uint8_t *const *digests, int *results) {
+  size_t offset = 0;
+  int failed = 0;
+
+  for (offset = 0; offset < count; offset += ECDSA_VERIFY_BATCH_SIZE) {
+    size_t chunk = count - offset;
+    if (chunk > ECDSA_VERIFY_BATCH_SIZE) {
+      chunk = ECDSA_VERIFY_BATCH_SIZE;
+    }
+    failed += ecdsa_verify_digest_chunk(curve, chunk, pub_keys + offset,
+                                        sigs + offset, digests + offset,
+                                        results ? results + offset : NULL);
+  }
+
+  return failed;
+}
+
 int ecdsa_sig_to_der(const uint8_t *sig, uint8_t *der) {
   int i = 0;
   uint8_t *p = der, *len = NULL, *len1 = NULL, *len2 = NULL;
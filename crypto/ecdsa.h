@@ -34,6 +34,21 @@ typedef struct {
   bignum256 x, y;
 } curve_point;
 
+// curve point in jacobian coordinates (x/z^2, y/z^3)
+typedef struct jacobian_curve_point {
+  bignum256 x, y, z;
+} jacobian_curve_point;
+
+#if PRECOMPUTED_CP_WINDOW != 4 && PRECOMPUTED_CP_WINDOW != 5 && \
+    PRECOMPUTED_CP_WINDOW != 6 && PRECOMPUTED_CP_WINDOW != 8
+#error "PRECOMPUTED_CP_WINDOW must be 4, 5, 6 or 8"
+#endif
+
+// dimensions of the precomputed table, cp[i][j] = (2*j+1) * 2^(WINDOW*i) * G
+#define PRECOMPUTED_CP_ROWS \
+  ((256 + PRECOMPUTED_CP_WINDOW - 1) / PRECOMPUTED_CP_WINDOW)
+#define PRECOMPUTED_CP_COLS (1 << (PRECOMPUTED_CP_WINDOW - 1))
+
 typedef struct {
   bignum256 prime;       // prime order of the finite field
   curve_point G;         // initial curve point
@@ -43,7 +58,7 @@ typedef struct {
   bignum256 b;           // coefficient 'b' of the elliptic curve
 
 #if USE_PRECOMPUTED_CP
-  const curve_point cp[64][8];
+  const curve_point cp[PRECOMPUTED_CP_ROWS][PRECOMPUTED_CP_COLS];
 #endif
 
 } ecdsa_curve;
@@ -73,6 +88,18 @@ int point_is_equal(const curve_point *p, const curve_point *q);
 int point_is_negative_of(const curve_point *p, const curve_point *q);
 void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k,
                      curve_point *res);
+void scalar_multiply_add_batch(const ecdsa_curve *curve, const bignum256 *k,
+                               const curve_point *p, curve_point *res,
+                               size_t count);
+void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp,
+                       const bignum256 *prime);
+void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p,
+                       const bignum256 *prime);
+void jacobian_to_curve_batch(const jacobian_curve_point *jp, curve_point *p,
+                             size_t count, const bignum256 *prime);
+void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2,
+                        const ecdsa_curve *curve);
+void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve);
 int ecdh_multiply(const ecdsa_curve *curve, const uint8_t *priv_key,
                   const uint8_t *pub_key, uint8_t *session_key);
 void compress_coords(const curve_point *cp, uint8_t *compressed);
@@ -119,6 +146,10 @@ int ecdsa_verify(const ecdsa_curve *curve, HasherType hasher_sign,
                  uint32_t msg_len);
 int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key,
                         const uint8_t *sig, const uint8_t *digest);
+int ecdsa_verify_digest_batch(const ecdsa_curve *curve, size_t count,
+                              const uint8_t *const *pub_keys,
+                              const uint8_t *const *sigs,
+                              const uint8_t *const *digests, int *results);
 int ecdsa_recover_pub_from_sig(const ecdsa_curve *curve, uint8_t *pub_key,
                                const uint8_t *sig, const uint8_t *digest,
                                int recid);
@@ -368,6 +368,107 @@ void ge25519_double_scalarmult_vartime2(ge25519 *r, const ge25519 *p1, const big
 }
 #endif
 
+/*
+	Pippenger's bucket method for multi-scalar multiplication. The scalars are
+	recoded into signed digits of c bits, so every window needs 2^(c-1) buckets
+	and a negative digit subtracts the point instead of adding it.
+*/
+
+#define GE25519_MULTI_MAX_WINDOW 6
+#define GE25519_MULTI_MAX_DIGITS (256 / 3 + 2)
+
+/* recodes s into signed digits of c bits, -2^(c-1) < digit <= 2^(c-1), returns the number of digits */
+static int ge25519_multi_recode(signed char *digits, const bignum256modm s, int c) {
+	unsigned char bytes[32] = {0};
+	int carry = 0, w = 0;
+
+	contract256_modm(bytes, s);
+	for (w = 0; w * c < 256; w++) {
+		int bit = w * c;
+		uint32_t v = bytes[bit / 8];
+		if (bit / 8 + 1 < 32)
+			v |= (uint32_t)bytes[bit / 8 + 1] << 8;
+		int d = (int)((v >> (bit % 8)) & ((1u << c) - 1)) + carry;
+		carry = d > (1 << (c - 1));
+		digits[w] = (signed char)(d - (carry << c));
+	}
+	digits[w++] = (signed char)carry;
+	return w;
+}
+
+void ge25519_multi_scalarmult_vartime(ge25519 *r, const ge25519 *points, const bignum256modm *scalars, size_t n) {
+	ge25519_pniels pre[GE25519_MULTI_CHUNK];
+	signed char digits[GE25519_MULTI_CHUNK][GE25519_MULTI_MAX_DIGITS];
+	ge25519 buckets[1 << (GE25519_MULTI_MAX_WINDOW - 1)];
+	unsigned char used[1 << (GE25519_MULTI_MAX_WINDOW - 1)];
+	ge25519 acc, running, sum;
+	ge25519_p1p1 t;
+	size_t offset = 0, chunk = 0, i = 0;
+	int c = 0, windows = 0, w = 0, b = 0, k = 0;
+
+	ge25519_set_neutral(r);
+	for (offset = 0; offset < n; offset += chunk) {
+		chunk = n - offset;
+		if (chunk > GE25519_MULTI_CHUNK)
+			chunk = GE25519_MULTI_CHUNK;
+		c = chunk < 8 ? 3 : chunk < 32 ? 4 : chunk < 96 ? 5 : 6;
+
+		for (i = 0; i < chunk; i++) {
+			ge25519_full_to_pniels(&pre[i], &points[offset + i]);
+			windows = ge25519_multi_recode(digits[i], scalars[offset + i], c);
+		}
+
+		ge25519_set_neutral(&acc);
+		for (w = windows - 1; w >= 0; w--) {
+			for (k = 0; k < c - 1; k++)
+				ge25519_double_partial(&acc, &acc);
+			ge25519_double(&acc, &acc);
+
+			/* bucket[b] = sum of the points with digit +-(b+1) */
+			memset(used, 0, sizeof(used));
+			for (i = 0; i < chunk; i++) {
+				int d = digits[i][w];
+				if (!d)
+					continue;
+				b = abs(d) - 1;
+				if (!used[b]) {
+					ge25519_copy(&buckets[b], &points[offset + i]);
+					if (d < 0)
+						ge25519_neg_full(&buckets[b]);
+					used[b] = 1;
+				} else {
+					ge25519_pnielsadd_p1p1(&t, &buckets[b], &pre[i], (unsigned char)(d < 0));
+					ge25519_p1p1_to_full(&buckets[b], &t);
+				}
+			}
+
+			/* sum = sum of (b+1) * bucket[b], using the running sums of the buckets from the top */
+			int have_running = 0, have_sum = 0;
+			for (b = (1 << (c - 1)) - 1; b >= 0; b--) {
+				if (used[b]) {
+					if (have_running)
+						ge25519_add(&running, &running, &buckets[b], 0);
+					else
+						ge25519_copy(&running, &buckets[b]);
+					have_running = 1;
+				}
+				if (!have_running)
+					continue;
+				if (have_sum)
+					ge25519_add(&sum, &sum, &running, 0);
+				else
+					ge25519_copy(&sum, &running);
+				have_sum = 1;
+			}
+			if (have_sum)
+				ge25519_add(&acc, &acc, &sum, 0);
+		}
+		ge25519_add(r, r, &acc, 0);
+	}
+
+	memzero(digits, sizeof(digits));
+}
+
 /*
  * The following conditional move stuff uses conditional moves.
  * I will check on which compilers this works, and provide suitable
@@ -28,6 +28,13 @@ void ge25519_nielsadd2_p1p1(ge25519_p1p1 *r, const ge25519 *p, const ge25519_nie
 void ge25519_double_scalarmult_vartime2(ge25519 *r, const ge25519 *p1, const bignum256modm s1, const ge25519 *p2, const bignum256modm s2);
 #endif
 
+/* computes [s1]p1 + ... + [sn]pn, the points are processed in chunks of GE25519_MULTI_CHUNK,
+   which takes about GE25519_MULTI_CHUNK * 250 bytes + 5 KiB of stack */
+#ifndef GE25519_MULTI_CHUNK
+#define GE25519_MULTI_CHUNK 128
+#endif
+void ge25519_multi_scalarmult_vartime(ge25519 *r, const ge25519 *points, const bignum256modm *scalars, size_t n);
+
 void ge25519_pnielsadd_p1p1(ge25519_p1p1 *r, const ge25519 *p, const ge25519_pniels *q, unsigned char signbit);
 
 void ge25519_double_partial(ge25519 *r, const ge25519 *p);
@@ -38,6 +45,9 @@ void ge25519_nielsadd2(ge25519 *r, const ge25519_niels *q);
 
 void ge25519_pnielsadd(ge25519_pniels *r, const ge25519 *p, const ge25519_pniels *q);
 
+/* r = p[pos] out of n entries, in constant time */
+void ge25519_move_conditional_pniels_array(ge25519_pniels *r, const ge25519_pniels *p, int pos, int n);
+
 
 /*
 	pack & unpack
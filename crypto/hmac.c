@@ -29,20 +29,22 @@
 
 void hmac_sha256_Init(HMAC_SHA256_CTX *hctx, const uint8_t *key,
                       const uint32_t keylen) {
-  static CONFIDENTIAL uint8_t i_key_pad[SHA256_BLOCK_LENGTH];
-  memzero(i_key_pad, SHA256_BLOCK_LENGTH);
+  // build i_key_pad in place of o_key_pad, so that no shared buffer is
+  // needed and the function is reentrant
+  memzero(hctx->o_key_pad, SHA256_BLOCK_LENGTH);
   if (keylen > SHA256_BLOCK_LENGTH) {
-    sha256_Raw(key, keylen, i_key_pad);
+    sha256_Raw(key, keylen, hctx->o_key_pad);
   } else {
-    memcpy(i_key_pad, key, keylen);
+    memcpy(hctx->o_key_pad, key, keylen);
   }
   for (int i = 0; i < SHA256_BLOCK_LENGTH; i++) {
-    hctx->o_key_pad[i] = i_key_pad[i] ^ 0x5c;
-    i_key_pad[i] ^= 0x36;
+    hctx->o_key_pad[i] ^= 0x36;
   }
   sha256_Init(&(hctx->ctx));
-  sha256_Update(&(hctx->ctx), i_key_pad, SHA256_BLOCK_LENGTH);
-  memzero(i_key_pad, sizeof(i_key_pad));
+  sha256_Update(&(hctx->ctx), hctx->o_key_pad, SHA256_BLOCK_LENGTH);
+  for (int i = 0; i < SHA256_BLOCK_LENGTH; i++) {
+    hctx->o_key_pad[i] ^= 0x36 ^ 0x5c;
+  }
 }
 
 void hmac_sha256_Update(HMAC_SHA256_CTX *hctx, const uint8_t *msg,
@@ -61,7 +63,7 @@ void hmac_sha256_Final(HMAC_SHA256_CTX *hctx, uint8_t *hmac) {
 
 void hmac_sha256(const uint8_t *key, const uint32_t keylen, const uint8_t *msg,
                  const uint32_t msglen, uint8_t *hmac) {
-  static CONFIDENTIAL HMAC_SHA256_CTX hctx;
+  static THREAD_LOCAL CONFIDENTIAL HMAC_SHA256_CTX hctx;
   hmac_sha256_Init(&hctx, key, keylen);
   hmac_sha256_Update(&hctx, msg, msglen);
   hmac_sha256_Final(&hctx, hmac);
@@ -69,11 +71,12 @@ void hmac_sha256(const uint8_t *key, const uint32_t keylen, const uint8_t *msg,
 
 void hmac_sha256_prepare(const uint8_t *key, const uint32_t keylen,
                          uint32_t *opad_digest, uint32_t *ipad_digest) {
-  static CONFIDENTIAL uint32_t key_pad[SHA256_BLOCK_LENGTH / sizeof(uint32_t)];
+  static THREAD_LOCAL CONFIDENTIAL uint32_t
+      key_pad[SHA256_BLOCK_LENGTH / sizeof(uint32_t)];
 
   memzero(key_pad, sizeof(key_pad));
   if (keylen > SHA256_BLOCK_LENGTH) {
-    static CONFIDENTIAL SHA256_CTX context;
+    static THREAD_LOCAL CONFIDENTIAL SHA256_CTX context;
     sha256_Init(&context);
     sha256_Update(&context, key, keylen);
     sha256_Final(&context, (uint8_t *)key_pad);
@@ -103,20 +106,22 @@ void hmac_sha256_prepare(const uint8_t *key, const uint32_t keylen,
 
 void hmac_sha512_Init(HMAC_SHA512_CTX *hctx, const uint8_t *key,
                       const uint32_t keylen) {
-  static CONFIDENTIAL uint8_t i_key_pad[SHA512_BLOCK_LENGTH];
-  memzero(i_key_pad, SHA512_BLOCK_LENGTH);
+  // build i_key_pad in place of o_key_pad, so that no shared buffer is
+  // needed and the function is reentrant
+  memzero(hctx->o_key_pad, SHA512_BLOCK_LENGTH);
   if (keylen > SHA512_BLOCK_LENGTH) {
-    sha512_Raw(key, keylen, i_key_pad);
+    sha512_Raw(key, keylen, hctx->o_key_pad);
   } else {
-    memcpy(i_key_pad, key, keylen);
+    memcpy(hctx->o_key_pad, key, keylen);
   }
   for (int i = 0; i < SHA512_BLOCK_LENGTH; i++) {
-    hctx->o_key_pad[i] = i_key_pad[i] ^ 0x5c;
-    i_key_pad[i] ^= 0x36;
+    hctx->o_key_pad[i] ^= 0x36;
   }
   sha512_Init(&(hctx->ctx));
-  sha512_Update(&(hctx->ctx), i_key_pad, SHA512_BLOCK_LENGTH);
-  memzero(i_key_pad, sizeof(i_key_pad));
+  sha512_Update(&(hctx->ctx), hctx->o_key_pad, SHA512_BLOCK_LENGTH);
+  for (int i = 0; i < SHA512_BLOCK_LENGTH; i++) {
+    hctx->o_key_pad[i] ^= 0x36 ^ 0x5c;
+  }
 }
 
 void hmac_sha512_Update(HMAC_SHA512_CTX *hctx, const uint8_t *msg,
@@ -143,11 +148,12 @@ void hmac_sha512(const uint8_t *key, const uint32_t keylen, const uint8_t *msg,
 
 void hmac_sha512_prepare(const uint8_t *key, const uint32_t keylen,
                          uint64_t *opad_digest, uint64_t *ipad_digest) {
-  static CONFIDENTIAL uint64_t key_pad[SHA512_BLOCK_LENGTH / sizeof(uint64_t)];
+  static THREAD_LOCAL CONFIDENTIAL uint64_t
+      key_pad[SHA512_BLOCK_LENGTH / sizeof(uint64_t)];
 
   memzero(key_pad, sizeof(key_pad));
   if (keylen > SHA512_BLOCK_LENGTH) {
-    static CONFIDENTIAL SHA512_CTX context;
+    static THREAD_LOCAL CONFIDENTIAL SHA512_CTX context;
     sha512_Init(&context);
     sha512_Update(&context, key, keylen);
     sha512_Final(&context, (uint8_t *)key_pad);
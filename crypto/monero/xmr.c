@@ -3,7 +3,9 @@
 //
 
 #include "xmr.h"
+#include <stdlib.h>
 #include "int-util.h"
+#include "memzero.h"
 #include "rand.h"
 #include "serialize.h"
 
@@ -141,3 +143,275 @@ void xmr_gen_c(ge25519 *r, const bignum256modm a, uint64_t amount) {
   set256_modm(b, amount);
   xmr_add_keys2(r, a, b, &xmr_h);
 }
+
+// Straus' method keeps the odd multiples of XMR_STRAUS_GROUP points and their
+// sliding window digits on the stack and shares the doublings among them.
+#define XMR_STRAUS_WINDOW 5
+#define XMR_STRAUS_TABLE (1 << (XMR_STRAUS_WINDOW - 2))
+
+static int xmr_multiexp_straus(ge25519 *r, const xmr_key_t *scalars,
+                               const xmr_key_t *points, size_t n) {
+  signed char slide[XMR_STRAUS_GROUP][256] = {0};
+  ge25519_pniels pre[XMR_STRAUS_GROUP][XMR_STRAUS_TABLE] = {0};
+  ge25519 P = {0}, dp = {0};
+  ge25519_p1p1 t = {0};
+  bignum256modm s = {0};
+  int i = 0, top = -1;
+  size_t j = 0;
+
+  for (j = 0; j < n; j++) {
+    if (!ge25519_unpack_vartime(&P, points[j])) {
+      return 0;
+    }
+    expand256_modm(s, scalars[j], 32);
+    contract256_slidingwindow_modm(slide[j], s, XMR_STRAUS_WINDOW);
+
+    ge25519_double(&dp, &P);
+    ge25519_full_to_pniels(pre[j], &P);
+    for (i = 0; i < XMR_STRAUS_TABLE - 1; i++) {
+      ge25519_pnielsadd(&pre[j][i + 1], &dp, &pre[j][i]);
+    }
+
+    for (i = 255; i > top && !slide[j][i]; i--)
+      ;
+    top = i;
+  }
+
+  ge25519_set_neutral(r);
+  if (top < 0) {
+    return 1;
+  }
+  for (i = top; i >= 0; i--) {
+    ge25519_double_p1p1(&t, r);
+    for (j = 0; j < n; j++) {
+      signed char d = slide[j][i];
+      if (d) {
+        ge25519_p1p1_to_full(r, &t);
+        ge25519_pnielsadd_p1p1(&t, r, &pre[j][abs(d) / 2],
+                               (unsigned char)d >> 7);
+      }
+    }
+    ge25519_p1p1_to_partial(r, &t);
+  }
+  curve25519_mul(r->t, t.x, t.y);
+  return 1;
+}
+
+static int xmr_multiexp_pippenger(ge25519 *r, const xmr_key_t *scalars,
+                                  const xmr_key_t *points, size_t n) {
+  ge25519 P[GE25519_MULTI_CHUNK] = {0};
+  bignum256modm s[GE25519_MULTI_CHUNK] = {0};
+
+  for (size_t i = 0; i < n; i++) {
+    if (!ge25519_unpack_vartime(&P[i], points[i])) {
+      return 0;
+    }
+    expand256_modm(s[i], scalars[i], 32);
+  }
+  ge25519_multi_scalarmult_vartime(r, P, s, n);
+  return 1;
+}
+
+int xmr_multiexp_vartime(ge25519 *r, const xmr_key_t *scalars,
+                         const xmr_key_t *points, size_t n) {
+  ge25519 acc = {0};
+  size_t i = 0, len = 0;
+  int ok = 0;
+
+  ge25519_set_neutral(r);
+  for (i = 0; i < n; i += len) {
+    len = n - i;
+    if (GE25519_MULTI_CHUNK >= XMR_PIPPENGER_MIN && len >= XMR_PIPPENGER_MIN) {
+      len = len < GE25519_MULTI_CHUNK ? len : GE25519_MULTI_CHUNK;
+      ok = xmr_multiexp_pippenger(&acc, scalars + i, points + i, len);
+    } else {
+      len = len < XMR_STRAUS_GROUP ? len : XMR_STRAUS_GROUP;
+      ok = xmr_multiexp_straus(&acc, scalars + i, points + i, len);
+    }
+    if (!ok) {
+      return 0;
+    }
+    ge25519_add(r, r, &acc, 0);
+  }
+  return 1;
+}
+
+// The constant-time variant of Straus' method adds a multiple of every point
+// for each 4-bit window, the multiple is selected by conditional moves.
+static int xmr_multiexp_straus_consttime(ge25519 *r, const xmr_key_t *scalars,
+                                         const xmr_key_t *points, size_t n) {
+  signed char slide[XMR_STRAUS_GROUP][64] = {0};
+  ge25519_pniels pre[XMR_STRAUS_GROUP][9] = {0};
+  ge25519_pniels sel = {0};
+  ge25519 P = {0}, dp = {0};
+  ge25519_p1p1 t = {0};
+  bignum256modm s = {0};
+  int i = 0;
+  size_t j = 0;
+
+  ge25519_set_neutral(r);
+  for (j = 0; j < n; j++) {
+    if (!ge25519_unpack_vartime(&P, points[j])) {
+      memzero(slide, sizeof(slide));
+      memzero(s, sizeof(s));
+      return 0;
+    }
+    expand256_modm(s, scalars[j], 32);
+    contract256_window4_modm(slide[j], s);
+
+    // 0P, 1P, ..., 8P
+    ge25519_full_to_pniels(&pre[j][0], r);
+    ge25519_full_to_pniels(&pre[j][1], &P);
+    ge25519_double(&dp, &P);
+    ge25519_full_to_pniels(&pre[j][2], &dp);
+    for (i = 1; i < 7; i++) {
+      ge25519_pnielsadd(&pre[j][i + 2], &dp, &pre[j][i]);
+    }
+  }
+  if (n == 0) {
+    return 1;
+  }
+
+  for (i = 63; i >= 0; i--) {
+    ge25519_double_partial(r, r);
+    ge25519_double_partial(r, r);
+    ge25519_double_partial(r, r);
+    ge25519_double_p1p1(&t, r);
+    for (j = 0; j < n; j++) {
+      ge25519_move_conditional_pniels_array(&sel, pre[j], abs(slide[j][i]), 9);
+      ge25519_p1p1_to_full(r, &t);
+      ge25519_pnielsadd_p1p1(&t, r, &sel, (unsigned char)slide[j][i] >> 7);
+    }
+    ge25519_p1p1_to_partial(r, &t);
+  }
+  curve25519_mul(r->t, t.x, t.y);
+  memzero(slide, sizeof(slide));
+  memzero(s, sizeof(s));
+  memzero(&sel, sizeof(sel));
+  return 1;
+}
+
+int xmr_multiexp(ge25519 *r, const xmr_key_t *scalars, const xmr_key_t *points,
+                 size_t n) {
+  ge25519 acc = {0};
+  size_t i = 0, len = 0;
+
+  ge25519_set_neutral(r);
+  for (i = 0; i < n; i += len) {
+    len = n - i < XMR_STRAUS_GROUP ? n - i : XMR_STRAUS_GROUP;
+    if (!xmr_multiexp_straus_consttime(&acc, scalars + i, points + i, len)) {
+      return 0;
+    }
+    ge25519_add(r, r, &acc, 0);
+  }
+  return 1;
+}
+
+void xmr_sc_add_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                    size_t n) {
+  bignum256modm x = {0}, y = {0};
+  for (size_t i = 0; i < n; i++) {
+    expand_raw256_modm(x, a[i]);
+    expand_raw256_modm(y, b[i]);
+    add256_modm(x, x, y);
+    contract256_modm(r[i], x);
+  }
+}
+
+void xmr_sc_sub_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                    size_t n) {
+  bignum256modm x = {0}, y = {0};
+  for (size_t i = 0; i < n; i++) {
+    expand_raw256_modm(x, a[i]);
+    expand_raw256_modm(y, b[i]);
+    sub256_modm(x, x, y);
+    contract256_modm(r[i], x);
+  }
+}
+
+void xmr_sc_mul_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                    size_t n) {
+  bignum256modm x = {0}, y = {0};
+  for (size_t i = 0; i < n; i++) {
+    expand_raw256_modm(x, a[i]);
+    expand_raw256_modm(y, b[i]);
+    mul256_modm(x, x, y);
+    contract256_modm(r[i], x);
+  }
+}
+
+void xmr_sc_muladd_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                       const xmr_key_t *c, size_t n) {
+  bignum256modm x = {0}, y = {0}, z = {0};
+  for (size_t i = 0; i < n; i++) {
+    expand_raw256_modm(x, a[i]);
+    expand_raw256_modm(y, b[i]);
+    expand_raw256_modm(z, c[i]);
+    muladd256_modm(x, x, y, z);
+    contract256_modm(r[i], x);
+  }
+}
+
+void xmr_sc_fold_vec(xmr_key_t *r, const xmr_key_t *a, const bignum256modm s,
+                     const xmr_key_t *b, const bignum256modm t, size_t n) {
+  bignum256modm x = {0}, y = {0};
+  for (size_t i = 0; i < n; i++) {
+    expand_raw256_modm(x, a[i]);
+    mul256_modm(x, x, s);
+    if (b) {
+      expand_raw256_modm(y, b[i]);
+      muladd256_modm(x, y, t, x);
+    }
+    contract256_modm(r[i], x);
+  }
+}
+
+void xmr_sc_inner_product(bignum256modm r, const xmr_key_t *a,
+                          const xmr_key_t *b, size_t n) {
+  bignum256modm x = {0}, y = {0};
+  set256_modm(r, 0);
+  for (size_t i = 0; i < n; i++) {
+    expand_raw256_modm(x, a[i]);
+    expand_raw256_modm(y, b[i]);
+    muladd256_modm(r, x, y, r);
+  }
+}
+
+int xmr_ge25519_fold_vec(xmr_key_t *r, const xmr_key_t *P,
+                         const bignum256modm s, const xmr_key_t *Q,
+                         const bignum256modm t, size_t n) {
+  ge25519 A = {0}, B = {0}, R = {0};
+  for (size_t i = 0; i < n; i++) {
+    if (!ge25519_unpack_vartime(&A, P[i])) {
+      return 0;
+    }
+    if (Q) {
+      if (!ge25519_unpack_vartime(&B, Q[i])) {
+        return 0;
+      }
+      ge25519_double_scalarmult_vartime2(&R, &A, s, &B, t);
+    } else {
+      ge25519_scalarmult(&R, &A, s);
+    }
+    ge25519_pack(r[i], &R);
+  }
+  return 1;
+}
+
+int xmr_hash_to_scalar_range(xmr_key_t *r, uint8_t *buf, size_t len,
+                             size_t idx_off, uint32_t start, size_t n) {
+  bignum256modm s = {0};
+  if (idx_off > len) {
+    return 0;
+  }
+  for (size_t i = 0; i < n; i++) {
+    if ((size_t)xmr_size_varint(start + i) > len - idx_off) {
+      return 0;
+    }
+    memset(buf + idx_off, 0, len - idx_off);
+    xmr_write_varint(buf + idx_off, len - idx_off, start + i);
+    xmr_hash_to_scalar(s, buf, len);
+    contract256_modm(r[i], s);
+  }
+  return 1;
+}
@@ -73,4 +73,65 @@ void xmr_get_subaddress_secret_key(bignum256modm r, uint32_t major,
 /* Generates Pedersen commitment C = aG + bH */
 void xmr_gen_c(ge25519 *r, const bignum256modm a, uint64_t amount);
 
+// The number of points processed together by Straus' method, each of them
+// takes about 1.3 KiB of stack.
+#ifndef XMR_STRAUS_GROUP
+#define XMR_STRAUS_GROUP 4
+#endif
+
+// Pippenger's method is used for at least this many points, provided that
+// GE25519_MULTI_CHUNK allows to process them at once.
+#ifndef XMR_PIPPENGER_MIN
+#define XMR_PIPPENGER_MIN 64
+#endif
+
+/* sum of scalars[i] * points[i], the scalars are reduced and the points are
+ * decoded from the packed keys, returns 0 if a point is invalid. The time
+ * depends on the points only, the scalars may be secret. */
+int xmr_multiexp(ge25519 *r, const xmr_key_t *scalars, const xmr_key_t *points,
+                 size_t n);
+
+/* The same as xmr_multiexp, but the time depends on the scalars, so they must
+ * not be secret. */
+int xmr_multiexp_vartime(ge25519 *r, const xmr_key_t *scalars,
+                         const xmr_key_t *points, size_t n);
+
+/* Element-wise operations on n packed scalars, the scalars are not reduced
+ * when decoded and r may be the same buffer as the inputs. */
+
+/* r_i = a_i + b_i */
+void xmr_sc_add_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                    size_t n);
+
+/* r_i = a_i - b_i */
+void xmr_sc_sub_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                    size_t n);
+
+/* r_i = a_i * b_i, the Hadamard product */
+void xmr_sc_mul_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                    size_t n);
+
+/* r_i = a_i * b_i + c_i */
+void xmr_sc_muladd_vec(xmr_key_t *r, const xmr_key_t *a, const xmr_key_t *b,
+                       const xmr_key_t *c, size_t n);
+
+/* r_i = s a_i + t b_i, or s a_i if b is NULL */
+void xmr_sc_fold_vec(xmr_key_t *r, const xmr_key_t *a, const bignum256modm s,
+                     const xmr_key_t *b, const bignum256modm t, size_t n);
+
+/* r = a_0 b_0 + ... + a_{n-1} b_{n-1} */
+void xmr_sc_inner_product(bignum256modm r, const xmr_key_t *a,
+                          const xmr_key_t *b, size_t n);
+
+/* R_i = s P_i + t Q_i, or s P_i if Q is NULL, returns 0 if a point is
+ * invalid */
+int xmr_ge25519_fold_vec(xmr_key_t *r, const xmr_key_t *P,
+                         const bignum256modm s, const xmr_key_t *Q,
+                         const bignum256modm t, size_t n);
+
+/* r_i = H_s(buf[0:len]) with varint(start + i) written at idx_off and the
+ * rest of buf zeroed, returns 0 if the index does not fit */
+int xmr_hash_to_scalar_range(xmr_key_t *r, uint8_t *buf, size_t len,
+                             size_t idx_off, uint32_t start, size_t n);
+
 #endif  // TREZOR_CRYPTO_XMR_H
@@ -54,7 +54,15 @@ const ecdsa_curve nist256p1 = {
     ,
     /* cp */
     {
+#if PRECOMPUTED_CP_WINDOW == 4
 #include "nist256p1.table"
+#elif PRECOMPUTED_CP_WINDOW == 5
+#include "nist256p1.w5.table"
+#elif PRECOMPUTED_CP_WINDOW == 6
+#include "nist256p1.w6.table"
+#else
+#include "nist256p1.w8.table"
+#endif
     }
 #endif
 };
@@ -28,6 +28,13 @@
 #define USE_PRECOMPUTED_CP 1
 #endif
 
+// width in bits of the windows of the precomputed Curve Points, a wider window
+// halves the number of point additions at the cost of a larger table:
+// 4 bits - 36 KiB, 5 bits - 58 KiB, 6 bits - 97 KiB, 8 bits - 288 KiB per curve
+#ifndef PRECOMPUTED_CP_WINDOW
+#define PRECOMPUTED_CP_WINDOW 4
+#endif
+
 // use fast inverse method
 #ifndef USE_INVERSE_FAST
 #define USE_INVERSE_FAST 1
@@ -86,6 +93,22 @@
 #define USE_CARDANO 0
 #endif
 
+// keep the scratch buffers and the BIP32 and BIP39 caches per thread, so that
+// the library can be used from several threads at once
+#ifndef USE_REENTRANT
+#define USE_REENTRANT 0
+#endif
+
+// multiply modulo the secp256k1 and nist256p1 primes with 64-bit limbs and
+// unsigned __int128, which is faster on 64-bit hosts
+#ifndef USE_BN_64
+#ifdef __SIZEOF_INT128__
+#define USE_BN_64 1
+#else
+#define USE_BN_64 0
+#endif
+#endif
+
 // support Keccak hashing
 #ifndef USE_KECCAK
 #define USE_KECCAK 1
@@ -96,4 +119,11 @@
 #define CONFIDENTIAL
 #endif
 
+// mark static data which is kept per thread in the reentrant mode
+#if USE_REENTRANT
+#define THREAD_LOCAL _Thread_local
+#else
+#define THREAD_LOCAL
+#endif
+
 #endif
@@ -67,6 +67,52 @@ void pbkdf2_hmac_sha256_Update(PBKDF2_HMAC_SHA256_CTX *pctx,
   pctx->first = 0;
 }
 
+// runs the iterations of a group of 1, 4 or 8 contexts in lockstep
+static void pbkdf2_hmac_sha256_Update_group(PBKDF2_HMAC_SHA256_CTX *pctx,
+                                            size_t lanes, uint32_t iterations) {
+  const uint32_t *idig[8] = {0}, *odig[8] = {0}, *in[8] = {0};
+  uint32_t *g[8] = {0};
+  for (size_t l = 0; l < lanes; l++) {
+    idig[l] = pctx[l].idig;
+    odig[l] = pctx[l].odig;
+    in[l] = g[l] = pctx[l].g;
+  }
+  for (uint32_t i = pctx[0].first; i < iterations; i++) {
+    if (lanes == 8) {
+      sha256_Transform_x8(idig, in, g);
+      sha256_Transform_x8(odig, in, g);
+    } else if (lanes == 4) {
+      sha256_Transform_x4(idig, in, g);
+      sha256_Transform_x4(odig, in, g);
+    } else {
+      sha256_Transform(idig[0], in[0], g[0]);
+      sha256_Transform(odig[0], in[0], g[0]);
+    }
+    for (size_t l = 0; l < lanes; l++) {
+      for (uint32_t j = 0; j < SHA256_DIGEST_LENGTH / sizeof(uint32_t); j++) {
+        pctx[l].f[j] ^= pctx[l].g[j];
+      }
+    }
+  }
+  for (size_t l = 0; l < lanes; l++) {
+    pctx[l].first = 0;
+  }
+}
+
+void pbkdf2_hmac_sha256_Update_lanes(PBKDF2_HMAC_SHA256_CTX *pctx,
+                                     size_t count, uint32_t iterations) {
+  size_t offset = 0;
+  for (; count - offset >= 8; offset += 8) {
+    pbkdf2_hmac_sha256_Update_group(pctx + offset, 8, iterations);
+  }
+  for (; count - offset >= 4; offset += 4) {
+    pbkdf2_hmac_sha256_Update_group(pctx + offset, 4, iterations);
+  }
+  for (; offset < count; offset++) {
+    pbkdf2_hmac_sha256_Update_group(pctx + offset, 1, iterations);
+  }
+}
+
 void pbkdf2_hmac_sha256_Final(PBKDF2_HMAC_SHA256_CTX *pctx, uint8_t *key) {
 #if BYTE_ORDER == LITTLE_ENDIAN
   for (uint32_t k = 0; k < SHA256_DIGEST_LENGTH / sizeof(uint32_t); k++) {
@@ -143,6 +189,52 @@ void pbkdf2_hmac_sha512_Update(PBKDF2_HMAC_SHA512_CTX *pctx,
   pctx->first = 0;
 }
 
+// runs the iterations of a group of 1, 2 or 4 contexts in lockstep
+static void pbkdf2_hmac_sha512_Update_group(PBKDF2_HMAC_SHA512_CTX *pctx,
+                                            size_t lanes, uint32_t iterations) {
+  const uint64_t *idig[4] = {0}, *odig[4] = {0}, *in[4] = {0};
+  uint64_t *g[4] = {0};
+  for (size_t l = 0; l < lanes; l++) {
+    idig[l] = pctx[l].idig;
+    odig[l] = pctx[l].odig;
+    in[l] = g[l] = pctx[l].g;
+  }
+  for (uint32_t i = pctx[0].first; i < iterations; i++) {
+    if (lanes == 4) {
+      sha512_Transform_x4(idig, in, g);
+      sha512_Transform_x4(odig, in, g);
+    } else if (lanes == 2) {
+      sha512_Transform_x2(idig, in, g);
+      sha512_Transform_x2(odig, in, g);
+    } else {
+      sha512_Transform(idig[0], in[0], g[0]);
+      sha512_Transform(odig[0], in[0], g[0]);
+    }
+    for (size_t l = 0; l < lanes; l++) {
+      for (uint32_t j = 0; j < SHA512_DIGEST_LENGTH / sizeof(uint64_t); j++) {
+        pctx[l].f[j] ^= pctx[l].g[j];
+      }
+    }
+  }
+  for (size_t l = 0; l < lanes; l++) {
+    pctx[l].first = 0;
+  }
+}
+
+void pbkdf2_hmac_sha512_Update_lanes(PBKDF2_HMAC_SHA512_CTX *pctx,
+                                     size_t count, uint32_t iterations) {
+  size_t offset = 0;
+  for (; count - offset >= 4; offset += 4) {
+    pbkdf2_hmac_sha512_Update_group(pctx + offset, 4, iterations);
+  }
+  for (; count - offset >= 2; offset += 2) {
+    pbkdf2_hmac_sha512_Update_group(pctx + offset, 2, iterations);
+  }
+  if (offset < count) {
+    pbkdf2_hmac_sha512_Update_group(pctx + offset, 1, iterations);
+  }
+}
+
 void pbkdf2_hmac_sha512_Final(PBKDF2_HMAC_SHA512_CTX *pctx, uint8_t *key) {
 #if BYTE_ORDER == LITTLE_ENDIAN
   for (uint32_t k = 0; k < SHA512_DIGEST_LENGTH / sizeof(uint64_t); k++) {
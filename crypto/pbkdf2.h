@@ -24,6 +24,7 @@
 #ifndef __PBKDF2_H__
 #define __PBKDF2_H__
 
+#include <stddef.h>
 #include <stdint.h>
 #include "sha2.h"
 
@@ -48,6 +49,11 @@ void pbkdf2_hmac_sha256_Init(PBKDF2_HMAC_SHA256_CTX *pctx, const uint8_t *pass,
                              uint32_t blocknr);
 void pbkdf2_hmac_sha256_Update(PBKDF2_HMAC_SHA256_CTX *pctx,
                                uint32_t iterations);
+// Same as calling pbkdf2_hmac_sha256_Update on count independent contexts,
+// but the SHA-256 compressions of up to eight contexts are interleaved.
+// All contexts must be at the same stage.
+void pbkdf2_hmac_sha256_Update_lanes(PBKDF2_HMAC_SHA256_CTX *pctx,
+                                     size_t count, uint32_t iterations);
 void pbkdf2_hmac_sha256_Final(PBKDF2_HMAC_SHA256_CTX *pctx, uint8_t *key);
 void pbkdf2_hmac_sha256(const uint8_t *pass, int passlen, const uint8_t *salt,
                         int saltlen, uint32_t iterations, uint8_t *key,
@@ -58,6 +64,12 @@ void pbkdf2_hmac_sha512_Init(PBKDF2_HMAC_SHA512_CTX *pctx, const uint8_t *pass,
                              uint32_t blocknr);
 void pbkdf2_hmac_sha512_Update(PBKDF2_HMAC_SHA512_CTX *pctx,
                                uint32_t iterations);
+// Same as calling pbkdf2_hmac_sha512_Update on count independent contexts,
+// but the SHA-512 compressions of up to four contexts are interleaved.
+// All contexts must be at the same stage, i.e. initialized together and
+// updated with the same number of iterations so far.
+void pbkdf2_hmac_sha512_Update_lanes(PBKDF2_HMAC_SHA512_CTX *pctx,
+                                     size_t count, uint32_t iterations);
 void pbkdf2_hmac_sha512_Final(PBKDF2_HMAC_SHA512_CTX *pctx, uint8_t *key);
 void pbkdf2_hmac_sha512(const uint8_t *pass, int passlen, const uint8_t *salt,
                         int saltlen, uint32_t iterations, uint8_t *key,
@@ -52,7 +52,15 @@ const ecdsa_curve secp256k1 = {
     ,
     /* cp */
     {
+#if PRECOMPUTED_CP_WINDOW == 4
 #include "secp256k1.table"
+#elif PRECOMPUTED_CP_WINDOW == 5
+#include "secp256k1.w5.table"
+#elif PRECOMPUTED_CP_WINDOW == 6
+#include "secp256k1.w6.table"
+#else
+#include "secp256k1.w8.table"
+#endif
     }
 #endif
 };
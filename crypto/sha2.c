@@ -1281,3 +1281,294 @@ char* sha512_Data(const sha2_byte* data, size_t len, char digest[SHA512_DIGEST_S
 	sha512_Update(&context, data, len);
 	return sha512_End(&context, digest);
 }
+
+/*** MULTI-BUFFER TRANSFORMS ******************************************/
+/*
+ * The multi-buffer transforms compute the compression function of several
+ * independent blocks at once.  The blocks are kept in the lanes of generic
+ * vector types, which GCC and clang lower to whatever SIMD instructions the
+ * target has, or to scalar code.  On x86 the kernels are additionally built
+ * for AVX2 and AVX-512VL and the best variant is picked at runtime.
+ *
+ * All of them give exactly the same results as calling sha256_Transform or
+ * sha512_Transform on every lane, which remain the reference.
+ */
+#if defined(__GNUC__)
+
+typedef sha2_word32 sha2_word32x4 __attribute__((vector_size(16)));
+typedef sha2_word32 sha2_word32x8 __attribute__((vector_size(32)));
+typedef sha2_word64 sha2_word64x2 __attribute__((vector_size(16)));
+typedef sha2_word64 sha2_word64x4 __attribute__((vector_size(32)));
+
+#define LOAD_X2(p, i)	{(p)[0][i], (p)[1][i]}
+#define LOAD_X4(p, i)	{(p)[0][i], (p)[1][i], (p)[2][i], (p)[3][i]}
+#define LOAD_X8(p, i)	{(p)[0][i], (p)[1][i], (p)[2][i], (p)[3][i], \
+			 (p)[4][i], (p)[5][i], (p)[6][i], (p)[7][i]}
+
+#define ROUND_VEC(a,b,c,d,e,f,g,h,S0,S1,K)	\
+	T1 = (h) + S1(e) + Ch((e), (f), (g)) + K[j] + W[j&0x0f]; \
+	(d) += T1; \
+	(h) = T1 + S0(a) + Maj((a), (b), (c)); \
+	j++
+
+#define ROUNDS_VEC(S0,S1,K)	\
+	ROUND_VEC(a,b,c,d,e,f,g,h,S0,S1,K); \
+	ROUND_VEC(h,a,b,c,d,e,f,g,S0,S1,K); \
+	ROUND_VEC(g,h,a,b,c,d,e,f,S0,S1,K); \
+	ROUND_VEC(f,g,h,a,b,c,d,e,S0,S1,K); \
+	ROUND_VEC(e,f,g,h,a,b,c,d,S0,S1,K); \
+	ROUND_VEC(d,e,f,g,h,a,b,c,S0,S1,K); \
+	ROUND_VEC(c,d,e,f,g,h,a,b,S0,S1,K); \
+	ROUND_VEC(b,c,d,e,f,g,h,a,S0,S1,K)
+
+#define EXPAND_VEC(s0,s1)	\
+	W[j&0x0f] += s1(W[(j+14)&0x0f]) + W[(j+9)&0x0f] + s0(W[(j+1)&0x0f])
+
+#define EXPANDED_ROUNDS_VEC(S0,S1,s0,s1,K)	\
+	EXPAND_VEC(s0,s1); ROUND_VEC(a,b,c,d,e,f,g,h,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(h,a,b,c,d,e,f,g,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(g,h,a,b,c,d,e,f,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(f,g,h,a,b,c,d,e,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(e,f,g,h,a,b,c,d,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(d,e,f,g,h,a,b,c,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(c,d,e,f,g,h,a,b,S0,S1,K); \
+	EXPAND_VEC(s0,s1); ROUND_VEC(b,c,d,e,f,g,h,a,S0,S1,K)
+
+/* Body of a multi-buffer transform with LANES lanes of vector type VEC */
+#define TRANSFORM_VEC(VEC, LANES, LOAD, ROUNDS, S0, S1, s0, s1, K)	\
+	VEC	a, b, c, d, e, f, g, h, T1, W[16], S[8]; \
+	int	i = 0, j = 0, l = 0; \
+\
+	/* Load all data before storing anything, state_out may alias data */ \
+	for (i = 0; i < 16; i++) { \
+		W[i] = (VEC)LOAD(data, i); \
+	} \
+	for (i = 0; i < 8; i++) { \
+		S[i] = (VEC)LOAD(state_in, i); \
+	} \
+	a = S[0]; b = S[1]; c = S[2]; d = S[3]; \
+	e = S[4]; f = S[5]; g = S[6]; h = S[7]; \
+\
+	do { \
+		ROUNDS_VEC(S0,S1,K); \
+	} while (j < 16); \
+	do { \
+		EXPANDED_ROUNDS_VEC(S0,S1,s0,s1,K); \
+	} while (j < ROUNDS); \
+\
+	/* Compute the current intermediate hash values */ \
+	S[0] += a; S[1] += b; S[2] += c; S[3] += d; \
+	S[4] += e; S[5] += f; S[6] += g; S[7] += h; \
+	for (l = 0; l < LANES; l++) { \
+		for (i = 0; i < 8; i++) { \
+			state_out[l][i] = S[i][l]; \
+		} \
+	} \
+\
+	/* Clean up */ \
+	memzero(S, sizeof(S)); \
+	memzero(W, sizeof(W)); \
+	a = b = c = d = e = f = g = h = T1 = S[0]
+
+#define TRANSFORM256_VEC(VEC, LANES, LOAD)	\
+	TRANSFORM_VEC(VEC, LANES, LOAD, 64, Sigma0_256, Sigma1_256, \
+		      sigma0_256, sigma1_256, K256)
+#define TRANSFORM512_VEC(VEC, LANES, LOAD)	\
+	TRANSFORM_VEC(VEC, LANES, LOAD, 80, Sigma0_512, Sigma1_512, \
+		      sigma0_512, sigma1_512, K512)
+
+typedef struct {
+	const char *name;
+	void (*sha256_x4)(const sha2_word32* const*, const sha2_word32* const*, sha2_word32* const*);
+	void (*sha256_x8)(const sha2_word32* const*, const sha2_word32* const*, sha2_word32* const*);
+	void (*sha512_x2)(const sha2_word64* const*, const sha2_word64* const*, sha2_word64* const*);
+	void (*sha512_x4)(const sha2_word64* const*, const sha2_word64* const*, sha2_word64* const*);
+} sha2_multi_backend;
+
+/* Defines the kernels of one backend, ATTR selects the instruction set */
+#define SHA2_MULTI_BACKEND(NAME, ATTR)	\
+ATTR static void sha256_Transform_x4_##NAME(const sha2_word32* const* state_in, const sha2_word32* const* data, sha2_word32* const* state_out) { \
+	TRANSFORM256_VEC(sha2_word32x4, 4, LOAD_X4); \
+} \
+ATTR static void sha256_Transform_x8_##NAME(const sha2_word32* const* state_in, const sha2_word32* const* data, sha2_word32* const* state_out) { \
+	TRANSFORM256_VEC(sha2_word32x8, 8, LOAD_X8); \
+} \
+ATTR static void sha512_Transform_x2_##NAME(const sha2_word64* const* state_in, const sha2_word64* const* data, sha2_word64* const* state_out) { \
+	TRANSFORM512_VEC(sha2_word64x2, 2, LOAD_X2); \
+} \
+ATTR static void sha512_Transform_x4_##NAME(const sha2_word64* const* state_in, const sha2_word64* const* data, sha2_word64* const* state_out) { \
+	TRANSFORM512_VEC(sha2_word64x4, 4, LOAD_X4); \
+} \
+static const sha2_multi_backend sha2_multi_##NAME = { \
+	#NAME, \
+	sha256_Transform_x4_##NAME, sha256_Transform_x8_##NAME, \
+	sha512_Transform_x2_##NAME, sha512_Transform_x4_##NAME, \
+}
+
+SHA2_MULTI_BACKEND(generic, );
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ >= 6)
+#define SHA2_MULTI_DISPATCH 1
+SHA2_MULTI_BACKEND(avx2, __attribute__((target("avx2"))));
+SHA2_MULTI_BACKEND(avx512, __attribute__((target("avx2,avx512f,avx512vl"))));
+#endif
+
+/*
+ * Picks the backend on the first call.  Concurrent first calls are harmless,
+ * they all store the same pointer.
+ */
+static const sha2_multi_backend *sha2_multi(void) {
+	static const sha2_multi_backend *volatile backend = 0;
+	const sha2_multi_backend *b = backend;
+	if (b == 0) {
+		b = &sha2_multi_generic;
+#ifdef SHA2_MULTI_DISPATCH
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512vl")) {
+			b = &sha2_multi_avx512;
+		} else if (__builtin_cpu_supports("avx2")) {
+			b = &sha2_multi_avx2;
+		}
+#endif
+		backend = b;
+	}
+	return b;
+}
+
+const char* sha2_multi_backend_name(void) {
+	return sha2_multi()->name;
+}
+
+void sha256_Transform_x4(const sha2_word32* const state_in[4], const sha2_word32* const data[4], sha2_word32* const state_out[4]) {
+	sha2_multi()->sha256_x4(state_in, data, state_out);
+}
+
+void sha256_Transform_x8(const sha2_word32* const state_in[8], const sha2_word32* const data[8], sha2_word32* const state_out[8]) {
+	sha2_multi()->sha256_x8(state_in, data, state_out);
+}
+
+void sha512_Transform_x2(const sha2_word64* const state_in[2], const sha2_word64* const data[2], sha2_word64* const state_out[2]) {
+	sha2_multi()->sha512_x2(state_in, data, state_out);
+}
+
+void sha512_Transform_x4(const sha2_word64* const state_in[4], const sha2_word64* const data[4], sha2_word64* const state_out[4]) {
+	sha2_multi()->sha512_x4(state_in, data, state_out);
+}
+
+#else /* __GNUC__ */
+
+const char* sha2_multi_backend_name(void) {
+	return "scalar";
+}
+
+void sha256_Transform_x4(const sha2_word32* const state_in[4], const sha2_word32* const data[4], sha2_word32* const state_out[4]) {
+	for (int l = 0; l < 4; l++) {
+		sha256_Transform(state_in[l], data[l], state_out[l]);
+	}
+}
+
+void sha256_Transform_x8(const sha2_word32* const state_in[8], const sha2_word32* const data[8], sha2_word32* const state_out[8]) {
+	for (int l = 0; l < 8; l++) {
+		sha256_Transform(state_in[l], data[l], state_out[l]);
+	}
+}
+
+void sha512_Transform_x2(const sha2_word64* const state_in[2], const sha2_word64* const data[2], sha2_word64* const state_out[2]) {
+	for (int l = 0; l < 2; l++) {
+		sha512_Transform(state_in[l], data[l], state_out[l]);
+	}
+}
+
+void sha512_Transform_x4(const sha2_word64* const state_in[4], const sha2_word64* const data[4], sha2_word64* const state_out[4]) {
+	for (int l = 0; l < 4; l++) {
+		sha512_Transform(state_in[l], data[l], state_out[l]);
+	}
+}
+
+#endif /* __GNUC__ */
+
+/* Hashes LANES messages of len bytes each with one multi-buffer transform */
+static void sha256_Raw_lanes(const sha2_byte* const* data, size_t len, sha2_byte (*digests)[SHA256_DIGEST_LENGTH], int lanes) {
+	sha2_word32	state[8][8] = {0}, block[8][16] = {0};
+	const sha2_word32	*in[8] = {0}, *blk[8] = {0};
+	sha2_word32	*out[8] = {0};
+	sha2_byte	tail[2 * SHA256_BLOCK_LENGTH] = {0};
+	size_t		offset = 0, rest = 0, tail_len = 0;
+	int		i = 0, l = 0;
+
+	for (l = 0; l < lanes; l++) {
+		MEMCPY_BCOPY(state[l], sha256_initial_hash_value, SHA256_DIGEST_LENGTH);
+		in[l] = out[l] = state[l];
+		blk[l] = block[l];
+	}
+
+	/* All full blocks */
+	for (offset = 0; len - offset >= SHA256_BLOCK_LENGTH; offset += SHA256_BLOCK_LENGTH) {
+		for (l = 0; l < lanes; l++) {
+			for (i = 0; i < 16; i++) {
+				const sha2_byte *p = data[l] + offset + 4 * i;
+				block[l][i] = ((sha2_word32)p[0] << 24) | ((sha2_word32)p[1] << 16) |
+				              ((sha2_word32)p[2] << 8) | p[3];
+			}
+		}
+		if (lanes == 8) {
+			sha256_Transform_x8(in, blk, out);
+		} else {
+			sha256_Transform_x4(in, blk, out);
+		}
+	}
+
+	/* The padding, which has the same layout in all lanes */
+	rest = len - offset;
+	tail_len = (rest < SHA256_SHORT_BLOCK_LENGTH) ? SHA256_BLOCK_LENGTH : 2 * SHA256_BLOCK_LENGTH;
+	for (offset = 0; offset < tail_len; offset += SHA256_BLOCK_LENGTH) {
+		for (l = 0; l < lanes; l++) {
+			memzero(tail, sizeof(tail));
+			memcpy(tail, data[l] + len - rest, rest);
+			tail[rest] = 0x80;
+			for (i = 0; i < 8; i++) {
+				tail[tail_len - 1 - i] = (sha2_byte)(((uint64_t)len << 3) >> (8 * i));
+			}
+			for (i = 0; i < 16; i++) {
+				const sha2_byte *p = tail + offset + 4 * i;
+				block[l][i] = ((sha2_word32)p[0] << 24) | ((sha2_word32)p[1] << 16) |
+				              ((sha2_word32)p[2] << 8) | p[3];
+			}
+		}
+		if (lanes == 8) {
+			sha256_Transform_x8(in, blk, out);
+		} else {
+			sha256_Transform_x4(in, blk, out);
+		}
+	}
+
+	for (l = 0; l < lanes; l++) {
+		for (i = 0; i < 8; i++) {
+			digests[l][4 * i] = state[l][i] >> 24;
+			digests[l][4 * i + 1] = state[l][i] >> 16;
+			digests[l][4 * i + 2] = state[l][i] >> 8;
+			digests[l][4 * i + 3] = state[l][i];
+		}
+	}
+
+	/* Clean up */
+	memzero(state, sizeof(state));
+	memzero(block, sizeof(block));
+	memzero(tail, sizeof(tail));
+}
+
+void sha256_Raw_many(const sha2_byte* const data[], size_t len, size_t count, sha2_byte digests[][SHA256_DIGEST_LENGTH]) {
+	size_t	offset = 0;
+
+	for (; count - offset >= 8; offset += 8) {
+		sha256_Raw_lanes(data + offset, len, digests + offset, 8);
+	}
+	if (count - offset >= 4) {
+		sha256_Raw_lanes(data + offset, len, digests + offset, 4);
+		offset += 4;
+	}
+	for (; offset < count; offset++) {
+		sha256_Raw(data[offset], len, digests[offset]);
+	}
+}
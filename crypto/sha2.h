@@ -113,4 +113,18 @@ char* sha512_End(SHA512_CTX*, char[SHA512_DIGEST_STRING_LENGTH]);
 void sha512_Raw(const uint8_t*, size_t, uint8_t[SHA512_DIGEST_LENGTH]);
 char* sha512_Data(const uint8_t*, size_t, char[SHA512_DIGEST_STRING_LENGTH]);
 
+/*
+ * Multi-buffer API: each call compresses one block for each of 2, 4 or 8
+ * independent lanes and is equivalent to calling the single-stream transform
+ * once per lane.  state_out may alias state_in or data.
+ */
+void sha256_Transform_x4(const uint32_t* const state_in[4], const uint32_t* const data[4], uint32_t* const state_out[4]);
+void sha256_Transform_x8(const uint32_t* const state_in[8], const uint32_t* const data[8], uint32_t* const state_out[8]);
+void sha512_Transform_x2(const uint64_t* const state_in[2], const uint64_t* const data[2], uint64_t* const state_out[2]);
+void sha512_Transform_x4(const uint64_t* const state_in[4], const uint64_t* const data[4], uint64_t* const state_out[4]);
+/* Hashes count messages which all have the same length len */
+void sha256_Raw_many(const uint8_t* const data[], size_t len, size_t count, uint8_t digests[][SHA256_DIGEST_LENGTH]);
+/* Name of the multi-buffer backend selected for this CPU */
+const char* sha2_multi_backend_name(void);
+
 #endif
@@ -846,6 +846,34 @@ def test_bn_multiply(r, prime):
     assert_bn_multiply(k, x, prime)
 
 
+def test_bn_multiply_nist256p1(r):
+    prime = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+    x = r.randrange(floor(sqrt(2 ** 519)))
+    k = r.randrange(floor(sqrt(2 ** 519)))
+    assert_bn_multiply(k, x, prime)
+
+
+@pytest.mark.parametrize(
+    "prime",
+    [
+        0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F,
+        0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF,
+    ],
+)
+def test_bn_multiply_extremes(prime):
+    values = [0, 1, prime - 1, prime, prime + 1, 2 ** 256 - 1, 2 * prime - 1]
+    values.append(floor(sqrt(2 ** 519)))
+    for k in values:
+        for x in values:
+            bn_x = int_to_bignum(x)
+            lib.bn_multiply(int_to_bignum(k), bn_x, int_to_bignum(prime))
+            x_new = bignum_to_int(bn_x)
+
+            assert bignum_is_normalised(bn_x)
+            assert number_is_partly_reduced(x_new, prime)
+            assert x_new % prime == (k * x) % prime
+
+
 def test_bn_fast_mod_1(r, prime):
     assert_bn_fast_mod(r.rand_int_normalized(), prime)
 
@@ -38,6 +38,10 @@
 
 #include "options.h"
 
+#if USE_REENTRANT
+#include <pthread.h>
+#endif
+
 #include "address.h"
 #include "aes/aes.h"
 #include "base32.h"
@@ -53,6 +57,7 @@
 #include "ecdsa.h"
 #include "ed25519-donna/ed25519-donna.h"
 #include "ed25519-donna/ed25519-keccak.h"
+#include "ed25519-donna/ed25519-sha3.h"
 #include "ed25519-donna/ed25519.h"
 #include "hmac_drbg.h"
 #include "memzero.h"
@@ -948,6 +953,32 @@ START_TEST(test_bignum_sqrt) {
 }
 END_TEST
 
+START_TEST(test_bignum_inverse_batch) {
+  bignum256 x[17], y[17], scratch[17];
+  const bignum256 *prime = &secp256k1.prime;
+
+  for (int i = 0; i < 17; i++) {
+    bn_read_uint32((uint32_t)i * 1103515245 + 12345, &x[i]);
+    bn_multiply(&secp256k1.G.x, &x[i], prime);
+    bn_mod(&x[i], prime);
+    y[i] = x[i];
+  }
+  bn_inverse_batch(x, scratch, 17, prime);
+  for (int i = 0; i < 17; i++) {
+    bn_inverse(&y[i], prime);
+    ck_assert_int_eq(bn_is_equal(&x[i], &y[i]), 1);
+  }
+
+  // a single number
+  bn_read_uint32(3, &x[0]);
+  bn_inverse_batch(x, scratch, 1, prime);
+  bn_read_uint32(3, &y[0]);
+  bn_multiply(&x[0], &y[0], prime);
+  bn_mod(&y[0], prime);
+  ck_assert_int_eq(bn_is_one(&y[0]), 1);
+}
+END_TEST
+
 // https://tools.ietf.org/html/rfc4648#section-10
 START_TEST(test_base32_rfc4648) {
   static const struct {
@@ -1907,6 +1938,33 @@ START_TEST(test_bip32_optimized) {
 }
 END_TEST
 
+START_TEST(test_bip32_public_ckd_batch) {
+  HDNode root;
+  hdnode_from_seed((uint8_t *)"NothingToSeeHere", 16, SECP256K1_NAME, &root);
+  hdnode_fill_public_key(&root);
+
+  curve_point pub, expected, children[40];
+  ecdsa_read_pubkey(&secp256k1, root.public_key, &pub);
+
+  ck_assert_int_eq(hdnode_public_ckd_cp_batch(&secp256k1, &pub, root.chain_code,
+                                              5, 40, children),
+                   1);
+  for (int i = 0; i < 40; i++) {
+    hdnode_public_ckd_cp(&secp256k1, &pub, root.chain_code, 5 + i, &expected,
+                         NULL);
+    ck_assert_mem_eq(&children[i], &expected, sizeof(curve_point));
+  }
+
+  // hardened indices
+  ck_assert_int_eq(hdnode_public_ckd_cp_batch(&secp256k1, &pub, root.chain_code,
+                                              0x80000000, 1, children),
+                   0);
+  ck_assert_int_eq(hdnode_public_ckd_cp_batch(&secp256k1, &pub, root.chain_code,
+                                              0x7ffffff0, 17, children),
+                   0);
+}
+END_TEST
+
 START_TEST(test_bip32_cache_1) {
   HDNode node1, node2;
   int i, r;
@@ -2019,6 +2077,89 @@ START_TEST(test_bip32_cache_2) {
 }
 END_TEST
 
+#if USE_REENTRANT
+#define STRESS_THREADS 8
+#define STRESS_ROUNDS 6
+#define STRESS_REPEAT 3
+
+// derives a seed, a cached private path and a public child and signs with
+// them, the result depends only on id and round
+static void stress_compute(int id, int round, uint8_t result[32 + 64 + 33]) {
+  static const char *mnemonics[2] = {
+      "all all all all all all all all all all all all",
+      "legal winner thank year wave sausage worth useful legal winner thank "
+      "yellow"};
+  char passphrase[16];
+  uint8_t seed[64], digest[32], pby;
+  HDNode node;
+
+  snprintf(passphrase, sizeof(passphrase), "stress %d", id);
+  mnemonic_to_seed(mnemonics[id % 2], passphrase, seed, NULL);
+  hdnode_from_seed(seed, 64, SECP256K1_NAME, &node);
+  uint32_t path[] = {0x8000002C, 0x80000000, 0x80000000 + id, 0, round};
+  hdnode_private_ckd_cached(&node, path, 5, NULL);
+  hdnode_fill_public_key(&node);
+
+  sha256_Raw(node.public_key, 33, digest);
+  memcpy(result, seed, 32);
+  ecdsa_sign_digest(&secp256k1, node.private_key, digest, result + 32, &pby,
+                    NULL);
+  if (ecdsa_verify_digest(&secp256k1, node.public_key, result + 32, digest) !=
+      0) {
+    memset(result + 32, 0, 64);
+  }
+  hdnode_public_ckd(&node, round + 1);
+  memcpy(result + 96, node.public_key, 33);
+  memzero(&node, sizeof(node));
+}
+
+typedef struct {
+  int id;
+  int errors;
+  uint8_t (*expected)[STRESS_ROUNDS][32 + 64 + 33];
+} stress_ctx;
+
+static void *stress_worker(void *arg) {
+  stress_ctx *ctx = arg;
+  uint8_t result[32 + 64 + 33];
+  for (int r = 0; r < STRESS_REPEAT; r++) {
+    for (int round = 0; round < STRESS_ROUNDS; round++) {
+      stress_compute(ctx->id, round, result);
+      if (memcmp(result, ctx->expected[ctx->id][round], sizeof(result)) != 0) {
+        ctx->errors++;
+      }
+    }
+  }
+  return NULL;
+}
+
+// runs derivations and signatures on several threads at once and compares
+// them with the results computed by a single thread
+START_TEST(test_reentrant_stress) {
+  static uint8_t expected[STRESS_THREADS][STRESS_ROUNDS][32 + 64 + 33];
+  stress_ctx ctx[STRESS_THREADS];
+  pthread_t tids[STRESS_THREADS];
+
+  for (int id = 0; id < STRESS_THREADS; id++) {
+    for (int round = 0; round < STRESS_ROUNDS; round++) {
+      stress_compute(id, round, expected[id][round]);
+    }
+  }
+  for (int id = 0; id < STRESS_THREADS; id++) {
+    ctx[id].id = id;
+    ctx[id].errors = 0;
+    ctx[id].expected = expected;
+    ck_assert_int_eq(pthread_create(&tids[id], NULL, stress_worker, &ctx[id]),
+                     0);
+  }
+  for (int id = 0; id < STRESS_THREADS; id++) {
+    pthread_join(tids[id], NULL);
+    ck_assert_int_eq(ctx[id].errors, 0);
+  }
+}
+END_TEST
+#endif
+
 START_TEST(test_bip32_nist_seed) {
   HDNode node;
 
@@ -3521,6 +3662,87 @@ START_TEST(test_ecdsa_signature) {
 }
 END_TEST
 
+static void test_ecdsa_verify_batch_curve(const ecdsa_curve *curve) {
+#define BATCH_COUNT 21
+  uint8_t priv_keys[BATCH_COUNT][32];
+  uint8_t pub_data[BATCH_COUNT][65];
+  uint8_t sig_data[BATCH_COUNT][64];
+  uint8_t digest_data[BATCH_COUNT][32];
+  const uint8_t *pub_keys[BATCH_COUNT];
+  const uint8_t *sigs[BATCH_COUNT];
+  const uint8_t *digests[BATCH_COUNT];
+  int results[BATCH_COUNT];
+  int res, i, failed;
+
+  for (i = 0; i < BATCH_COUNT; i++) {
+    sha256_Raw((const uint8_t *)&i, sizeof(i), priv_keys[i]);
+    sha256_Raw(priv_keys[i], 32, digest_data[i]);
+    if (i % 2) {
+      ecdsa_get_public_key33(curve, priv_keys[i], pub_data[i]);
+    } else {
+      ecdsa_get_public_key65(curve, priv_keys[i], pub_data[i]);
+    }
+    res = ecdsa_sign_digest(curve, priv_keys[i], digest_data[i], sig_data[i],
+                            NULL, NULL);
+    ck_assert_int_eq(res, 0);
+    pub_keys[i] = pub_data[i];
+    sigs[i] = sig_data[i];
+    digests[i] = digest_data[i];
+  }
+
+  // all signatures are valid
+  failed = ecdsa_verify_digest_batch(curve, BATCH_COUNT, pub_keys, sigs,
+                                     digests, results);
+  ck_assert_int_eq(failed, 0);
+  for (i = 0; i < BATCH_COUNT; i++) {
+    ck_assert_int_eq(results[i], 0);
+  }
+  ck_assert_int_eq(ecdsa_verify_digest_batch(curve, BATCH_COUNT, pub_keys,
+                                             sigs, digests, NULL),
+                   0);
+
+  // invalid public key
+  pub_data[2][0] = 0x05;
+  // r = 0
+  memzero(sig_data[4], 32);
+  // s >= order
+  memset(sig_data[9] + 32, 0xff, 32);
+  // digest that reduces to zero
+  memzero(digest_data[10], 32);
+  // signatures that do not match
+  sig_data[11][63] ^= 1;
+  digest_data[12][0] ^= 1;
+  pub_keys[13] = pub_data[14];
+  sigs[20] = sig_data[19];
+
+  failed = ecdsa_verify_digest_batch(curve, BATCH_COUNT, pub_keys, sigs,
+                                     digests, results);
+  ck_assert_int_eq(failed, 8);
+  ck_assert_int_eq(results[2], 1);
+  ck_assert_int_eq(results[4], 2);
+  ck_assert_int_eq(results[9], 2);
+  ck_assert_int_eq(results[10], 3);
+  ck_assert_int_eq(results[11], 5);
+  ck_assert_int_eq(results[12], 5);
+  ck_assert_int_eq(results[13], 5);
+  ck_assert_int_eq(results[20], 5);
+  for (i = 0; i < BATCH_COUNT; i++) {
+    ck_assert_int_eq(results[i],
+                     ecdsa_verify_digest(curve, pub_keys[i], sigs[i],
+                                         digests[i]));
+  }
+#undef BATCH_COUNT
+}
+
+START_TEST(test_ecdsa_verify_batch_secp256k1) {
+  test_ecdsa_verify_batch_curve(&secp256k1);
+}
+END_TEST
+START_TEST(test_ecdsa_verify_batch_nist256p1) {
+  test_ecdsa_verify_batch_curve(&nist256p1);
+}
+END_TEST
+
 #define test_deterministic(KEY, MSG, K)           \
   do {                                            \
     sha256_Raw((uint8_t *)MSG, strlen(MSG), buf); \
@@ -4074,6 +4296,102 @@ START_TEST(test_sha512) {
 }
 END_TEST
 
+// the multi-buffer transforms must match the single-stream reference
+START_TEST(test_sha2_multi_buffer) {
+  uint32_t state256[8][8], data256[8][16], ref256[8][8];
+  uint64_t state512[4][8], data512[4][16], ref512[4][8];
+  const uint32_t *in256[8], *blk256[8];
+  uint32_t *out256[8];
+  const uint64_t *in512[4], *blk512[4];
+  uint64_t *out512[4];
+  uint32_t x = 12345;
+
+  for (int l = 0; l < 8; l++) {
+    for (int i = 0; i < 16; i++) {
+      x = x * 1103515245 + 12345;
+      data256[l][i] = x;
+      if (l < 4) data512[l][i] = ((uint64_t)x << 32) | (x * 69069);
+    }
+    for (int i = 0; i < 8; i++) {
+      state256[l][i] = sha256_initial_hash_value[i] + l;
+      if (l < 4) state512[l][i] = sha512_initial_hash_value[i] + l;
+    }
+  }
+  for (int l = 0; l < 8; l++) {
+    in256[l] = state256[l];
+    blk256[l] = data256[l];
+    out256[l] = state256[l];
+    if (l < 4) {
+      in512[l] = state512[l];
+      blk512[l] = data512[l];
+      out512[l] = state512[l];
+    }
+  }
+
+  for (int round = 0; round < 3; round++) {
+    for (int l = 0; l < 8; l++) {
+      sha256_Transform(state256[l], data256[l], ref256[l]);
+    }
+    sha256_Transform_x8(in256, blk256, out256);
+    ck_assert_mem_eq(state256, ref256, sizeof(ref256));
+
+    for (int l = 0; l < 4; l++) {
+      sha256_Transform(state256[l], data256[l], ref256[l]);
+    }
+    sha256_Transform_x4(in256, blk256, out256);
+    ck_assert_mem_eq(state256, ref256, 4 * sizeof(ref256[0]));
+
+    for (int l = 0; l < 4; l++) {
+      sha512_Transform(state512[l], data512[l], ref512[l]);
+    }
+    sha512_Transform_x4(in512, blk512, out512);
+    ck_assert_mem_eq(state512, ref512, sizeof(ref512));
+
+    for (int l = 0; l < 2; l++) {
+      sha512_Transform(state512[l], data512[l], ref512[l]);
+    }
+    sha512_Transform_x2(in512, blk512, out512);
+    ck_assert_mem_eq(state512, ref512, 2 * sizeof(ref512[0]));
+  }
+
+  // state_out aliasing data, as in PBKDF2
+  uint32_t inplace256[8][16];
+  memcpy(inplace256, data256, sizeof(inplace256));
+  for (int l = 0; l < 8; l++) {
+    sha256_Transform(state256[l], data256[l], data256[l]);
+    out256[l] = inplace256[l];
+    blk256[l] = inplace256[l];
+  }
+  sha256_Transform_x8(in256, blk256, out256);
+  for (int l = 0; l < 8; l++) {
+    ck_assert_mem_eq(inplace256[l], data256[l], 8 * sizeof(uint32_t));
+  }
+}
+END_TEST
+
+START_TEST(test_sha256_raw_many) {
+  uint8_t buf[13][200];
+  const uint8_t *data[13];
+  uint8_t digests[13][SHA256_DIGEST_LENGTH], digest[SHA256_DIGEST_LENGTH];
+
+  for (int l = 0; l < 13; l++) {
+    for (int i = 0; i < 200; i++) {
+      buf[l][i] = (uint8_t)(l * 31 + i * 7);
+    }
+    data[l] = buf[l];
+  }
+  // every length around the block and padding boundaries, with 13 messages
+  // hashed as 8 + 4 + 1
+  for (size_t len = 0; len <= 200; len++) {
+    sha256_Raw_many(data, len, 13, digests);
+    for (int l = 0; l < 13; l++) {
+      sha256_Raw(data[l], len, digest);
+      ck_assert_mem_eq(digests[l], digest, SHA256_DIGEST_LENGTH);
+    }
+  }
+}
+END_TEST
+
 // test vectors from http://www.di-mgt.com.au/sha_testvectors.html
 START_TEST(test_sha3_256) {
   uint8_t digest[SHA3_256_DIGEST_LENGTH];
@@ -4720,6 +5038,51 @@ START_TEST(test_pbkdf2_hmac_sha512) {
 }
 END_TEST
 
+START_TEST(test_pbkdf2_hmac_sha512_lanes) {
+  PBKDF2_HMAC_SHA512_CTX pctx[7];
+  char pass[7][16];
+  uint8_t k[64], expected[64];
+
+  // every count exercises a different mix of 4, 2 and 1 lane groups
+  for (size_t count = 1; count <= 7; count++) {
+    for (size_t i = 0; i < count; i++) {
+      snprintf(pass[i], sizeof(pass[i]), "password%d", (int)(i * 7 + count));
+      pbkdf2_hmac_sha512_Init(&pctx[i], (const uint8_t *)pass[i],
+                              strlen(pass[i]), (const uint8_t *)"salt", 4, 1);
+    }
+    pbkdf2_hmac_sha512_Update_lanes(pctx, count, 100);
+    pbkdf2_hmac_sha512_Update_lanes(pctx, count, 28);
+    for (size_t i = 0; i < count; i++) {
+      pbkdf2_hmac_sha512_Final(&pctx[i], k);
+      pbkdf2_hmac_sha512((const uint8_t *)pass[i], strlen(pass[i]),
+                         (const uint8_t *)"salt", 4, 128, expected, 64);
+      ck_assert_mem_eq(k, expected, 64);
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_pbkdf2_hmac_sha256_lanes) {
+  PBKDF2_HMAC_SHA256_CTX pctx[13];
+  char pass[13][16];
+  uint8_t k[32], expected[32];
+
+  // 13 contexts are run as 8 + 4 + 1 lanes
+  for (size_t i = 0; i < 13; i++) {
+    snprintf(pass[i], sizeof(pass[i]), "password%d", (int)i);
+    pbkdf2_hmac_sha256_Init(&pctx[i], (const uint8_t *)pass[i],
+                            strlen(pass[i]), (const uint8_t *)"salt", 4, 1);
+  }
+  pbkdf2_hmac_sha256_Update_lanes(pctx, 13, 1000);
+  for (size_t i = 0; i < 13; i++) {
+    pbkdf2_hmac_sha256_Final(&pctx[i], k);
+    pbkdf2_hmac_sha256((const uint8_t *)pass[i], strlen(pass[i]),
+                       (const uint8_t *)"salt", 4, 1000, expected, 32);
+    ck_assert_mem_eq(k, expected, 32);
+  }
+}
+END_TEST
+
 START_TEST(test_hmac_drbg) {
   char entropy[] =
       "06032cd5eed33f39265f49ecb142c511da9aff2af71203bffaf34a9ca5bd9c0d";
@@ -4912,6 +5275,30 @@ START_TEST(test_mnemonic) {
 }
 END_TEST
 
+START_TEST(test_mnemonic_to_seed_many) {
+  const char *mnemonics[6] = {
+      "all all all all all all all all all all all all",
+      "abandon abandon abandon abandon abandon abandon abandon abandon "
+      "abandon abandon abandon about",
+      "legal winner thank year wave sausage worth useful legal winner thank "
+      "yellow",
+      "all all all all all all all all all all all all",
+      "letter advice cage absurd amount doctor acoustic avoid letter advice "
+      "cage above",
+      "zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo wrong",
+  };
+  const char *passphrases[6] = {"", "TREZOR", "TREZOR", "testing", "", "x"};
+  uint8_t seeds[6][64], seed[64];
+
+  // 6 seeds are computed as 4 + 2 lanes
+  mnemonic_to_seed_many(mnemonics, passphrases, 6, seeds);
+  for (int i = 0; i < 6; i++) {
+    mnemonic_to_seed(mnemonics[i], passphrases[i], seed, 0);
+    ck_assert_mem_eq(seeds[i], seed, 64);
+  }
+}
+END_TEST
+
 START_TEST(test_mnemonic_check) {
   static const char *vectors_ok[] = {
       "abandon abandon abandon abandon abandon abandon abandon abandon abandon "
@@ -5973,17 +6360,24 @@ START_TEST(test_ecdsa_der) {
 }
 END_TEST
 
+#if USE_PRECOMPUTED_CP
 static void test_codepoints_curve(const ecdsa_curve *curve) {
-  int i, j;
+  int i, j, k;
   bignum256 a;
   curve_point p, p1;
-  for (i = 0; i < 64; i++) {
-    for (j = 0; j < 8; j++) {
-      bn_zero(&a);
-      a.val[(4 * i) / BN_BITS_PER_LIMB] = (uint32_t)(2 * j + 1)
-                                          << (4 * i % BN_BITS_PER_LIMB);
-      bn_normalize(&a);
-      // note that this is not a trivial test.  We add 64 curve
+  for (i = 0; i < PRECOMPUTED_CP_ROWS; i++) {
+    // wider tables are tested on the first 8 and the last entry of each row
+    for (j = 0; j < PRECOMPUTED_CP_COLS; j++) {
+      if (j >= 8 && j < PRECOMPUTED_CP_COLS - 1) {
+        continue;
+      }
+      bn_read_uint32(2 * j + 1, &a);
+      for (k = 0; k < PRECOMPUTED_CP_WINDOW * i; k++) {
+        bn_lshift(&a);
+      }
+      bn_fast_mod(&a, &curve->order);
+      bn_mod(&a, &curve->order);
+      // note that this is not a trivial test.  We add all rows of curve
       // points in the table to get that particular curve point.
       scalar_multiply(curve, &a, &p);
       ck_assert_mem_eq(&p, &curve->cp[i][j], sizeof(curve_point));
@@ -5995,7 +6389,7 @@ static void test_codepoints_curve(const ecdsa_curve *curve) {
       bn_mod(&a, &curve->order);
       p1 = curve->cp[i][j];
       point_double(curve, &p1);
-      // note that this is not a trivial test.  We add 64 curve
+      // note that this is not a trivial test.  We add all rows of curve
       // points in the table to get that particular curve point.
       scalar_multiply(curve, &a, &p);
       ck_assert_mem_eq(&p, &p1, sizeof(curve_point));
@@ -6010,6 +6404,7 @@ START_TEST(test_codepoints_secp256k1) { test_codepoints_curve(&secp256k1); }
 END_TEST
 START_TEST(test_codepoints_nist256p1) { test_codepoints_curve(&nist256p1); }
 END_TEST
+#endif
 
 static void test_mult_border_cases_curve(const ecdsa_curve *curve) {
   bignum256 a;
@@ -6164,6 +6559,80 @@ START_TEST(test_scalar_point_mult_nist256p1) {
 }
 END_TEST
 
+static void test_jacobian_to_curve_batch_curve(const ecdsa_curve *curve) {
+  jacobian_curve_point jp[10];
+  curve_point p[10], expected;
+  bignum256 k = curve->G.x;
+
+  for (int i = 0; i < 10; i++) {
+    bn_mod(&k, &curve->order);
+    scalar_multiply(curve, &k, &expected);
+    curve_to_jacobian(&expected, &jp[i], &curve->prime);
+    k = expected.y;
+  }
+  // the point at infinity
+  bn_zero(&jp[3].z);
+
+  jacobian_to_curve_batch(jp, p, 10, &curve->prime);
+  for (int i = 0; i < 10; i++) {
+    if (i == 3) {
+      ck_assert_int_eq(point_is_infinity(&p[i]), 1);
+      continue;
+    }
+    jacobian_to_curve(&jp[i], &expected, &curve->prime);
+    ck_assert_mem_eq(&p[i], &expected, sizeof(curve_point));
+  }
+}
+
+START_TEST(test_jacobian_to_curve_batch_secp256k1) {
+  test_jacobian_to_curve_batch_curve(&secp256k1);
+}
+END_TEST
+START_TEST(test_jacobian_to_curve_batch_nist256p1) {
+  test_jacobian_to_curve_batch_curve(&nist256p1);
+}
+END_TEST
+
+static void test_scalar_multiply_add_batch_curve(const ecdsa_curve *curve) {
+  bignum256 k[20];
+  curve_point p = curve->G, res[20], expected;
+
+  point_double(curve, &p);
+  for (int i = 0; i < 20; i++) {
+    bn_read_uint32((uint32_t)i * 1103515245 + 12345, &k[i]);
+    bn_multiply(&curve->G.y, &k[i], &curve->order);
+    bn_mod(&k[i], &curve->order);
+  }
+  // 0 * G + p = p
+  bn_zero(&k[7]);
+  // 1 * G + p, p = -G
+  bn_one(&k[8]);
+
+  scalar_multiply_add_batch(curve, k, &p, res, 20);
+  for (int i = 0; i < 20; i++) {
+    if (i == 8) {
+      continue;
+    }
+    scalar_multiply(curve, &k[i], &expected);
+    point_add(curve, &p, &expected);
+    ck_assert_mem_eq(&res[i], &expected, sizeof(curve_point));
+  }
+
+  p = curve->G;
+  bn_subtract(&curve->prime, &p.y, &p.y);
+  scalar_multiply_add_batch(curve, &k[8], &p, res, 1);
+  ck_assert_int_eq(point_is_infinity(&res[0]), 1);
+}
+
+START_TEST(test_scalar_multiply_add_batch_secp256k1) {
+  test_scalar_multiply_add_batch_curve(&secp256k1);
+}
+END_TEST
+START_TEST(test_scalar_multiply_add_batch_nist256p1) {
+  test_scalar_multiply_add_batch_curve(&nist256p1);
+}
+END_TEST
+
 START_TEST(test_ed25519) {
   // test vectors from
   // https://github.com/torproject/tor/blob/master/src/test/ed25519_vectors.inc
@@ -6256,6 +6725,137 @@ START_TEST(test_ed25519) {
 }
 END_TEST
 
+START_TEST(test_ed25519_batch) {
+#define BATCH_COUNT 100
+  static ed25519_public_key pks[BATCH_COUNT];
+  static ed25519_signature sigs[BATCH_COUNT];
+  static uint8_t msgs[BATCH_COUNT][32];
+  const unsigned char *m[BATCH_COUNT], *pk[BATCH_COUNT], *RS[BATCH_COUNT];
+  size_t mlen[BATCH_COUNT];
+  int valid[BATCH_COUNT];
+  ed25519_secret_key sk;
+
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    memset(sk, i + 1, sizeof(sk));
+    memset(msgs[i], i, sizeof(msgs[i]));
+    ed25519_publickey(sk, pks[i]);
+    ed25519_sign(msgs[i], i % 33, sk, pks[i], sigs[i]);
+    m[i] = msgs[i];
+    mlen[i] = i % 33;
+    pk[i] = pks[i];
+    RS[i] = sigs[i];
+  }
+  ck_assert_int_eq(ed25519_sign_open_batch(m, mlen, pk, RS, BATCH_COUNT, valid),
+                   0);
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    ck_assert_int_eq(valid[i], 1);
+  }
+
+  // a wrong message, S, R and public key, S not reduced and R not canonical
+  msgs[3][0] ^= 1;
+  mlen[3] = 32;
+  sigs[10][40] ^= 1;
+  sigs[20][5] ^= 1;
+  pks[30][0] ^= 1;
+  memset(sigs[70] + 32, 0xff, 31);
+  sigs[70][63] = 0x1f;
+  memset(sigs[90], 0xff, 31);
+  sigs[90][31] = 0x7f;
+  ck_assert_int_eq(ed25519_sign_open_batch(m, mlen, pk, RS, BATCH_COUNT, valid),
+                   -1);
+  for (int i = 0; i < BATCH_COUNT; i++) {
+    ck_assert_int_eq(valid[i],
+                     ed25519_sign_open(m[i], mlen[i], pk[i], RS[i]) == 0);
+  }
+  ck_assert_int_eq(valid[3] | valid[10] | valid[20] | valid[30] | valid[70] |
+                       valid[90],
+                   0);
+
+  // a batch of one and an empty batch
+  ck_assert_int_eq(ed25519_sign_open_batch(m, mlen, pk, RS, 1, valid), 0);
+  ck_assert_int_eq(valid[0], 1);
+  ck_assert_int_eq(ed25519_sign_open_batch(m, mlen, pk, RS, 0, valid), 0);
+
+  // the variants with other hash functions
+  for (int i = 0; i < 8; i++) {
+    memset(sk, i + 1, sizeof(sk));
+    ed25519_publickey_keccak(sk, pks[i]);
+    ed25519_sign_keccak(msgs[i], mlen[i], sk, pks[i], sigs[i]);
+  }
+  ck_assert_int_eq(ed25519_sign_open_batch_keccak(m, mlen, pk, RS, 8, valid),
+                   0);
+  sigs[5][50] ^= 1;
+  ck_assert_int_eq(ed25519_sign_open_batch_keccak(m, mlen, pk, RS, 8, valid),
+                   -1);
+  ck_assert_int_eq(valid[5], 0);
+  ck_assert_int_eq(valid[4], 1);
+  for (int i = 0; i < 8; i++) {
+    memset(sk, i + 1, sizeof(sk));
+    ed25519_publickey_sha3(sk, pks[i]);
+    ed25519_sign_sha3(msgs[i], mlen[i], sk, pks[i], sigs[i]);
+  }
+  ck_assert_int_eq(ed25519_sign_open_batch_sha3(m, mlen, pk, RS, 8, valid), 0);
+
+  // A public key with an order 2 component. The signature fails
+  // ed25519_sign_open because H(R,A,m) is odd, but satisfies the cofactored
+  // equation, so it must pass every batch, including the one by one checks
+  // after a batch with an invalid signature fails.
+  static const uint8_t torsion[32] = {
+      0xec, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f};
+  bignum256modm a, r, h, s;
+  ge25519 A, R, T;
+  uint8_t hash[64];
+  SHA512_CTX ctx;
+
+  for (int i = 1; i < 8; i++) {
+    memset(sk, i + 1, sizeof(sk));
+    ed25519_publickey(sk, pks[i]);
+    ed25519_sign(msgs[i], mlen[i], sk, pks[i], sigs[i]);
+  }
+  memset(hash, 7, 32);
+  expand256_modm(a, hash, 32);
+  memset(hash, 9, 32);
+  expand256_modm(r, hash, 32);
+  ge25519_scalarmult_base_wrapper(&A, a);
+  ck_assert_int_eq(ge25519_unpack_vartime(&T, torsion), 1);
+  ge25519_add(&A, &A, &T, 0);
+  ge25519_pack(pks[0], &A);
+  ge25519_scalarmult_base_wrapper(&R, r);
+  ge25519_pack(sigs[0], &R);
+  mlen[0] = 32;
+  for (msgs[0][0] = 0;; msgs[0][0]++) {
+    sha512_Init(&ctx);
+    sha512_Update(&ctx, sigs[0], 32);
+    sha512_Update(&ctx, pks[0], 32);
+    sha512_Update(&ctx, msgs[0], 32);
+    sha512_Final(&ctx, hash);
+    expand256_modm(h, hash, 64);
+    contract256_modm(hash, h);
+    if (hash[0] & 1) {
+      break;
+    }
+  }
+  mul256_modm(s, h, a);
+  add256_modm(s, s, r);
+  contract256_modm(sigs[0] + 32, s);
+  ck_assert_int_eq(ed25519_sign_open(m[0], mlen[0], pk[0], RS[0]), -1);
+
+  for (int i = 0; i < 32; i++) {
+    ck_assert_int_eq(ed25519_sign_open_batch(m, mlen, pk, RS, 8, valid), 0);
+    ck_assert_int_eq(valid[0], 1);
+  }
+  sigs[5][50] ^= 1;
+  for (int i = 0; i < 32; i++) {
+    ck_assert_int_eq(ed25519_sign_open_batch(m, mlen, pk, RS, 8, valid), -1);
+    ck_assert_int_eq(valid[0], 1);
+    ck_assert_int_eq(valid[5], 0);
+  }
+#undef BATCH_COUNT
+}
+END_TEST
+
 // test vectors from
 // https://raw.githubusercontent.com/NemProject/nem-test-vectors/master/2.test-sign.dat
 START_TEST(test_ed25519_keccak) {
@@ -8748,6 +9348,7 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_bignum_format);
   tcase_add_test(tc, test_bignum_format_uint64);
   tcase_add_test(tc, test_bignum_sqrt);
+  tcase_add_test(tc, test_bignum_inverse_batch);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("base32");
@@ -8774,10 +9375,17 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_bip32_vector_3);
   tcase_add_test(tc, test_bip32_compare);
   tcase_add_test(tc, test_bip32_optimized);
+  tcase_add_test(tc, test_bip32_public_ckd_batch);
   tcase_add_test(tc, test_bip32_cache_1);
   tcase_add_test(tc, test_bip32_cache_2);
   suite_add_tcase(s, tc);
 
+#if USE_REENTRANT
+  tc = tcase_create("reentrant");
+  tcase_add_test(tc, test_reentrant_stress);
+  suite_add_tcase(s, tc);
+#endif
+
   tc = tcase_create("bip32-nist");
   tcase_add_test(tc, test_bip32_nist_seed);
   tcase_add_test(tc, test_bip32_nist_vector_1);
@@ -8804,6 +9412,8 @@ Suite *test_suite(void) {
 
   tc = tcase_create("ecdsa");
   tcase_add_test(tc, test_ecdsa_signature);
+  tcase_add_test(tc, test_ecdsa_verify_batch_secp256k1);
+  tcase_add_test(tc, test_ecdsa_verify_batch_nist256p1);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("rfc6979");
@@ -8842,6 +9452,8 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_sha1);
   tcase_add_test(tc, test_sha256);
   tcase_add_test(tc, test_sha512);
+  tcase_add_test(tc, test_sha2_multi_buffer);
+  tcase_add_test(tc, test_sha256_raw_many);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("sha3");
@@ -8866,6 +9478,8 @@ Suite *test_suite(void) {
   tc = tcase_create("pbkdf2");
   tcase_add_test(tc, test_pbkdf2_hmac_sha256);
   tcase_add_test(tc, test_pbkdf2_hmac_sha512);
+  tcase_add_test(tc, test_pbkdf2_hmac_sha512_lanes);
+  tcase_add_test(tc, test_pbkdf2_hmac_sha256_lanes);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("hmac_drbg");
@@ -8874,6 +9488,7 @@ Suite *test_suite(void) {
 
   tc = tcase_create("bip39");
   tcase_add_test(tc, test_mnemonic);
+  tcase_add_test(tc, test_mnemonic_to_seed_many);
   tcase_add_test(tc, test_mnemonic_check);
   tcase_add_test(tc, test_mnemonic_to_entropy);
   tcase_add_test(tc, test_mnemonic_find_word);
@@ -8898,10 +9513,12 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_pubkey_uncompress);
   suite_add_tcase(s, tc);
 
+#if USE_PRECOMPUTED_CP
   tc = tcase_create("codepoints");
   tcase_add_test(tc, test_codepoints_secp256k1);
   tcase_add_test(tc, test_codepoints_nist256p1);
   suite_add_tcase(s, tc);
+#endif
 
   tc = tcase_create("mult_border_cases");
   tcase_add_test(tc, test_mult_border_cases_secp256k1);
@@ -8923,8 +9540,16 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_scalar_point_mult_nist256p1);
   suite_add_tcase(s, tc);
 
+  tc = tcase_create("point_batch");
+  tcase_add_test(tc, test_jacobian_to_curve_batch_secp256k1);
+  tcase_add_test(tc, test_jacobian_to_curve_batch_nist256p1);
+  tcase_add_test(tc, test_scalar_multiply_add_batch_secp256k1);
+  tcase_add_test(tc, test_scalar_multiply_add_batch_nist256p1);
+  suite_add_tcase(s, tc);
+
   tc = tcase_create("ed25519");
   tcase_add_test(tc, test_ed25519);
+  tcase_add_test(tc, test_ed25519_batch);
   suite_add_tcase(s, tc);
 
   tc = tcase_create("ed25519_keccak");
@@ -9043,6 +9668,8 @@ Suite *test_suite(void) {
   tcase_add_test(tc, test_xmr_derive_public_key);
   tcase_add_test(tc, test_xmr_add_keys2);
   tcase_add_test(tc, test_xmr_add_keys3);
+  tcase_add_test(tc, test_xmr_multiexp);
+  tcase_add_test(tc, test_xmr_vec);
   tcase_add_test(tc, test_xmr_get_subaddress_secret_key);
   tcase_add_test(tc, test_xmr_gen_c);
   tcase_add_test(tc, test_xmr_varint);
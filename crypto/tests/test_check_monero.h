@@ -988,6 +988,178 @@ START_TEST(test_xmr_add_keys3) {
 }
 END_TEST
 
+START_TEST(test_xmr_multiexp) {
+  static const size_t sizes[] = {0, 1, 3, 4, 5, 63, 64, 130, 300};
+  static xmr_key_t scalars[300], points[300];
+  bignum256modm s;
+  ge25519 P, sP, res, res_exp;
+
+  for (size_t i = 0; i < 300; i++) {
+    xmr_random_scalar(s);
+    contract256_modm(scalars[i], s);
+    xmr_random_scalar(s);
+    ge25519_scalarmult_base_wrapper(&P, s);
+    ge25519_pack(points[i], &P);
+  }
+  // the largest scalar and a zero one
+  memcpy(scalars[0],
+         fromhex(
+             "ecd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010"),
+         32);
+  memset(scalars[2], 0, 32);
+
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(*sizes); k++) {
+    ge25519_set_neutral(&res_exp);
+    for (size_t i = 0; i < sizes[k]; i++) {
+      expand256_modm(s, scalars[i], 32);
+      ge25519_unpack_vartime(&P, points[i]);
+      ge25519_scalarmult(&sP, &P, s);
+      ge25519_add(&res_exp, &res_exp, &sP, 0);
+    }
+    ck_assert_int_eq(xmr_multiexp_vartime(&res, scalars, points, sizes[k]), 1);
+    ck_assert_int_eq(ge25519_eq(&res, &res_exp), 1);
+    ck_assert_int_eq(xmr_multiexp(&res, scalars, points, sizes[k]), 1);
+    ck_assert_int_eq(ge25519_eq(&res, &res_exp), 1);
+  }
+
+  // y = 2 is not on the curve
+  memset(points[100], 0, 32);
+  points[100][0] = 2;
+  ck_assert_int_eq(xmr_multiexp_vartime(&res, scalars, points, 300), 0);
+  ck_assert_int_eq(xmr_multiexp_vartime(&res, scalars + 99, points + 99, 2),
+                   0);
+  ck_assert_int_eq(xmr_multiexp(&res, scalars, points, 300), 0);
+  ck_assert_int_eq(xmr_multiexp(&res, scalars + 99, points + 99, 2), 0);
+}
+END_TEST
+
+START_TEST(test_xmr_vec) {
+#define VEC_LEN 5
+  xmr_key_t a[VEC_LEN], b[VEC_LEN], c[VEC_LEN], P[VEC_LEN], Q[VEC_LEN];
+  xmr_key_t r[VEC_LEN], exp;
+  bignum256modm x, y, z, s, t, ip;
+  ge25519 A, B, R;
+  uint8_t buf[8 + 4] = {0}, data[8 + 4] = {0};
+
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    xmr_random_scalar(x);
+    contract256_modm(a[i], x);
+    xmr_random_scalar(x);
+    contract256_modm(b[i], x);
+    xmr_random_scalar(x);
+    contract256_modm(c[i], x);
+    xmr_random_scalar(x);
+    ge25519_scalarmult_base_wrapper(&A, x);
+    ge25519_pack(P[i], &A);
+    xmr_random_scalar(x);
+    ge25519_scalarmult_base_wrapper(&A, x);
+    ge25519_pack(Q[i], &A);
+  }
+  xmr_random_scalar(s);
+  xmr_random_scalar(t);
+
+  xmr_sc_inner_product(ip, a, b, VEC_LEN);
+  set256_modm(z, 0);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    expand256_modm(y, b[i], 32);
+    muladd256_modm(z, x, y, z);
+  }
+  ck_assert_int_eq(eq256_modm(ip, z), 1);
+
+  xmr_sc_add_vec(r, a, b, VEC_LEN);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    expand256_modm(y, b[i], 32);
+    add256_modm(x, x, y);
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+
+  xmr_sc_sub_vec(r, a, b, VEC_LEN);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    expand256_modm(y, b[i], 32);
+    sub256_modm(x, x, y);
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+
+  xmr_sc_mul_vec(r, a, b, VEC_LEN);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    expand256_modm(y, b[i], 32);
+    mul256_modm(x, x, y);
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+
+  xmr_sc_muladd_vec(r, a, b, c, VEC_LEN);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    expand256_modm(y, b[i], 32);
+    expand256_modm(z, c[i], 32);
+    muladd256_modm(x, x, y, z);
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+
+  memcpy(r, a, sizeof(r));
+  xmr_sc_fold_vec(r, r, s, b, t, VEC_LEN);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    expand256_modm(y, b[i], 32);
+    mul256_modm(x, x, s);
+    mul256_modm(y, y, t);
+    add256_modm(x, x, y);
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+  xmr_sc_fold_vec(r, a, s, NULL, t, VEC_LEN);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    expand256_modm(x, a[i], 32);
+    mul256_modm(x, x, s);
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+
+  ck_assert_int_eq(xmr_ge25519_fold_vec(r, P, s, Q, t, VEC_LEN), 1);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    ge25519_unpack_vartime(&A, P[i]);
+    ge25519_unpack_vartime(&B, Q[i]);
+    xmr_add_keys3(&R, s, &A, t, &B);
+    ge25519_pack(exp, &R);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+  ck_assert_int_eq(xmr_ge25519_fold_vec(r, P, s, NULL, t, VEC_LEN), 1);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    ge25519_unpack_vartime(&A, P[i]);
+    ge25519_scalarmult(&R, &A, s);
+    ge25519_pack(exp, &R);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+  // y = 2 is not on the curve
+  memset(Q[3], 0, 32);
+  Q[3][0] = 2;
+  ck_assert_int_eq(xmr_ge25519_fold_vec(r, P, s, Q, t, VEC_LEN), 0);
+
+  memcpy(buf, "prefix!!", 8);
+  ck_assert_int_eq(xmr_hash_to_scalar_range(r, buf, sizeof(buf), 8, 126,
+                                            VEC_LEN),
+                   1);
+  for (size_t i = 0; i < VEC_LEN; i++) {
+    memset(data, 0, sizeof(data));
+    memcpy(data, "prefix!!", 8);
+    xmr_write_varint(data + 8, 4, 126 + i);
+    xmr_hash_to_scalar(x, data, sizeof(data));
+    contract256_modm(exp, x);
+    ck_assert_mem_eq(r[i], exp, 32);
+  }
+  ck_assert_int_eq(xmr_hash_to_scalar_range(r, buf, 9, 8, 126, VEC_LEN), 0);
+#undef VEC_LEN
+}
+END_TEST
+
 START_TEST(test_xmr_get_subaddress_secret_key) {
   static const struct {
     uint32_t major, minor;
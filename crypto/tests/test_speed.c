@@ -3,14 +3,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "bip32.h"
 #include "curves.h"
 #include "ecdsa.h"
 #include "ed25519-donna/ed25519.h"
 #include "hasher.h"
 #include "nist256p1.h"
+#include "options.h"
 #include "secp256k1.h"
 
+#if USE_REENTRANT
+#include <pthread.h>
+#endif
+
 static uint8_t msg[256];
 
 void prepare_msg(void) {
@@ -133,6 +139,43 @@ void bench_verify_nist256p1_65(int iterations) {
   }
 }
 
+#define VERIFY_BATCH_SIZE 64
+
+static void bench_verify_batch(const ecdsa_curve *curve, int iterations) {
+  static uint8_t sig[VERIFY_BATCH_SIZE][64], pub[VERIFY_BATCH_SIZE][33],
+      digest[VERIFY_BATCH_SIZE][32];
+  const uint8_t *sigs[VERIFY_BATCH_SIZE], *pubs[VERIFY_BATCH_SIZE],
+      *digests[VERIFY_BATCH_SIZE];
+  uint8_t priv[32];
+
+  memcpy(priv,
+         "\xc5\x5e\xce\x85\x8b\x0d\xdd\x52\x63\xf9\x68\x10\xfe\x14\x43\x7c\xd3"
+         "\xb5\xe1\xfb\xd7\xc6\xa2\xec\x1e\x03\x1f\x05\xe8\x6d\x8b\xd5",
+         32);
+  for (int i = 0; i < VERIFY_BATCH_SIZE; i++) {
+    priv[0] = i;
+    hasher_Raw(HASHER_SHA2, msg, sizeof(msg) - i, digest[i]);
+    ecdsa_get_public_key33(curve, priv, pub[i]);
+    ecdsa_sign_digest(curve, priv, digest[i], sig[i], NULL, NULL);
+    sigs[i] = sig[i];
+    pubs[i] = pub[i];
+    digests[i] = digest[i];
+  }
+
+  for (int i = 0; i < iterations; i += VERIFY_BATCH_SIZE) {
+    ecdsa_verify_digest_batch(curve, VERIFY_BATCH_SIZE, pubs, sigs, digests,
+                              NULL);
+  }
+}
+
+void bench_verify_batch_secp256k1_33(int iterations) {
+  bench_verify_batch(&secp256k1, iterations);
+}
+
+void bench_verify_batch_nist256p1_33(int iterations) {
+  bench_verify_batch(&nist256p1, iterations);
+}
+
 void bench_verify_ed25519(int iterations) {
   ed25519_public_key pk;
   ed25519_secret_key sk;
@@ -150,6 +193,30 @@ void bench_verify_ed25519(int iterations) {
   }
 }
 
+void bench_verify_batch_ed25519(int iterations) {
+  static ed25519_public_key pks[VERIFY_BATCH_SIZE];
+  static ed25519_signature sigs[VERIFY_BATCH_SIZE];
+  const unsigned char *m[VERIFY_BATCH_SIZE], *pk[VERIFY_BATCH_SIZE],
+      *RS[VERIFY_BATCH_SIZE];
+  size_t mlen[VERIFY_BATCH_SIZE];
+  int valid[VERIFY_BATCH_SIZE];
+  ed25519_secret_key sk;
+
+  for (int i = 0; i < VERIFY_BATCH_SIZE; i++) {
+    memset(sk, i + 1, sizeof(sk));
+    ed25519_publickey(sk, pks[i]);
+    ed25519_sign(msg, sizeof(msg), sk, pks[i], sigs[i]);
+    m[i] = msg;
+    mlen[i] = sizeof(msg);
+    pk[i] = pks[i];
+    RS[i] = sigs[i];
+  }
+
+  for (int i = 0; i < iterations; i += VERIFY_BATCH_SIZE) {
+    ed25519_sign_open_batch(m, mlen, pk, RS, VERIFY_BATCH_SIZE, valid);
+  }
+}
+
 void bench_multiply_curve25519(int iterations) {
   uint8_t result[32];
   uint8_t secret[32];
@@ -199,6 +266,22 @@ void bench_ckd_optimized(int iterations) {
   }
 }
 
+void bench_ckd_batch(int iterations) {
+  char addr[MAX_ADDR_SIZE];
+  uint8_t child_pubkey[33];
+  curve_point pub, children[100];
+  ecdsa_read_pubkey(&secp256k1, root.public_key, &pub);
+  for (int i = 0; i < iterations; i += 100) {
+    hdnode_public_ckd_cp_batch(&secp256k1, &pub, root.chain_code, i, 100,
+                               children);
+    for (int j = 0; j < 100; j++) {
+      compress_coords(&children[j], child_pubkey);
+      ecdsa_get_address(child_pubkey, 0, HASHER_SHA2_RIPEMD, HASHER_SHA2D,
+                        addr, sizeof(addr));
+    }
+  }
+}
+
 void bench(void (*func)(int), const char *name, int iterations) {
   clock_t t = clock();
   func(iterations);
@@ -208,19 +291,70 @@ void bench(void (*func)(int), const char *name, int iterations) {
 
 #define BENCH(FUNC, ITER) bench(FUNC, #FUNC, ITER)
 
+#if USE_REENTRANT
+typedef struct {
+  void (*func)(int);
+  int iterations;
+} bench_job;
+
+static void *bench_thread(void *arg) {
+  bench_job *job = arg;
+  job->func(job->iterations);
+  return NULL;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// runs func with the given iterations on every thread at once, doubling the
+// number of threads up to the number of cores
+void bench_threads(void (*func)(int), const char *name, int iterations) {
+  int cores = sysconf(_SC_NPROCESSORS_ONLN);
+  bench_job job = {func, iterations};
+  pthread_t tids[256];
+  float base = 0;
+
+  if (cores > 256) cores = 256;
+  for (int threads = 1;; threads *= 2) {
+    if (threads > cores) threads = cores;
+    double t = now();
+    for (int i = 0; i < threads; i++) {
+      pthread_create(&tids[i], NULL, bench_thread, &job);
+    }
+    for (int i = 0; i < threads; i++) {
+      pthread_join(tids[i], NULL);
+    }
+    float speed = iterations * threads / (now() - t);
+    if (threads == 1) base = speed;
+    printf("%25s: %8.2f ops/s on %3d threads, %5.2fx\n", name, speed, threads,
+           speed / base);
+    if (threads == cores) break;
+  }
+}
+
+#define BENCH_THREADS(FUNC, ITER) bench_threads(FUNC, #FUNC, ITER)
+#endif
+
 int main(void) {
+  printf("bignum backend: %s\n", USE_BN_64 ? "64-bit" : "29-bit");
   prepare_msg();
 
   BENCH(bench_sign_secp256k1, 500);
   BENCH(bench_verify_secp256k1_33, 500);
   BENCH(bench_verify_secp256k1_65, 500);
+  BENCH(bench_verify_batch_secp256k1_33, 512);
 
   BENCH(bench_sign_nist256p1, 500);
   BENCH(bench_verify_nist256p1_33, 500);
   BENCH(bench_verify_nist256p1_65, 500);
+  BENCH(bench_verify_batch_nist256p1_33, 512);
 
   BENCH(bench_sign_ed25519, 4000);
   BENCH(bench_verify_ed25519, 4000);
+  BENCH(bench_verify_batch_ed25519, 4096);
 
   BENCH(bench_multiply_curve25519, 4000);
 
@@ -228,6 +362,13 @@ int main(void) {
 
   BENCH(bench_ckd_normal, 1000);
   BENCH(bench_ckd_optimized, 1000);
+  BENCH(bench_ckd_batch, 1000);
+
+#if USE_REENTRANT
+  BENCH_THREADS(bench_sign_secp256k1, 200);
+  BENCH_THREADS(bench_verify_secp256k1_33, 200);
+  BENCH_THREADS(bench_ckd_normal, 200);
+#endif
 
   return 0;
 }
@@ -1,22 +1,27 @@
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 #include "bip32.h"
 #include "bip39.h"
 #include "curves.h"
 #include "ecdsa.h"
+#include "memzero.h"
+#include "pbkdf2.h"
 #include "secp256k1.h"
 
-char iter[256];
-uint8_t seed[512 / 8];
-char addr[MAX_ADDR_SIZE];
-int count = 0, found = 0;
-HDNode node;
-clock_t start;
-
 #define ACCOUNT_LEGACY 0
 
-// around 280 tries per second
+// number of candidates a worker takes from the input at once
+#define BATCH_SIZE 32
+#define MAX_THREADS 256
+#define MAX_LANES 8
+#define MAX_LINE 256
+
+// around 280 tries per second per core with a single lane
 
 // testing data:
 //
@@ -30,15 +35,227 @@ clock_t start;
 //             segwit: "3NcXPfbDP4UHSbuHASALJEBtDeAcWYMMcS"
 // passphrase: "testing"
 
+typedef struct {
+  char lines[BATCH_SIZE][MAX_LINE];
+  int count;
+  unsigned long seq;
+} batch;
+
+static const char *address, *mnemonic;
+static int lanes = 4;
+
+// protects the input and the bookkeeping below, the library itself is built
+// reentrant and needs no locking
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long next_seq, completed_seq, tried, completed_lines;
+static int batch_done[2 * MAX_THREADS];
+static int batch_count[2 * MAX_THREADS];
+static int found, input_finished, active_workers;
+static char found_item[MAX_LINE];
+static long input_size, input_read;
+
+// reads the next batch of candidates, returns 0 at the end of the input
+static int read_batch(batch *b) {
+  b->count = 0;
+  if (found || input_finished) {
+    return 0;
+  }
+  while (b->count < BATCH_SIZE) {
+    char *line = b->lines[b->count];
+    if (fgets(line, MAX_LINE, stdin) == NULL) {
+      input_finished = 1;
+      break;
+    }
+    int len = strlen(line);
+    input_read += len;
+    if (len > 0 && line[len - 1] == '\n') {
+      line[len - 1] = 0;
+    }
+    b->count++;
+  }
+  b->seq = next_seq++;
+  return b->count > 0;
+}
+
+// marks a batch as done and advances the checkpoint past all batches that
+// have been completed without a gap
+static void complete_batch(const batch *b) {
+  batch_done[b->seq % (2 * MAX_THREADS)] = 1;
+  batch_count[b->seq % (2 * MAX_THREADS)] = b->count;
+  while (batch_done[completed_seq % (2 * MAX_THREADS)]) {
+    batch_done[completed_seq % (2 * MAX_THREADS)] = 0;
+    completed_lines += batch_count[completed_seq % (2 * MAX_THREADS)];
+    completed_seq++;
+  }
+}
+
+static void derive_address(const uint8_t *seed, char *addr, int addrsize) {
+  HDNode node;
+  hdnode_from_seed(seed, 512 / 8, SECP256K1_NAME, &node);
+#if ACCOUNT_LEGACY
+  hdnode_private_ckd_prime(&node, 44);
+#else
+  hdnode_private_ckd_prime(&node, 49);
+#endif
+  hdnode_private_ckd_prime(&node, 0);
+  hdnode_private_ckd_prime(&node, 0);
+  hdnode_private_ckd(&node, 0);
+  hdnode_private_ckd(&node, 0);
+  hdnode_fill_public_key(&node);
+#if ACCOUNT_LEGACY
+  // Legacy address
+  ecdsa_get_address(node.public_key, 0, HASHER_SHA2_RIPEMD, HASHER_SHA2D,
+                    addr, addrsize);
+#else
+  // Segwit-in-P2SH
+  ecdsa_get_address_segwit_p2sh(node.public_key, 5, HASHER_SHA2_RIPEMD,
+                                HASHER_SHA2D, addr, addrsize);
+#endif
+  memzero(&node, sizeof(node));
+}
+
+// tries up to MAX_LANES candidates at once, the PBKDF2 rounds of all of them
+// run interleaved in pbkdf2_hmac_sha512_Update_lanes
+static void try_lanes(char lines[][MAX_LINE], int count) {
+  PBKDF2_HMAC_SHA512_CTX pctx[MAX_LANES];
+  uint8_t salt[8 + MAX_LINE];
+  uint8_t seed[512 / 8];
+  char addr[MAX_ADDR_SIZE];
+
+  memcpy(salt, "mnemonic", 8);
+  for (int i = 0; i < count; i++) {
+    const char *m = mnemonic ? mnemonic : lines[i];
+    const char *passphrase = mnemonic ? lines[i] : "";
+    int passphraselen = strlen(passphrase);
+    memcpy(salt + 8, passphrase, passphraselen);
+    pbkdf2_hmac_sha512_Init(&pctx[i], (const uint8_t *)m, strlen(m), salt,
+                            passphraselen + 8, 1);
+  }
+
+  pbkdf2_hmac_sha512_Update_lanes(pctx, count, BIP39_PBKDF2_ROUNDS);
+
+  for (int i = 0; i < count; i++) {
+    pbkdf2_hmac_sha512_Final(&pctx[i], seed);
+    derive_address(seed, addr, sizeof(addr));
+    if (strcmp(address, addr) == 0) {
+      pthread_mutex_lock(&lock);
+      found = 1;
+      strcpy(found_item, lines[i]);
+      pthread_mutex_unlock(&lock);
+    }
+  }
+  memzero(salt, sizeof(salt));
+  memzero(seed, sizeof(seed));
+}
+
+static void *worker(void *arg) {
+  batch *b = arg;
+  for (;;) {
+    pthread_mutex_lock(&lock);
+    int r = read_batch(b);
+    pthread_mutex_unlock(&lock);
+    if (!r) {
+      break;
+    }
+    int i = 0;
+    while (i < b->count && !found) {
+      int n = b->count - i < lanes ? b->count - i : lanes;
+      try_lanes(&b->lines[i], n);
+      i += n;
+    }
+    pthread_mutex_lock(&lock);
+    tried += i;
+    if (i == b->count) {
+      // a batch interrupted by a match is never checkpointed
+      complete_batch(b);
+    }
+    pthread_mutex_unlock(&lock);
+  }
+  pthread_mutex_lock(&lock);
+  active_workers--;
+  pthread_mutex_unlock(&lock);
+  return NULL;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// stores the number of input lines that have been tried completely
+static void write_checkpoint(const char *path, unsigned long lines) {
+  char tmp[1024];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  FILE *f = fopen(tmp, "w");
+  if (!f) {
+    perror(tmp);
+    return;
+  }
+  fprintf(f, "%lu\n", lines);
+  fclose(f);
+  rename(tmp, path);
+}
+
+static unsigned long read_checkpoint(const char *path) {
+  unsigned long lines = 0;
+  FILE *f = fopen(path, "r");
+  if (f) {
+    if (fscanf(f, "%lu", &lines) != 1) {
+      lines = 0;
+    }
+    fclose(f);
+  }
+  return lines;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+          "Usage: bip39bruteforce [-t threads] [-l lanes] [-c checkpoint] "
+          "[-p seconds] address [mnemonic]\n");
+}
+
 int main(int argc, char **argv) {
-  if (argc != 2 && argc != 3) {
-    fprintf(stderr, "Usage: bip39bruteforce address [mnemonic]\n");
+  int threads = sysconf(_SC_NPROCESSORS_ONLN), opt;
+  double interval = 10;
+  const char *checkpoint = NULL;
+  unsigned long skip = 0;
+  static batch batches[MAX_THREADS];
+  pthread_t tids[MAX_THREADS];
+
+  while ((opt = getopt(argc, argv, "t:l:c:p:")) != -1) {
+    switch (opt) {
+      case 't':
+        threads = atoi(optarg);
+        break;
+      case 'l':
+        lanes = atoi(optarg);
+        break;
+      case 'c':
+        checkpoint = optarg;
+        break;
+      case 'p':
+        interval = atof(optarg);
+        break;
+      default:
+        usage();
+        return 1;
+    }
+  }
+  if (argc - optind != 1 && argc - optind != 2) {
+    usage();
     return 1;
   }
-  const char *address = argv[1];
-  const char *mnemonic, *item;
-  if (argc == 3) {
-    mnemonic = argv[2];
+  if (threads < 1) threads = 1;
+  if (threads > MAX_THREADS) threads = MAX_THREADS;
+  if (lanes < 1) lanes = 1;
+  if (lanes > MAX_LANES) lanes = MAX_LANES;
+  if (interval <= 0) interval = 10;
+
+  address = argv[optind];
+  const char *item;
+  if (argc - optind == 2) {
+    mnemonic = argv[optind + 1];
     item = "passphrase";
   } else {
     mnemonic = NULL;
@@ -48,51 +265,78 @@ int main(int argc, char **argv) {
     fprintf(stderr, "\"%s\" is not a valid mnemonic\n", mnemonic);
     return 2;
   }
-  printf("Reading %ss from stdin ...\n", item);
-  start = clock();
+
+  // the size of the input is only known when it is a regular file
+  struct stat st;
+  if (fstat(fileno(stdin), &st) == 0 && S_ISREG(st.st_mode)) {
+    input_size = st.st_size;
+  }
+
+  if (checkpoint) {
+    char line[MAX_LINE];
+    skip = read_checkpoint(checkpoint);
+    for (unsigned long i = 0; i < skip; i++) {
+      if (fgets(line, sizeof(line), stdin) == NULL) break;
+      input_read += strlen(line);
+    }
+    if (skip > 0) {
+      printf("Resuming after %lu %ss\n", skip, item);
+    }
+  }
+
+  printf("Reading %ss from stdin with %d threads and %d lanes ...\n", item,
+         threads, lanes);
+  fflush(stdout);
+  double start = now(), last_report = start;
+  long start_read = input_read;
+  active_workers = threads;
+  for (int t = 0; t < threads; t++) {
+    pthread_create(&tids[t], NULL, worker, &batches[t]);
+  }
+
+  // report the progress until all workers are idle
   for (;;) {
-    if (fgets(iter, 256, stdin) == NULL) break;
-    int len = strlen(iter);
-    if (len <= 0) {
+    usleep(100000);
+    pthread_mutex_lock(&lock);
+    int running = active_workers > 0;
+    unsigned long done = tried, lines = completed_lines;
+    long bytes = input_read;
+    pthread_mutex_unlock(&lock);
+    if (!running) {
+      break;
+    }
+    double t = now();
+    if (t - last_report < interval) {
       continue;
     }
-    count++;
-    iter[len - 1] = 0;
-    if (mnemonic) {
-      mnemonic_to_seed(mnemonic, iter, seed, NULL);
-    } else {
-      mnemonic_to_seed(iter, "", seed, NULL);
+    last_report = t;
+    double speed = done / (t - start);
+    fprintf(stderr, "Tried %lu %ss, %.2f tries/second", skip + done, item,
+            speed);
+    if (input_size > 0 && bytes > start_read) {
+      // estimate the number of remaining candidates from the bytes read
+      double per_byte = (t - start) / (bytes - start_read);
+      fprintf(stderr, ", %.1f%% done, ETA %.0f seconds",
+              100.0 * bytes / input_size, per_byte * (input_size - bytes));
     }
-    hdnode_from_seed(seed, 512 / 8, SECP256K1_NAME, &node);
-#if ACCOUNT_LEGACY
-    hdnode_private_ckd_prime(&node, 44);
-#else
-    hdnode_private_ckd_prime(&node, 49);
-#endif
-    hdnode_private_ckd_prime(&node, 0);
-    hdnode_private_ckd_prime(&node, 0);
-    hdnode_private_ckd(&node, 0);
-    hdnode_private_ckd(&node, 0);
-    hdnode_fill_public_key(&node);
-#if ACCOUNT_LEGACY
-    // Legacy address
-    ecdsa_get_address(node.public_key, 0, HASHER_SHA2_RIPEMD, HASHER_SHA2D,
-                      addr, sizeof(addr));
-#else
-    // Segwit-in-P2SH
-    ecdsa_get_address_segwit_p2sh(node.public_key, 5, HASHER_SHA2_RIPEMD,
-                                  HASHER_SHA2D, addr, sizeof(addr));
-#endif
-    if (strcmp(address, addr) == 0) {
-      found = 1;
-      break;
+    fprintf(stderr, "\n");
+    if (checkpoint) {
+      write_checkpoint(checkpoint, skip + lines);
     }
   }
-  float dur = (float)(clock() - start) / CLOCKS_PER_SEC;
-  printf("Tried %d %ss in %f seconds = %f tries/second\n", count, item, dur,
-         (float)count / dur);
+
+  for (int t = 0; t < threads; t++) {
+    pthread_join(tids[t], NULL);
+  }
+  if (checkpoint) {
+    write_checkpoint(checkpoint, skip + completed_lines);
+  }
+
+  double dur = now() - start;
+  printf("Tried %lu %ss in %f seconds = %f tries/second\n", tried, item, dur,
+         tried / dur);
   if (found) {
-    printf("Correct %s found! :-)\n\"%s\"\n", item, iter);
+    printf("Correct %s found! :-)\n\"%s\"\n", item, found_item);
     return 0;
   }
   printf("Correct %s not found. :-(\n", item);
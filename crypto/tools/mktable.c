@@ -1,51 +1,62 @@
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "bignum.h"
 #include "bip32.h"
 #include "ecdsa.h"
 #include "rand.h"
 
 /*
- * This program prints the contents of the ecdsa_curve.cp array.
- * The entry cp[i][j] contains the number (2*j+1)*16^i*G,
- * where G is the generator of the specified elliptic curve.
+ * This program prints the contents of the ecdsa_curve.cp array for a window
+ * of WINDOW bits, 4 by default. The entry cp[i][j] contains the number
+ * (2*j+1)*B^i*G, where B = 2^WINDOW and G is the generator of the specified
+ * elliptic curve. There are ceil(256 / WINDOW) rows of 2^(WINDOW-1) entries.
  */
 int main(int argc, char **argv) {
   int i, j, k;
-  if (argc != 2) {
-    printf("Usage: %s CURVE_NAME\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    printf("Usage: %s CURVE_NAME [WINDOW]\n", argv[0]);
     return 1;
   }
   const char *name = argv[1];
   const curve_info *info = get_curve_by_name(name);
-  const ecdsa_curve *curve = info->params;
-  if (curve == 0) {
+  if (info == 0 || info->params == 0) {
     printf("Unknown curve '%s'\n", name);
     return 1;
   }
+  const ecdsa_curve *curve = info->params;
+  const int window = argc == 3 ? atoi(argv[2]) : 4;
+  if (window != 4 && window != 5 && window != 6 && window != 8) {
+    printf("Unsupported window '%s'\n", argv[2]);
+    return 1;
+  }
+  const int rows = (256 + window - 1) / window;
+  const int cols = 1 << (window - 1);
 
   curve_point ng = curve->G;
   curve_point pow2ig = curve->G;
-  for (i = 0; i < 64; i++) {
+  for (i = 0; i < rows; i++) {
     // invariants:
-    //   pow2ig = 16^i * G
+    //   pow2ig = B^i * G
     //   ng     = pow2ig
     printf("\t{\n");
-    for (j = 0; j < 8; j++) {
+    for (j = 0; j < cols; j++) {
       // invariants:
-      //   pow2ig = 16^i * G
-      //   ng     = (2*j+1) * 16^i * G
+      //   pow2ig = B^i * G
+      //   ng     = (2*j+1) * B^i * G
 #ifndef NDEBUG
       curve_point checkresult;
       bignum256 a;
-      bn_zero(&a);
-      a.val[(4 * i) / BN_BITS_PER_LIMB] = ((uint32_t)2 * j + 1)
-                                          << ((4 * i) % BN_BITS_PER_LIMB);
-      bn_normalize(&a);
+      bn_read_uint32(2 * j + 1, &a);
+      for (k = 0; k < window * i; k++) {
+        bn_lshift(&a);
+      }
+      bn_fast_mod(&a, &curve->order);
+      bn_mod(&a, &curve->order);
       point_multiply(curve, &a, &curve->G, &checkresult);
       assert(point_is_equal(&checkresult, &ng));
 #endif
-      printf("\t\t/* %2d*16^%d*G: */\n\t\t{{{", 2 * j + 1, i);
+      printf("\t\t/* %2d*%d^%d*G: */\n\t\t{{{", 2 * j + 1, 1 << window, i);
       // print x coordinate
       for (k = 0; k < 9; k++) {
         printf((k < 8 ? "0x%08x, " : "0x%04x"), ng.x.val[k]);
@@ -55,7 +66,7 @@ int main(int argc, char **argv) {
       for (k = 0; k < 9; k++) {
         printf((k < 8 ? "0x%08x, " : "0x%04x"), ng.y.val[k]);
       }
-      if (j == 7) {
+      if (j == cols - 1) {
         printf("}}}\n\t},\n");
       } else {
         printf("}}},\n");
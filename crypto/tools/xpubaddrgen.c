@@ -1,48 +1,352 @@
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "bip32.h"
+#include "cash_addr.h"
 #include "curves.h"
 #include "ecdsa.h"
+#include "secp256k1.h"
+#include "segwit_addr.h"
 
 #define VERSION_PUBLIC 0x0488b21e
 
-void process_job(uint32_t jobid, const char *xpub, uint32_t change,
-                 uint32_t from, uint32_t to) {
-  HDNode node, child;
-  if (change > 1 || to <= from ||
+// number of addresses derived by a single work item
+#define CHUNK_SIZE 256
+// number of work items that can be in flight at once
+#define QUEUE_SIZE 1024
+#define MAX_THREADS 256
+// "<jobid> <index> <address>\n"
+#define MAX_LINE_SIZE (10 + 1 + 10 + 1 + MAX_ADDR_SIZE + 1)
+
+typedef enum {
+  FORMAT_LEGACY,
+  FORMAT_P2SH_SEGWIT,
+  FORMAT_BECH32,
+  FORMAT_CASHADDR,
+} address_format;
+
+typedef struct {
+  uint32_t jobid;
+  // the change node, derived once per job by the reader
+  curve_point parent;
+  uint8_t chain_code[32];
+  uint32_t from, to;
+  int last;       // last work item of the job
+  int malformed;  // the input line could not be parsed
+  int error;
+  int done;
+  char *out;
+  size_t out_len;
+} work_item;
+
+static address_format format = FORMAT_LEGACY;
+
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_not_full = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_has_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_has_done = PTHREAD_COND_INITIALIZER;
+static work_item queue[QUEUE_SIZE];
+// sequence numbers of the next item to be produced, taken and written
+static uint64_t produced, taken, written;
+static int input_finished;
+
+static int get_address(const uint8_t *pubkey, char *address, int size) {
+  uint8_t raw[MAX_ADDR_RAW_SIZE];
+  switch (format) {
+    case FORMAT_P2SH_SEGWIT:
+      ecdsa_get_address_segwit_p2sh(pubkey, 5, HASHER_SHA2_RIPEMD,
+                                    HASHER_SHA2D, address, size);
+      return 1;
+    case FORMAT_BECH32:
+      ecdsa_get_pubkeyhash(pubkey, HASHER_SHA2_RIPEMD, raw);
+      return segwit_addr_encode(address, "bc", 0, raw, 20);
+    case FORMAT_CASHADDR:
+      // version byte 0 means P2KH with a 160-bit hash
+      ecdsa_get_address_raw(pubkey, 0, HASHER_SHA2_RIPEMD, raw);
+      return cash_addr_encode(address, "bitcoincash", raw, 21);
+    default:
+      ecdsa_get_address(pubkey, 0, HASHER_SHA2_RIPEMD, HASHER_SHA2D, address,
+                        size);
+      return 1;
+  }
+}
+
+// derives the change node of xpub into item, called by the reader thread
+static int prepare_item(work_item *item, const char *xpub, uint32_t change) {
+  HDNode node;
+
+  if (change > 1 ||
       hdnode_deserialize_public(xpub, VERSION_PUBLIC, SECP256K1_NAME, &node,
-                                NULL) != 0) {
-    printf("%d error\n", jobid);
+                                NULL) != 0 ||
+      hdnode_public_ckd(&node, change) != 1 ||
+      !ecdsa_read_pubkey(&secp256k1, node.public_key, &item->parent)) {
+    return 0;
+  }
+  memcpy(item->chain_code, node.chain_code, sizeof(item->chain_code));
+  return 1;
+}
+
+// derives the addresses of one work item into its output buffer
+// this runs on all workers at once
+static void process_item(work_item *item) {
+  curve_point children[CHUNK_SIZE];
+  uint8_t pubkey[33];
+  char address[MAX_ADDR_SIZE];
+  uint32_t count = item->to - item->from;
+
+  item->out = malloc((size_t)count * MAX_LINE_SIZE + 1);
+  item->out_len = 0;
+  if (!item->out ||
+      !hdnode_public_ckd_cp_batch(&secp256k1, &item->parent, item->chain_code,
+                                  item->from, count, children)) {
+    item->error = 1;
+    return;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    compress_coords(&children[i], pubkey);
+    if (!get_address(pubkey, address, sizeof(address))) {
+      item->error = 1;
+      return;
+    }
+    item->out_len += sprintf(item->out + item->out_len, "%" PRIu32 " %" PRIu32
+                             " %s\n", item->jobid, item->from + i, address);
+  }
+}
+
+static void *worker(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&queue_lock);
+  for (;;) {
+    while (taken == produced && !input_finished) {
+      pthread_cond_wait(&queue_has_work, &queue_lock);
+    }
+    if (taken == produced) {
+      break;
+    }
+    work_item *item = &queue[taken++ % QUEUE_SIZE];
+    pthread_mutex_unlock(&queue_lock);
+    if (!item->error) {
+      process_item(item);
+    }
+    pthread_mutex_lock(&queue_lock);
+    item->done = 1;
+    pthread_cond_broadcast(&queue_has_done);
+  }
+  pthread_mutex_unlock(&queue_lock);
+  return NULL;
+}
+
+// prints finished work items in the order they were read
+static void *writer(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&queue_lock);
+  for (;;) {
+    while (written == produced && !input_finished) {
+      pthread_cond_wait(&queue_has_done, &queue_lock);
+    }
+    if (written == produced) {
+      break;
+    }
+    work_item *item = &queue[written % QUEUE_SIZE];
+    if (!item->done) {
+      pthread_cond_wait(&queue_has_done, &queue_lock);
+      continue;
+    }
+    pthread_mutex_unlock(&queue_lock);
+    if (item->malformed) {
+      printf("error\n");
+    } else if (item->error) {
+      printf("%" PRIu32 " error\n", item->jobid);
+    } else {
+      fwrite(item->out, 1, item->out_len, stdout);
+    }
+    free(item->out);
+    item->out = NULL;
+    if (item->last) {
+      fflush(stdout);
+    }
+    pthread_mutex_lock(&queue_lock);
+    written++;
+    pthread_cond_signal(&queue_not_full);
+  }
+  pthread_mutex_unlock(&queue_lock);
+  fflush(stdout);
+  return NULL;
+}
+
+static void push_item(const work_item *item) {
+  pthread_mutex_lock(&queue_lock);
+  while (produced - written == QUEUE_SIZE) {
+    pthread_cond_wait(&queue_not_full, &queue_lock);
+  }
+  queue[produced++ % QUEUE_SIZE] = *item;
+  pthread_cond_signal(&queue_has_work);
+  pthread_cond_signal(&queue_has_done);
+  pthread_mutex_unlock(&queue_lock);
+}
+
+// splits a job into work items of at most CHUNK_SIZE addresses
+static void push_job(uint32_t jobid, const char *xpub, uint32_t change,
+                     uint32_t from, uint32_t to) {
+  work_item item;
+
+  memset(&item, 0, sizeof(item));
+  item.jobid = jobid;
+  item.last = 1;
+  if (to <= from || to > 0x80000000 || !prepare_item(&item, xpub, change)) {
+    item.error = 1;
+    push_item(&item);
     return;
   }
-  hdnode_public_ckd(&node, change);
-  uint32_t i;
-  char address[36];
-  for (i = from; i < to; i++) {
-    memcpy(&child, &node, sizeof(HDNode));
-    hdnode_public_ckd(&child, i);
-    ecdsa_get_address(child.public_key, 0, HASHER_SHA2, HASHER_SHA2D, address,
-                      sizeof(address));
-    printf("%d %d %s\n", jobid, i, address);
+  for (uint32_t i = from; i < to; i += CHUNK_SIZE) {
+    item.from = i;
+    item.to = (to - i > CHUNK_SIZE) ? i + CHUNK_SIZE : to;
+    item.last = item.to == to;
+    push_item(&item);
+  }
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *bench_worker(void *arg) {
+  work_item *item = arg;
+  uint32_t total = item->to;
+  for (uint32_t i = 0; i < total; i += CHUNK_SIZE) {
+    item->from = i;
+    item->to = (total - i > CHUNK_SIZE) ? i + CHUNK_SIZE : total;
+    process_item(item);
+    free(item->out);
+  }
+  item->to = total;
+  return NULL;
+}
+
+static int bench(int threads, uint32_t count) {
+  static work_item items[MAX_THREADS];
+  pthread_t tids[MAX_THREADS];
+
+  for (int t = 0; t < threads; t++) {
+    memset(&items[t], 0, sizeof(items[t]));
+    prepare_item(&items[t],
+                 "xpub6BcjTvRCYD4VvFQ8whztSXhbNyhS56eTd5P3g9Zvd3zPEeUeL5CUqBYX8"
+                 "NSd1b6Thitr8bZcSnesmXZH7KerMcc4tUkenBShYCtQ1L8ebVe",
+                 t & 1);
+    items[t].jobid = t;
+    items[t].to = count;
+  }
+  double start = now();
+  for (int t = 0; t < threads; t++) {
+    pthread_create(&tids[t], NULL, bench_worker, &items[t]);
   }
+  for (int t = 0; t < threads; t++) {
+    pthread_join(tids[t], NULL);
+  }
+  double elapsed = now() - start;
+  double speed = (double)count * threads / elapsed;
+  printf("%d threads, %" PRIu64 " addresses in %.2f s: %.2f addr/s, "
+         "%.2f addr/s per core\n",
+         threads, (uint64_t)count * threads, elapsed, speed, speed / threads);
+  return 0;
 }
 
-int main(void) {
+static void usage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [-t threads] [-f legacy|p2sh|bech32|cashaddr] "
+          "[-s skip] [-b count]\n",
+          name);
+}
+
+int main(int argc, char **argv) {
   char line[1024], xpub[1024];
   uint32_t jobid, change, from, to;
-  int r;
+  int r, opt;
+  int threads = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned long skip = 0, bench_count = 0;
+  pthread_t tids[MAX_THREADS], writer_tid;
+
+  while ((opt = getopt(argc, argv, "t:f:s:b:")) != -1) {
+    switch (opt) {
+      case 't':
+        threads = atoi(optarg);
+        break;
+      case 'f':
+        if (strcmp(optarg, "legacy") == 0) {
+          format = FORMAT_LEGACY;
+        } else if (strcmp(optarg, "p2sh") == 0) {
+          format = FORMAT_P2SH_SEGWIT;
+        } else if (strcmp(optarg, "bech32") == 0) {
+          format = FORMAT_BECH32;
+        } else if (strcmp(optarg, "cashaddr") == 0) {
+          format = FORMAT_CASHADDR;
+        } else {
+          usage(argv[0]);
+          return 1;
+        }
+        break;
+      case 's':
+        skip = strtoul(optarg, NULL, 10);
+        break;
+      case 'b':
+        bench_count = strtoul(optarg, NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+  if (threads > MAX_THREADS) {
+    threads = MAX_THREADS;
+  }
+
+  if (bench_count > 0) {
+    return bench(threads, bench_count);
+  }
+
+  for (int t = 0; t < threads; t++) {
+    pthread_create(&tids[t], NULL, worker, NULL);
+  }
+  pthread_create(&writer_tid, NULL, writer, NULL);
+
   for (;;) {
     if (!fgets(line, sizeof(line), stdin)) break;
+    if (skip > 0) {
+      skip--;
+      continue;
+    }
     r = sscanf(line, "%u %s %u %u %u\n", &jobid, xpub, &change, &from, &to);
     if (r < 1) {
-      printf("error\n");
+      work_item item;
+      memset(&item, 0, sizeof(item));
+      item.malformed = item.error = item.last = 1;
+      push_item(&item);
     } else if (r != 5) {
-      printf("%d error\n", jobid);
+      push_job(jobid, "", 0, 0, 0);
     } else {
-      process_job(jobid, xpub, change, from, to);
+      push_job(jobid, xpub, change, from, to);
     }
   }
+
+  pthread_mutex_lock(&queue_lock);
+  input_finished = 1;
+  pthread_cond_broadcast(&queue_has_work);
+  pthread_cond_broadcast(&queue_has_done);
+  pthread_mutex_unlock(&queue_lock);
+
+  for (int t = 0; t < threads; t++) {
+    pthread_join(tids[t], NULL);
+  }
+  pthread_join(writer_tid, NULL);
   return 0;
 }
@@ -27,6 +27,10 @@ static SDL_Rect dstrect;
 
 #define ENV_OLED_FULLSCREEN "TREZOR_OLED_FULLSCREEN"
 #define ENV_OLED_SCALE "TREZOR_OLED_SCALE"
+#define ENV_OLED_STATS "TREZOR_OLED_STATS"
+
+static int stats = 0;
+static uint32_t stats_frames = 0, stats_bytes = 0;
 
 static int emulatorFullscreen(void) {
   const char *variable = getenv(ENV_OLED_FULLSCREEN);
@@ -56,6 +60,8 @@ void oledInit(void) {
   atexit(SDL_Quit);
 
   int scale = emulatorScale();
+  const char *variable = getenv(ENV_OLED_STATS);
+  stats = variable && atoi(variable);
   int fullscreen = emulatorFullscreen();
 
   SDL_Window *window = SDL_CreateWindow(
@@ -125,6 +131,16 @@ void oledRefresh(void) {
   SDL_RenderCopy(renderer, texture, NULL, &dstrect);
   SDL_RenderPresent(renderer);
 
+  /* Count the bytes the device would send over SPI */
+  oledClearDirty();
+  if (stats) {
+    stats_frames++;
+    stats_bytes += oledRefreshBytes();
+    fprintf(stderr, "oled: frame %u sent %u bytes, %u bytes per frame\n",
+            (unsigned)stats_frames, (unsigned)oledRefreshBytes(),
+            (unsigned)(stats_bytes / stats_frames));
+  }
+
   /* Return it back */
   oledInvertDebugLink();
 }
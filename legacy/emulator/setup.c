@@ -77,7 +77,36 @@ static void setup_urandom(void) {
   }
 }
 
+// maps a shared flash template copy-on-write, the writes of this instance
+// stay in its private pages and are discarded at exit
+static void setup_flash_template(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror("Failed to open flash template");
+    exit(1);
+  }
+
+  if (lseek(fd, 0, SEEK_END) != FLASH_TOTAL_SIZE) {
+    fprintf(stderr, "Flash template has a wrong size\n");
+    exit(1);
+  }
+
+  emulator_flash_base =
+      mmap(NULL, FLASH_TOTAL_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (emulator_flash_base == MAP_FAILED) {
+    perror("Failed to map flash template");
+    exit(1);
+  }
+  close(fd);
+}
+
 static void setup_flash(void) {
+  const char *template = getenv("TREZOR_FLASH_TEMPLATE");
+  if (template) {
+    setup_flash_template(template);
+    return;
+  }
+
   int fd = open(EMULATOR_FLASH_FILE, O_RDWR | O_SYNC | O_CREAT, 0644);
   if (fd < 0) {
     perror("Failed to open flash emulation file");
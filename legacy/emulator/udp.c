@@ -23,8 +23,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #define TREZOR_UDP_PORT 21324
+#define SOCKET_PORT_TRIES 16
 
 struct usb_socket {
   int fd;
@@ -48,13 +50,39 @@ static int socket_setup(int port) {
   addr.sin_addr.s_addr = htonl(INADDR_ANY);
 
   if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
-    perror("Failed to bind socket");
-    exit(1);
+    close(fd);
+    return -1;
   }
 
   return fd;
 }
 
+static void socket_setup_pair(int port) {
+  usb_main.fd = socket_setup(port);
+  usb_debug.fd = usb_main.fd < 0 ? -1 : socket_setup(port + 1);
+  if (usb_debug.fd < 0 && usb_main.fd >= 0) {
+    close(usb_main.fd);
+    usb_main.fd = -1;
+  }
+}
+
+// lets the kernel pick a free port for the main interface
+static int socket_free_port(void) {
+  int fd = socket_setup(0);
+  if (fd < 0) {
+    perror("Failed to bind socket");
+    exit(1);
+  }
+  struct sockaddr_in addr = {0};
+  socklen_t len = sizeof(addr);
+  if (getsockname(fd, (struct sockaddr *)&addr, &len) != 0) {
+    perror("Failed to get socket name");
+    exit(1);
+  }
+  close(fd);
+  return ntohs(addr.sin_port);
+}
+
 static size_t socket_write(struct usb_socket *sock, const void *buffer,
                            size_t size) {
   if (sock->fromlen > 0) {
@@ -94,10 +122,36 @@ static size_t socket_read(struct usb_socket *sock, void *buffer, size_t size) {
 }
 
 void emulatorSocketInit(void) {
-  usb_main.fd = socket_setup(TREZOR_UDP_PORT);
+  const char *env = getenv("TREZOR_UDP_PORT");
+  int port = env ? atoi(env) : TREZOR_UDP_PORT;
+
+  if (port != 0) {
+    socket_setup_pair(port);
+  } else {
+    // port 0 asks for automatic allocation, a free port may be taken by
+    // another instance before both interfaces are bound
+    for (int tries = 0; tries < SOCKET_PORT_TRIES; tries++) {
+      port = socket_free_port();
+      if (port < 0xFFFF) {
+        socket_setup_pair(port);
+        if (usb_main.fd >= 0) break;
+      }
+    }
+  }
+  if (usb_main.fd < 0) {
+    perror("Failed to bind socket");
+    exit(1);
+  }
   usb_main.fromlen = 0;
-  usb_debug.fd = socket_setup(TREZOR_UDP_PORT + 1);
   usb_debug.fromlen = 0;
+
+  // tell the launcher that the emulator is reachable and on which port
+  const char *ready = getenv("TREZOR_READY_FD");
+  if (ready) {
+    int fd = atoi(ready);
+    dprintf(fd, "%d\n", port);
+    close(fd);
+  }
 }
 
 size_t emulatorSocketRead(int *iface, void *buffer, size_t size) {
@@ -0,0 +1,257 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host benchmark of the Ethereum data chunk window. It signs transactions
+ * with large data for several chunk windows, answering the requests the way
+ * trezorlib.ethereum.sign_tx does, and prints the data round trips and the
+ * CPU time. It checks that every window gives the same signature and that a
+ * failure in the middle of a window is reported only once.
+ *
+ *   make EMULATOR=1 bench_ethereum && ./bench_ethereum
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bitmaps.h"
+#include "ethereum.h"
+#include "fsm.h"
+#include "layout2.h"
+#include "memzero.h"
+#include "messages.h"
+#include "protect.h"
+
+#define MAX_DATA (512 * 1024)
+#define ROUNDS 5
+
+// the UI, the buttons and the USB are not part of the benchmark
+
+void layoutProgress(const char *desc, int permil) {
+  (void)desc;
+  (void)permil;
+}
+
+void layoutDialogSwipe(const BITMAP *icon, const char *btnNo,
+                       const char *btnYes, const char *desc, const char *line1,
+                       const char *line2, const char *line3, const char *line4,
+                       const char *line5, const char *line6) {
+  (void)icon;
+  (void)btnNo;
+  (void)btnYes;
+  (void)desc;
+  (void)line1;
+  (void)line2;
+  (void)line3;
+  (void)line4;
+  (void)line5;
+  (void)line6;
+}
+
+void layoutHome(void) {}
+
+bool protectButton(ButtonRequestType type, bool confirm_only) {
+  (void)type;
+  (void)confirm_only;
+  return true;
+}
+
+int hdnode_get_ethereum_pubkeyhash(const HDNode *node, uint8_t *pubkeyhash) {
+  (void)node;
+  (void)pubkeyhash;
+  return 0;
+}
+
+// the signing blinds with random numbers, which must not be all zero
+uint32_t random32(void) {
+  static uint32_t state = 0x12345678;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static int requests = 0, failures = 0;
+static bool answered = false;
+static EthereumTxRequest request;
+
+bool msg_write_common(char type, uint16_t msg_id, const void *msg_ptr) {
+  (void)type;
+  if (msg_id == MessageType_MessageType_EthereumTxRequest) {
+    memcpy(&request, msg_ptr, sizeof(request));
+    requests++;
+    answered = true;
+  }
+  return true;
+}
+
+static void failure(void) {
+  failures++;
+  answered = false;
+}
+
+#if DEBUG_LINK
+void fsm_sendFailureDebug(FailureType code, const char *text,
+                          const char *source) {
+  (void)code;
+  (void)text;
+  (void)source;
+  failure();
+}
+#else
+void fsm_sendFailure(FailureType code, const char *text) {
+  (void)code;
+  (void)text;
+  failure();
+}
+#endif
+
+static uint8_t data[MAX_DATA];
+static EthereumSignTx msg;
+static EthereumTxAck ack;
+
+static double cpu(void) { return (double)clock() / CLOCKS_PER_SEC; }
+
+/*
+ * Sign a contract call with length bytes of data.  The bad_ack-th TxAck is
+ * sent empty, 0 sends all of them.  Returns the number of data round trips,
+ * or -1 when the device fails or breaks the protocol.
+ */
+static int sign(uint32_t length, uint32_t window, int bad_ack,
+                uint8_t signature[65]) {
+  HDNode node = {0};
+  memset(node.private_key, 0x11, sizeof(node.private_key));
+
+  memzero(&msg, sizeof(msg));
+  msg.has_nonce = true;
+  msg.nonce.size = 1;
+  msg.nonce.bytes[0] = 7;
+  msg.has_gas_price = true;
+  msg.gas_price.size = 4;
+  memcpy(msg.gas_price.bytes, "\x04\xa8\x17\xc8", 4);
+  msg.has_gas_limit = true;
+  msg.gas_limit.size = 3;
+  memcpy(msg.gas_limit.bytes, "\x1e\x84\x80", 3);
+  msg.has_to = true;
+  strlcpy(msg.to, "0x1d1c328764a41bda0492b66baa30c4a339ff85ef",
+          sizeof(msg.to));
+  msg.has_chain_id = true;
+  msg.chain_id = 1;
+  msg.has_data_length = true;
+  msg.data_length = length;
+  msg.has_data_initial_chunk = true;
+  msg.data_initial_chunk.size = length < 1024 ? length : 1024;
+  memcpy(msg.data_initial_chunk.bytes, data, msg.data_initial_chunk.size);
+  msg.has_chunk_window = true;
+  msg.chunk_window = window;
+
+  uint32_t offset = msg.data_initial_chunk.size;
+  int start_failures = failures, acks = 0;
+  requests = 0;
+  answered = false;
+  ethereum_signing_init(&msg, &node);
+  while (answered && !request.has_signature_r) {
+    answered = false;
+    uint32_t count = request.has_chunk_count ? request.chunk_count : 1;
+    for (uint32_t i = 0; i < count; i++) {
+      if (answered) {
+        // the device must not ask again before the window is used up
+        return -1;
+      }
+      uint32_t size = length - offset;
+      if (size > request.data_length) {
+        size = request.data_length;
+      }
+      ack.has_data_chunk = true;
+      ack.data_chunk.size = (++acks == bad_ack) ? 0 : size;
+      memcpy(ack.data_chunk.bytes, data + offset, size);
+      offset += size;
+      ethereum_signing_txack(&ack);
+    }
+  }
+  if (failures != start_failures || !request.has_signature_r ||
+      offset != length) {
+    return -1;
+  }
+
+  signature[0] = request.signature_v;
+  memcpy(signature + 1, request.signature_r.bytes, 32);
+  memcpy(signature + 33, request.signature_s.bytes, 32);
+  return requests - 1;
+}
+
+int main(void) {
+  static const uint32_t lengths[] = {4 * 1024, 64 * 1024, 256 * 1024,
+                                     MAX_DATA};
+  static const uint32_t windows[] = {1, 4, 16};
+  int errors = 0;
+
+  for (uint32_t i = 0; i < sizeof(data); i++) {
+    data[i] = (i * 2654435761u) >> 24;
+  }
+
+  for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    uint8_t first[65] = {0};
+    for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+      uint8_t signature[65] = {0};
+      int round_trips = 0;
+      double best = 0;
+      for (int r = 0; r < ROUNDS; r++) {
+        double t = cpu();
+        round_trips = sign(lengths[l], windows[w], 0, signature);
+        t = cpu() - t;
+        if (r == 0 || t < best) {
+          best = t;
+        }
+      }
+      if (round_trips < 0) {
+        printf("%7u bytes, window %2u: signing failed\n", lengths[l],
+               windows[w]);
+        errors++;
+        continue;
+      }
+      if (w == 0) {
+        memcpy(first, signature, sizeof(first));
+      } else if (memcmp(first, signature, sizeof(first)) != 0) {
+        printf("%7u bytes, window %2u: signature differs\n", lengths[l],
+               windows[w]);
+        errors++;
+      }
+      printf("%7u bytes, window %2u: %4d round trips, %6.2f ms CPU\n",
+             lengths[l], windows[w], round_trips, best * 1e3);
+    }
+  }
+
+  // an empty chunk in a window: one failure, the rest of the window is
+  // dropped silently and the next transaction signs normally
+  uint8_t signature[65] = {0};
+  int start_failures = failures;
+  int bad = sign(64 * 1024, 16, 3, signature);
+  int reported = failures - start_failures;
+  int next = sign(64 * 1024, 16, 0, signature);
+  printf("empty chunk in a window: %d failure(s) reported, next signing %s\n",
+         reported, next < 0 ? "failed" : "ok");
+  if (bad >= 0 || reported != 1 || next < 0) {
+    errors++;
+  }
+
+  return errors ? 1 : 0;
+}
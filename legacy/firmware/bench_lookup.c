@@ -0,0 +1,150 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host benchmark of the coin and token lookups. It compares the sorted
+ * lookups with the linear scans they replaced over all generated coins and
+ * tokens, and checks that both return the same entries.
+ *
+ *   make EMULATOR=1 bench_lookup && ./bench_lookup
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "coins.h"
+#include "ethereum_tokens.h"
+#include "rand.h"
+
+#define ROUNDS 2000
+
+// needed by the linked crypto objects, the lookups use no randomness
+uint32_t random32(void) { return 0; }
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const CoinInfo *linearCoinByName(const char *name) {
+  for (int i = 0; i < COINS_COUNT; i++) {
+    if (strcmp(name, coins[i].coin_name) == 0) {
+      return &(coins[i]);
+    }
+  }
+  return 0;
+}
+
+static const CoinInfo *linearCoinByAddressType(uint32_t address_type) {
+  for (int i = 0; i < COINS_COUNT; i++) {
+    if (address_type == coins[i].address_type) {
+      return &(coins[i]);
+    }
+  }
+  return 0;
+}
+
+static const CoinInfo *linearCoinBySlip44(uint32_t coin_type) {
+  for (int i = 0; i < COINS_COUNT; i++) {
+    if (coin_type == coins[i].coin_type) {
+      return &(coins[i]);
+    }
+  }
+  return 0;
+}
+
+static const TokenType *linearTokenByChainAddress(uint32_t chain_id,
+                                                  const uint8_t *address) {
+  for (int i = 0; i < TOKENS_COUNT; i++) {
+    if (chain_id == tokens[i].chain_id &&
+        memcmp(address, tokens[i].address, 20) == 0) {
+      return &(tokens[i]);
+    }
+  }
+  return UnknownToken;
+}
+
+static int errors = 0;
+
+static void check(const char *what, int i, const void *a, const void *b) {
+  if (a != b) {
+    printf("%s %d: lookups differ\n", what, i);
+    errors++;
+  }
+}
+
+// keys of the i-th entry, i == COUNT is a key which is not present
+static const char *nameKey(int i) {
+  return i < COINS_COUNT ? coins[i].coin_name : "Absent";
+}
+
+static uint32_t addressTypeKey(int i) {
+  return i < COINS_COUNT ? coins[i].address_type : 0xFFFFFFFF;
+}
+
+static uint32_t slip44Key(int i) {
+  return i < COINS_COUNT ? coins[i].coin_type : 0x7FFFFFFF;
+}
+
+static uint32_t chainKey(int i) {
+  return i < TOKENS_COUNT ? tokens[i].chain_id : 0;
+}
+
+static const uint8_t *addressKey(int i) {
+  static const uint8_t absent[20] = {0};
+  return i < TOKENS_COUNT ? (const uint8_t *)tokens[i].address : absent;
+}
+
+// times the linear and the sorted lookup of all entries and of an absent key
+#define BENCH(what, count, linear, sorted)                                 \
+  do {                                                                     \
+    double t[2] = {0};                                                     \
+    for (int k = 0; k < 2; k++) {                                          \
+      double start = now();                                                \
+      for (int r = 0; r < ROUNDS; r++) {                                   \
+        for (int i = 0; i <= (count); i++) {                               \
+          const void *volatile res = k ? (sorted) : (linear);              \
+          (void)res;                                                       \
+        }                                                                  \
+      }                                                                    \
+      t[k] = (now() - start) / ROUNDS / ((count) + 1);                     \
+    }                                                                      \
+    for (int i = 0; i <= (count); i++) {                                   \
+      check(what, i, (linear), (sorted));                                  \
+    }                                                                      \
+    printf("%-20s %5d entries: linear %8.1f ns, sorted %8.1f ns\n", what, \
+           (count), t[0] * 1e9, t[1] * 1e9);                               \
+  } while (0)
+
+int main(void) {
+  BENCH("coinByName", COINS_COUNT, linearCoinByName(nameKey(i)),
+        coinByName(nameKey(i)));
+  BENCH("coinByAddressType", COINS_COUNT,
+        linearCoinByAddressType(addressTypeKey(i)),
+        coinByAddressType(addressTypeKey(i)));
+  BENCH("coinBySlip44", COINS_COUNT, linearCoinBySlip44(slip44Key(i)),
+        coinBySlip44(slip44Key(i)));
+  BENCH("tokenByChainAddress", TOKENS_COUNT,
+        linearTokenByChainAddress(chainKey(i), addressKey(i)),
+        tokenByChainAddress(chainKey(i), addressKey(i)));
+
+  return errors ? 1 : 0;
+}
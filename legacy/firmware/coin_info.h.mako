@@ -11,4 +11,9 @@
 
 extern const CoinInfo coins[COINS_COUNT];
 
+// indices of coins sorted by coin_name, address_type and coin_type
+extern const uint16_t coins_by_name[COINS_COUNT];
+extern const uint16_t coins_by_address_type[COINS_COUNT];
+extern const uint16_t coins_by_slip44[COINS_COUNT];
+
 #endif
@@ -23,32 +23,51 @@
 #include "base58.h"
 #include "ecdsa.h"
 
-const CoinInfo *coinByName(const char *name) {
-  if (!name) return 0;
-  for (int i = 0; i < COINS_COUNT; i++) {
-    if (strcmp(name, coins[i].coin_name) == 0) {
-      return &(coins[i]);
+// Binary search in an index of coins sorted by the key compared by cmp.
+// Returns the first coin in the order of coins with the given key.
+static const CoinInfo *coinFind(const uint16_t *index,
+                                int (*cmp)(const CoinInfo *, const void *),
+                                const void *key) {
+  int lo = 0, hi = COINS_COUNT;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (cmp(&coins[index[mid]], key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
+  if (lo < COINS_COUNT && cmp(&coins[index[lo]], key) == 0) {
+    return &(coins[index[lo]]);
+  }
   return 0;
 }
 
+static int cmpUint32(uint32_t a, uint32_t b) { return (a > b) - (a < b); }
+
+static int cmpName(const CoinInfo *coin, const void *name) {
+  return strcmp(coin->coin_name, name);
+}
+
+static int cmpAddressType(const CoinInfo *coin, const void *address_type) {
+  return cmpUint32(coin->address_type, *(const uint32_t *)address_type);
+}
+
+static int cmpSlip44(const CoinInfo *coin, const void *coin_type) {
+  return cmpUint32(coin->coin_type, *(const uint32_t *)coin_type);
+}
+
+const CoinInfo *coinByName(const char *name) {
+  if (!name) return 0;
+  return coinFind(coins_by_name, cmpName, name);
+}
+
 const CoinInfo *coinByAddressType(uint32_t address_type) {
-  for (int i = 0; i < COINS_COUNT; i++) {
-    if (address_type == coins[i].address_type) {
-      return &(coins[i]);
-    }
-  }
-  return 0;
+  return coinFind(coins_by_address_type, cmpAddressType, &address_type);
 }
 
 const CoinInfo *coinBySlip44(uint32_t coin_type) {
-  for (int i = 0; i < COINS_COUNT; i++) {
-    if (coin_type == coins[i].coin_type) {
-      return &(coins[i]);
-    }
-  }
-  return 0;
+  return coinFind(coins_by_slip44, cmpSlip44, &coin_type);
 }
 
 bool coinExtractAddressType(const CoinInfo *coin, const char *addr,
@@ -500,6 +500,10 @@ void session_clearCache(Session *session) {
 
 void config_lockDevice(void) { storage_lock(); }
 
+// Compacts the storage in small steps while the device is idle, so that a
+// later write does not have to wait for a whole compaction.
+void config_idle(void) { storage_idle(); }
+
 static void get_u2froot_callback(uint32_t iter, uint32_t total) {
   layoutProgress_zh(ui_prompt_updating[ui_language], 1000 * iter / total);
 }
@@ -558,7 +562,7 @@ bool config_dumpNode(HDNodeType *node) {
   return true;
 }
 
-void config_loadDevice(const LoadDevice *msg) {
+bool config_loadDevice(const LoadDevice *msg) {
   session_clear(false);
   config_set_bool(KEY_IMPORTED, true);
   config_setPassphraseProtection(msg->has_passphrase_protection &&
@@ -568,6 +572,11 @@ void config_loadDevice(const LoadDevice *msg) {
     config_changePin("", msg->pin);
   }
 
+  // Store the rest of the device at once, so that a power loss cannot leave a
+  // partially loaded device behind. The SE keeps no batches, there the values
+  // are written one by one.
+  bool batch = sectrue == storage_begin_batch();
+
   if (msg->mnemonics_count) {
     storage_delete(KEY_NODE);
     config_setMnemonic(msg->mnemonics[0]);
@@ -590,6 +599,11 @@ void config_loadDevice(const LoadDevice *msg) {
   if (msg->has_no_backup && msg->no_backup) {
     config_setNoBackup();
   }
+
+  if (batch && sectrue != storage_commit_batch()) {
+    return false;
+  }
+  return true;
 }
 
 #endif
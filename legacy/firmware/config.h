@@ -93,8 +93,9 @@ extern Storage configUpdate;
 void config_init(void);
 void session_clear(bool lock);
 void config_lockDevice(void);
+void config_idle(void);
 
-void config_loadDevice(const LoadDevice *msg);
+bool config_loadDevice(const LoadDevice *msg);
 
 const uint8_t *config_getSeed(void);
 
@@ -40,8 +40,13 @@
 /* maximum supported chain id.  v must fit in an uint32_t. */
 #define MAX_CHAIN_ID 2147483629
 
+/* maximum number of data chunks requested at once.  Each chunk arrives in
+ * its own EthereumTxAck, so this only bounds the messages in flight. */
+#define MAX_CHUNK_WINDOW 16
+
 static bool ethereum_signing = false;
 static uint32_t data_total, data_left;
+static uint32_t chunk_window, chunks_pending, chunks_discard;
 static EthereumTxRequest msg_tx_request;
 static CONFIDENTIAL uint8_t privkey[32];
 static uint32_t chain_id;
@@ -173,6 +178,14 @@ static void send_request_chunk(void) {
   layoutProgress(_("Signing"), progress);
   msg_tx_request.has_data_length = true;
   msg_tx_request.data_length = data_left <= 1024 ? data_left : 1024;
+  /* the host sends up to chunk_window chunks of data_length bytes without
+   * waiting for another request, the last one may be shorter */
+  chunks_pending = (data_left + 1023) / 1024;
+  if (chunks_pending > chunk_window) {
+    chunks_pending = chunk_window;
+  }
+  msg_tx_request.has_chunk_count = chunks_pending > 1;
+  msg_tx_request.chunk_count = chunks_pending;
   msg_write(MessageType_MessageType_EthereumTxRequest, &msg_tx_request);
 }
 
@@ -206,6 +219,7 @@ static void send_signature(void) {
 
   /* Send back the result */
   msg_tx_request.has_data_length = false;
+  msg_tx_request.has_chunk_count = false;
 
   msg_tx_request.has_signature_v = true;
   if (chain_id > MAX_CHAIN_ID) {
@@ -417,6 +431,14 @@ void ethereum_signing_init(EthereumSignTx *msg, const HDNode *node) {
   sha3_256_Init(&keccak_ctx);
 
   memzero(&msg_tx_request, sizeof(EthereumTxRequest));
+  chunk_window = msg->has_chunk_window ? msg->chunk_window : 1;
+  if (chunk_window < 1) {
+    chunk_window = 1;
+  } else if (chunk_window > MAX_CHUNK_WINDOW) {
+    chunk_window = MAX_CHUNK_WINDOW;
+  }
+  chunks_pending = 0;
+  chunks_discard = 0;
   /* set fields to 0, to avoid conditions later */
   if (!msg->has_value) msg->value.size = 0;
   if (!msg->has_data_initial_chunk) msg->data_initial_chunk.size = 0;
@@ -586,12 +608,21 @@ void ethereum_signing_init(EthereumSignTx *msg, const HDNode *node) {
 
 void ethereum_signing_txack(const EthereumTxAck *tx) {
   if (!ethereum_signing) {
+    /* the rest of a window the host sent before it saw the failure */
+    if (chunks_discard > 0) {
+      chunks_discard--;
+      return;
+    }
     fsm_sendFailure(FailureType_Failure_UnexpectedMessage,
                     _("Not in Ethereum signing mode"));
     layoutHome();
     return;
   }
 
+  if (chunks_pending > 0) {
+    chunks_pending--;
+  }
+
   if (tx->data_chunk.size > data_left) {
     fsm_sendFailure(FailureType_Failure_DataError, _("Too much data"));
     ethereum_signing_abort();
@@ -610,7 +641,9 @@ void ethereum_signing_txack(const EthereumTxAck *tx) {
   data_left -= tx->data_chunk.size;
 
   if (data_left > 0) {
-    send_request_chunk();
+    if (chunks_pending == 0) {
+      send_request_chunk();
+    }
   } else {
     send_signature();
   }
@@ -621,7 +654,9 @@ void ethereum_signing_abort(void) {
     memzero(privkey, sizeof(privkey));
     layoutHome();
     ethereum_signing = false;
+    chunks_discard = chunks_pending;
   }
+  chunks_pending = 0;
 }
 
 static void ethereum_message_hash(const uint8_t *message, size_t message_len,
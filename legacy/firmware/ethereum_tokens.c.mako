@@ -4,8 +4,10 @@
 #include <string.h>
 #include "ethereum_tokens.h"
 
+<% tokens_sorted = sorted(supported_on("trezor1", erc20), key=lambda t: (t.chain_id, t.address_bytes)) %>\
+// sorted by chain_id and address for tokenByChainAddress
 const TokenType tokens[TOKENS_COUNT] = {
-% for t in supported_on("trezor1", erc20):
+% for t in tokens_sorted:
 	{${"{:>2}".format(t.chain_id)}, ${c_str(t.address_bytes)}, " ${ascii(t.symbol)}", ${t.decimals}}, // ${t.chain} / ${t.name}
 % endfor
 };
@@ -16,10 +18,18 @@ const TokenType *UnknownToken = &_UnknownToken;
 const TokenType *tokenByChainAddress(uint32_t chain_id, const uint8_t *address)
 {
 	if (!address) return 0;
-	for (int i = 0; i < TOKENS_COUNT; i++) {
-		if (chain_id == tokens[i].chain_id && memcmp(address, tokens[i].address, 20) == 0) {
-			return &(tokens[i]);
+	// binary search for the first token not less than (chain_id, address)
+	int lo = 0, hi = TOKENS_COUNT;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		if (tokens[mid].chain_id < chain_id || (tokens[mid].chain_id == chain_id && memcmp(tokens[mid].address, address, 20) < 0)) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
 	}
+	if (lo < TOKENS_COUNT && chain_id == tokens[lo].chain_id && memcmp(address, tokens[lo].address, 20) == 0) {
+		return &(tokens[lo]);
+	}
 	return UnknownToken;
 }
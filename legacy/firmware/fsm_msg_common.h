@@ -349,7 +349,12 @@ void fsm_msgLoadDevice(const LoadDevice *msg) {
     }
   }
 
-  config_loadDevice(msg);
+  if (!config_loadDevice(msg)) {
+    fsm_sendFailure(FailureType_Failure_ProcessError,
+                    _("Failed to load device"));
+    layoutHome();
+    return;
+  }
   fsm_sendSuccess(_("Device loaded"));
   layoutHome();
 }
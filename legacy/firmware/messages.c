@@ -25,6 +25,7 @@
 #include "memzero.h"
 #include "messages.h"
 #include "si2c.h"
+#include "timer.h"
 #include "trezor.h"
 #include "util.h"
 
@@ -71,6 +72,7 @@ void MessageProcessFunc(char type, char dir, uint16_t msg_id, void *ptr) {
 
 static uint32_t msg_out_start = 0;
 uint32_t msg_out_end = 0;
+uint32_t msg_last_read_ms = 0;
 static uint32_t msg_out_cur = 0;
 uint8_t msg_out[MSG_OUT_SIZE];
 
@@ -248,6 +250,7 @@ void msg_read_common(char type, const uint8_t *buf, uint32_t len) {
   static const pb_msgdesc_t *fields = 0;
 
   if (len != 64) return;
+  msg_last_read_ms = timer_ms();
 
   if (read_state == READSTATE_IDLE) {
     if (buf[0] != '?' || buf[1] != '#' ||
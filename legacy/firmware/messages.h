@@ -43,6 +43,8 @@ const uint8_t *msg_debug_out_data(void);
 #endif
 
 extern uint32_t msg_out_end;
+// the time of the last packet received on any interface
+extern uint32_t msg_last_read_ms;
 extern uint8_t msg_out[MSG_OUT_SIZE];
 
 void msg_read_common(char type, const uint8_t *buf, uint32_t len);
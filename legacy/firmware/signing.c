@@ -53,6 +53,7 @@ enum {
   STAGE_REQUEST_3_OUTPUT,
   STAGE_REQUEST_4_INPUT,
   STAGE_REQUEST_4_OUTPUT,
+  STAGE_REQUEST_4_CACHED_INPUT,
   STAGE_REQUEST_SEGWIT_INPUT,
   STAGE_REQUEST_5_OUTPUT,
   STAGE_REQUEST_SEGWIT_WITNESS,
@@ -90,6 +91,22 @@ static uint8_t multisig_fp[32];
 static uint32_t in_address_n[8];
 static size_t in_address_n_count;
 static uint32_t tx_weight;
+static uint32_t batch_size;
+static uint32_t batch_pending;
+static uint32_t batch_discard;
+
+/* The size of the copy of the transaction kept in RAM for the legacy sighash
+   computation in phase 2. It is kept small because it is static RAM of the
+   whole firmware, larger transactions are streamed as before. 3 KiB hold
+   about 60 inputs with a few outputs. */
+#define TX_CACHE_SIZE (3 * 1024)
+/* An input serialized with an empty script, followed by its script type. */
+#define TX_CACHE_INPUT_SIZE (32 + 4 + 1 + 4 + 1)
+
+static uint8_t tx_cache[TX_CACHE_SIZE];
+static uint32_t tx_cache_used;
+static bool tx_cache_enabled;
+static TxStruct tx_prefix;
 
 /* A marker for in_address_n_count to indicate a mismatch in bip32 paths in
    input */
@@ -112,6 +129,11 @@ static uint32_t tx_weight;
 /* The maximum number of change-outputs allowed without user confirmation. */
 #define MAX_SILENT_CHANGE_COUNT 2
 
+/* The maximum number of items requested at once in batch mode. Each item
+   still arrives in its own TxAck and passes through msg_data, so the limit
+   only bounds the number of messages the host has in flight. */
+#define MAX_BATCH_SIZE 64
+
 enum {
   SIGHASH_ALL = 1,
   SIGHASH_FORKID = 0x40,
@@ -226,9 +248,51 @@ foreach I (idx1): // input to sign                            STAGE_REQUEST_DECR
     Sign (hash_type || decred_hash_prefix || hash_witness)
     Return witness
 
+Cached legacy inputs
+====================
+
+If all inputs serialized with an empty script and all compiled outputs fit
+into tx_cache, phase 1 keeps a copy of them and phase 2 does not stream the
+transaction again. For each non-segwit input it requests only that input
+(STAGE_REQUEST_4_CACHED_INPUT), checks it against its copy and hashes the
+rest of the transaction from tx_cache. The inputs before it are hashed once
+into tx_prefix, which is shared by all following signatures. The copy was
+written in phase 1 from the same data that hash_check and hash_outputs were
+computed from and it lives in RAM, which the host cannot reach. So the only
+host data to check is the requested input, the cached outputs are not hashed
+again.
+
+Batch mode
+==========
+
+If SignTx.batch_size is greater than one, the requests of the loops over the
+inputs and outputs of a previous transaction (STAGE_REQUEST_2_PREV_INPUT,
+STAGE_REQUEST_2_PREV_OUTPUT) and over the inputs and outputs of the
+transaction in phase 2 (STAGE_REQUEST_4_INPUT, STAGE_REQUEST_4_OUTPUT) cover
+up to batch_size consecutive items, given by details.request_count. The host
+sends a separate TxAck for every item of the range without waiting for a
+response and the device processes them exactly as in the unbatched mode, so
+it only skips the TxRequests for the items that have already been requested.
+These loops show no UI and return no serialized data, the other stages always
+request a single item.
+
 clang-format on
 */
 
+/* Requests the item at index of a batchable loop with count items. Returns
+   false if the item has already been requested as a part of a range. */
+static bool batch_request(uint32_t index, uint32_t count) {
+  if (batch_pending > 0) {
+    return false;
+  }
+  batch_pending = count - index < batch_size ? count - index : batch_size;
+  if (batch_pending > 1) {
+    resp.details.has_request_count = true;
+    resp.details.request_count = batch_pending;
+  }
+  return true;
+}
+
 void send_req_1_input(void) {
   signing_stage = STAGE_REQUEST_1_INPUT;
   resp.has_request_type = true;
@@ -253,6 +317,9 @@ void send_req_2_prev_meta(void) {
 
 void send_req_2_prev_input(void) {
   signing_stage = STAGE_REQUEST_2_PREV_INPUT;
+  if (!batch_request(idx2, tp.inputs_len)) {
+    return;
+  }
   resp.has_request_type = true;
   resp.request_type = RequestType_TXINPUT;
   resp.has_details = true;
@@ -267,6 +334,9 @@ void send_req_2_prev_input(void) {
 
 void send_req_2_prev_output(void) {
   signing_stage = STAGE_REQUEST_2_PREV_OUTPUT;
+  if (!batch_request(idx2, tp.outputs_len)) {
+    return;
+  }
   resp.has_request_type = true;
   resp.request_type = RequestType_TXOUTPUT;
   resp.has_details = true;
@@ -311,6 +381,9 @@ void send_req_3_output(void) {
 
 void send_req_4_input(void) {
   signing_stage = STAGE_REQUEST_4_INPUT;
+  if (!batch_request(idx2, inputs_count)) {
+    return;
+  }
   resp.has_request_type = true;
   resp.request_type = RequestType_TXINPUT;
   resp.has_details = true;
@@ -321,6 +394,9 @@ void send_req_4_input(void) {
 
 void send_req_4_output(void) {
   signing_stage = STAGE_REQUEST_4_OUTPUT;
+  if (!batch_request(idx2, outputs_count)) {
+    return;
+  }
   resp.has_request_type = true;
   resp.request_type = RequestType_TXOUTPUT;
   resp.has_details = true;
@@ -329,6 +405,16 @@ void send_req_4_output(void) {
   msg_write(MessageType_MessageType_TxRequest, &resp);
 }
 
+void send_req_4_cached_input(void) {
+  signing_stage = STAGE_REQUEST_4_CACHED_INPUT;
+  resp.has_request_type = true;
+  resp.request_type = RequestType_TXINPUT;
+  resp.has_details = true;
+  resp.details.has_request_index = true;
+  resp.details.request_index = idx1;
+  msg_write(MessageType_MessageType_TxRequest, &resp);
+}
+
 void send_req_segwit_input(void) {
   signing_stage = STAGE_REQUEST_SEGWIT_INPUT;
   resp.has_request_type = true;
@@ -397,8 +483,12 @@ void phase1_request_next_input(void) {
 
 void phase2_request_next_input(void) {
   if (idx1 == next_nonsegwit_input) {
-    idx2 = 0;
-    send_req_4_input();
+    if (tx_cache_enabled) {
+      send_req_4_cached_input();
+    } else {
+      idx2 = 0;
+      send_req_4_input();
+    }
   } else {
     send_req_segwit_input();
   }
@@ -565,6 +655,18 @@ void signing_init(const SignTx *msg, const CoinInfo *_coin,
   memzero(&input, sizeof(TxInputType));
   memzero(&resp, sizeof(TxRequest));
   signing = true;
+  batch_size = msg->has_batch_size ? msg->batch_size : 1;
+  if (batch_size < 1) {
+    batch_size = 1;
+  } else if (batch_size > MAX_BATCH_SIZE) {
+    batch_size = MAX_BATCH_SIZE;
+  }
+  batch_pending = 0;
+  batch_discard = 0;
+  tx_cache_used = 0;
+  tx_cache_enabled = !coin->decred && !coin->force_bip143 &&
+                     !coin->overwintered &&
+                     inputs_count <= TX_CACHE_SIZE / TX_CACHE_INPUT_SIZE;
   progress = 0;
   // we step by 500/inputs_count per input in phase1 and phase2
   // this means 50 % per phase.
@@ -579,6 +681,9 @@ void signing_init(const SignTx *msg, const CoinInfo *_coin,
   tx_init(&to, inputs_count, outputs_count, version, lock_time, expiry, 0,
           coin->curve->hasher_sign, coin->overwintered, version_group_id,
           timestamp);
+  tx_init(&tx_prefix, inputs_count, outputs_count, version, lock_time, expiry,
+          0, coin->curve->hasher_sign, coin->overwintered, version_group_id,
+          timestamp);
 
 #if !BITCOIN_ONLY
   if (coin->decred) {
@@ -760,6 +865,49 @@ static bool signing_validate_bin_output(TxOutputBinType *tx_bin_output) {
   return true;
 }
 
+// serializes txinput as in the legacy sighash of another input, i.e. with an
+// empty script, and appends its script type
+static void tx_cache_serialize_input(const TxInputType *txinput,
+                                     uint8_t *out) {
+  for (int i = 0; i < 32; i++) {
+    out[i] = txinput->prev_hash.bytes[31 - i];
+  }
+  memcpy(out + 32, &txinput->prev_index, 4);
+  out[36] = 0;  // empty script
+  memcpy(out + 37, &txinput->sequence, 4);
+  out[41] = txinput->script_type;
+}
+
+static void tx_cache_add_input(const TxInputType *txinput) {
+  if (!tx_cache_enabled) {
+    return;
+  }
+  // the space for all inputs has been checked in signing_init
+  tx_cache_serialize_input(txinput, tx_cache + tx_cache_used);
+  tx_cache_used += TX_CACHE_INPUT_SIZE;
+}
+
+// stores the serialized output prefixed by its length, or disables the cache
+// if it does not fit
+static void tx_cache_add_output(const TxOutputBinType *output) {
+  if (!tx_cache_enabled) {
+    return;
+  }
+  uint32_t len = 8 + ser_length_size(output->script_pubkey.size) +
+                 output->script_pubkey.size;
+  if (tx_cache_used + 2 + len > TX_CACHE_SIZE) {
+    tx_cache_enabled = false;
+    return;
+  }
+  uint8_t *out = tx_cache + tx_cache_used;
+  out[0] = len & 0xFF;
+  out[1] = len >> 8;
+  memcpy(out + 2, &output->amount, 8);
+  uint32_t r = 10 + ser_length(output->script_pubkey.size, out + 10);
+  memcpy(out + r, output->script_pubkey.bytes, output->script_pubkey.size);
+  tx_cache_used += 2 + len;
+}
+
 static bool signing_check_input(const TxInputType *txinput) {
   /* compute multisig fingerprint */
   /* (if all input share the same fingerprint, outputs having the same
@@ -806,6 +954,7 @@ static bool signing_check_input(const TxInputType *txinput) {
   tx_prevout_hash(&hasher_check, txinput);
   hasher_Update(&hasher_check, (const uint8_t *)&txinput->script_type,
                 sizeof(&txinput->script_type));
+  tx_cache_add_input(txinput);
   return true;
 }
 
@@ -900,6 +1049,7 @@ static bool signing_check_output(TxOutputType *txoutput) {
 #endif
   //  compute segwit hashOuts
   tx_output_hash(&hasher_outputs, &bin_output, coin->decred);
+  tx_cache_add_output(&bin_output);
   return true;
 }
 
@@ -1162,7 +1312,61 @@ static bool signing_sign_hash(TxInputType *txinput, const uint8_t *private_key,
   return true;
 }
 
-static bool signing_sign_input(void) {
+// hashes the legacy sighash of input idx1 into ti, taking everything but the
+// input itself from tx_cache
+static bool signing_hash_cached_input(TxInputType *txinput) {
+  uint8_t record[TX_CACHE_INPUT_SIZE] = {0};
+  tx_cache_serialize_input(txinput, record);
+  if (memcmp(record, tx_cache + idx1 * TX_CACHE_INPUT_SIZE,
+             TX_CACHE_INPUT_SIZE) != 0) {
+    fsm_sendFailure(FailureType_Failure_DataError,
+                    _("Transaction has changed during signing"));
+    signing_abort();
+    return false;
+  }
+  if (!compile_input_script_sig(txinput)) {
+    fsm_sendFailure(FailureType_Failure_ProcessError,
+                    _("Failed to compile input"));
+    signing_abort();
+    return false;
+  }
+  memcpy(&input, txinput, sizeof(input));
+  memcpy(privkey, node.private_key, 32);
+  memcpy(pubkey, node.public_key, 33);
+
+  // the inputs before idx1 are serialized the same way for all signatures
+  while (tx_prefix.have_inputs < idx1) {
+    tx_serialize_input_raw_hash(
+        &tx_prefix, tx_cache + tx_prefix.have_inputs * TX_CACHE_INPUT_SIZE,
+        TX_CACHE_INPUT_SIZE - 1);
+  }
+  memcpy(&ti, &tx_prefix, sizeof(TxStruct));
+  if (!tx_serialize_input_hash(&ti, txinput)) {
+    fsm_sendFailure(FailureType_Failure_ProcessError,
+                    _("Failed to serialize input"));
+    signing_abort();
+    return false;
+  }
+  for (uint32_t i = idx1 + 1; i < inputs_count; i++) {
+    const uint8_t *cached = tx_cache + i * TX_CACHE_INPUT_SIZE;
+    tx_serialize_input_raw_hash(&ti, cached, TX_CACHE_INPUT_SIZE - 1);
+    if (next_nonsegwit_input == idx1 &&
+        (cached[TX_CACHE_INPUT_SIZE - 1] == InputScriptType_SPENDADDRESS ||
+         cached[TX_CACHE_INPUT_SIZE - 1] == InputScriptType_SPENDMULTISIG)) {
+      next_nonsegwit_input = i;
+    }
+  }
+  uint32_t offset = inputs_count * TX_CACHE_INPUT_SIZE;
+  while (offset < tx_cache_used) {
+    uint32_t len = tx_cache[offset] | (tx_cache[offset + 1] << 8);
+    tx_serialize_output_raw_hash(&ti, tx_cache + offset + 2, len);
+    offset += 2 + len;
+  }
+  return true;
+}
+
+// checks the outputs streamed in phase 2 against hash_outputs
+static bool signing_check_outputs(void) {
   uint8_t hash[32] = {0};
   hasher_Final(&hasher_check, hash);
   if (memcmp(hash, hash_outputs, 32) != 0) {
@@ -1171,7 +1375,11 @@ static bool signing_sign_input(void) {
     signing_abort();
     return false;
   }
+  return true;
+}
 
+static bool signing_sign_input(void) {
+  uint8_t hash[32] = {0};
   uint32_t hash_type = signing_hash_type();
   hasher_Update(&ti.hasher, (const uint8_t *)&hash_type, 4);
   tx_hash_final(&ti, hash, false);
@@ -1279,6 +1487,11 @@ static bool signing_sign_decred_input(TxInputType *txinput) {
 
 void signing_txack(TransactionType *tx) {
   if (!signing) {
+    // the rest of a range the host sent before it saw the failure
+    if (batch_discard > 0) {
+      batch_discard--;
+      return;
+    }
     fsm_sendFailure(FailureType_Failure_UnexpectedMessage,
                     _("Not in Signing mode"));
     layoutHome();
@@ -1291,6 +1504,10 @@ void signing_txack(TransactionType *tx) {
     update_ctr = 0;
   }
 
+  if (batch_pending > 0) {
+    batch_pending--;
+  }
+
   memzero(&resp, sizeof(TxRequest));
 
   switch (signing_stage) {
@@ -1680,7 +1897,7 @@ void signing_txack(TransactionType *tx) {
         idx2++;
         send_req_4_output();
       } else {
-        if (!signing_sign_input()) {
+        if (!signing_check_outputs() || !signing_sign_input()) {
           return;
         }
         // since this took a longer time, update progress
@@ -1698,6 +1915,25 @@ void signing_txack(TransactionType *tx) {
       }
       return;
 
+    case STAGE_REQUEST_4_CACHED_INPUT:
+      if (!signing_validate_input(&tx->inputs[0]) ||
+          !signing_hash_cached_input(&tx->inputs[0]) ||
+          !signing_sign_input()) {
+        return;
+      }
+      signatures++;
+      progress = 500 + ((signatures * progress_step) >> PROGRESS_PRECISION);
+      layoutProgress_zh(ui_prompt_sign_trans[ui_language], progress);
+      update_ctr = 0;
+      if (idx1 < inputs_count - 1) {
+        idx1++;
+        phase2_request_next_input();
+      } else {
+        idx1 = 0;
+        send_req_5_output();
+      }
+      return;
+
     case STAGE_REQUEST_SEGWIT_INPUT:
       if (!signing_validate_input(&tx->inputs[0])) {
         return;
@@ -1920,7 +2156,9 @@ void signing_abort(void) {
   if (signing) {
     layoutHome();
     signing = false;
+    batch_discard = batch_pending;
   }
+  batch_pending = 0;
   memzero(&root, sizeof(root));
   memzero(&node, sizeof(node));
 }
@@ -806,6 +806,51 @@ uint32_t tx_serialize_output_hash(TxStruct *tx, const TxOutputBinType *output) {
   return r;
 }
 
+// hashes an input or output that has already been serialized, e.g. by
+// tx_serialize_input() without the header
+uint32_t tx_serialize_input_raw_hash(TxStruct *tx, const uint8_t *data,
+                                     uint32_t len) {
+  if (tx->have_inputs >= tx->inputs_len) {
+    // already got all inputs
+    return 0;
+  }
+  uint32_t r = 0;
+  if (tx->have_inputs == 0) {
+    r += tx_serialize_header_hash(tx);
+  }
+  hasher_Update(&(tx->hasher), data, len);
+  r += len;
+
+  tx->have_inputs++;
+  tx->size += r;
+
+  return r;
+}
+
+uint32_t tx_serialize_output_raw_hash(TxStruct *tx, const uint8_t *data,
+                                      uint32_t len) {
+  if (tx->have_inputs < tx->inputs_len) {
+    // not all inputs provided
+    return 0;
+  }
+  if (tx->have_outputs >= tx->outputs_len) {
+    // already got all outputs
+    return 0;
+  }
+  uint32_t r = 0;
+  if (tx->have_outputs == 0) {
+    r += tx_serialize_middle_hash(tx);
+  }
+  hasher_Update(&(tx->hasher), data, len);
+  r += len;
+  tx->have_outputs++;
+  if (tx->have_outputs == tx->outputs_len && !tx->is_segwit) {
+    r += tx_serialize_footer_hash(tx);
+  }
+  tx->size += r;
+  return r;
+}
+
 #if !BITCOIN_ONLY
 uint32_t tx_serialize_extra_data_hash(TxStruct *tx, const uint8_t *data,
                                       uint32_t datalen) {
@@ -106,6 +106,10 @@ void tx_init(TxStruct *tx, uint32_t inputs_len, uint32_t outputs_len,
 uint32_t tx_serialize_header_hash(TxStruct *tx);
 uint32_t tx_serialize_input_hash(TxStruct *tx, const TxInputType *input);
 uint32_t tx_serialize_output_hash(TxStruct *tx, const TxOutputBinType *output);
+uint32_t tx_serialize_input_raw_hash(TxStruct *tx, const uint8_t *data,
+                                     uint32_t len);
+uint32_t tx_serialize_output_raw_hash(TxStruct *tx, const uint8_t *data,
+                                      uint32_t len);
 uint32_t tx_serialize_extra_data_hash(TxStruct *tx, const uint8_t *data,
                                       uint32_t datalen);
 uint32_t tx_serialize_decred_witness_hash(TxStruct *tx,
@@ -27,6 +27,7 @@
 #include "layout.h"
 #include "layout2.h"
 #include "memzero.h"
+#include "messages.h"
 #include "oled.h"
 #include "rng.h"
 #include "setup.h"
@@ -93,6 +94,24 @@ void check_lock_screen(void) {
   }
 }
 
+/* Storage compaction may erase a flash sector, which blocks for a while. It
+   runs only on the home screen, after the host has been quiet for
+   STORAGE_IDLE_QUIET_MS, and at most every STORAGE_IDLE_INTERVAL_MS. */
+#define STORAGE_IDLE_QUIET_MS 2000
+#define STORAGE_IDLE_INTERVAL_MS 200
+
+static void storage_idle_check(void) {
+  static uint32_t last_idle = 0;
+  uint32_t now = timer_ms();
+  if (layoutLast != layoutHome ||
+      now - msg_last_read_ms < STORAGE_IDLE_QUIET_MS ||
+      now - last_idle < STORAGE_IDLE_INTERVAL_MS) {
+    return;
+  }
+  last_idle = now;
+  config_idle();
+}
+
 static void collect_hw_entropy(bool privileged) {
 #if EMULATOR
   (void)privileged;
@@ -162,6 +181,7 @@ int main(void) {
   for (;;) {
     usbPoll();
     layoutHomeInfo();
+    storage_idle_check();
   }
   return 0;
 }
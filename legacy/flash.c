@@ -128,3 +128,59 @@ secbool flash_write_word(uint8_t sector, uint32_t offset, uint32_t data) {
 
   return sectrue;
 }
+
+secbool flash_write_block(uint8_t sector, uint32_t offset, const uint8_t *data,
+                          uint32_t len) {
+  uint8_t *address = (uint8_t *)flash_get_address(sector, offset, len);
+  if (address == NULL) {
+    return secfalse;
+  }
+
+  for (uint32_t i = 0; i < len; i++) {
+    if ((address[i] & data[i]) != data[i]) {
+      return secfalse;
+    }
+  }
+
+  // The program size is set once for each part of the block, the read back
+  // of every write waits for the flash to finish programming.
+  uint32_t i = 0;
+  uint32_t head = (4 - (uintptr_t)address % 4) % 4;
+  if (head > len) {
+    head = len;
+  }
+  if (head > 0) {
+    svc_flash_program(FLASH_CR_PROGRAM_X8);
+    for (; i < head; i++) {
+      *(volatile uint8_t *)(address + i) = data[i];
+      if (address[i] != data[i]) {
+        return secfalse;
+      }
+    }
+  }
+  if (i + 4 <= len) {
+    svc_flash_program(FLASH_CR_PROGRAM_X32);
+    for (; i + 4 <= len; i += 4) {
+      uint32_t word = 0;
+      memcpy(&word, data + i, sizeof(word));
+      if (*(const uint32_t *)(address + i) == word) {
+        continue;
+      }
+      *(volatile uint32_t *)(address + i) = word;
+      if (*(const uint32_t *)(address + i) != word) {
+        return secfalse;
+      }
+    }
+  }
+  if (i < len) {
+    svc_flash_program(FLASH_CR_PROGRAM_X8);
+    for (; i < len; i++) {
+      *(volatile uint8_t *)(address + i) = data[i];
+      if (address[i] != data[i]) {
+        return secfalse;
+      }
+    }
+  }
+
+  return sectrue;
+}
@@ -33,6 +33,12 @@
  */
 #define NORCOW_HEADER_LEN (0)
 
+/*
+ * The maximum number of keys in the RAM index of the norcow sector, every
+ * entry takes 4 bytes of RAM.
+ */
+#define NORCOW_INDEX_SIZE 128
+
 /*
  * Current storage version.
  */
@@ -48,6 +48,11 @@
 #define OLED_COMSCANDEC 0xC8
 #define OLED_SEGREMAP 0xA0
 #define OLED_CHARGEPUMP 0x8D
+#define OLED_COLUMNADDR 0x21
+#define OLED_PAGEADDR 0x22
+
+// the command selecting the columns and the page of a refreshed range
+#define OLED_WINDOW_LEN 6
 
 /* Trezor has a display of size OLED_WIDTH x OLED_HEIGHT (128x64).
  * The contents of this display are buffered in _oledbuffer.  This is
@@ -61,12 +66,56 @@ static uint8_t _oledbuffer[OLED_BUFSIZE];
 static uint8_t _oledbuffer_bak[OLED_BUFSIZE];
 static bool is_debug_link = 0;
 
+/*
+ * Columns [start, end) of every page of _oledbuffer that changed since the
+ * last refresh, the page is clean when start >= end. A page is a row of
+ * OLED_WIDTH bytes in the buffer and in the display RAM.
+ */
+static struct {
+  uint8_t start, end;
+} oled_dirty[OLED_HEIGHT / 8];
+static uint32_t oled_refresh_bytes = 0;
+
 /*
  * macros to convert coordinate to bit position
  */
 #define OLED_OFFSET(x, y) (OLED_BUFSIZE - 1 - (x) - ((y) / 8) * OLED_WIDTH)
 #define OLED_MASK(x, y) (1 << (7 - (y) % 8))
 
+/*
+ * Marks the bytes offset1 to offset2 (inclusive) of the buffer as changed
+ */
+static inline void oledMarkDirty(int offset1, int offset2) {
+  for (int page = offset1 / OLED_WIDTH; page <= offset2 / OLED_WIDTH; page++) {
+    const int start = MAX(offset1 - page * OLED_WIDTH, 0);
+    const int end = MIN(offset2 - page * OLED_WIDTH, OLED_WIDTH - 1) + 1;
+    if (oled_dirty[page].start >= oled_dirty[page].end) {
+      oled_dirty[page].start = start;
+      oled_dirty[page].end = end;
+    } else {
+      oled_dirty[page].start = MIN(oled_dirty[page].start, start);
+      oled_dirty[page].end = MAX(oled_dirty[page].end, end);
+    }
+  }
+}
+
+/*
+ * Marks the whole buffer as sent to the display and counts the bytes the
+ * refresh of the changed pages took
+ */
+void oledClearDirty(void) {
+  oled_refresh_bytes = 0;
+  for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+    if (oled_dirty[page].start < oled_dirty[page].end) {
+      oled_refresh_bytes +=
+          OLED_WINDOW_LEN + oled_dirty[page].end - oled_dirty[page].start;
+    }
+    oled_dirty[page].start = oled_dirty[page].end = 0;
+  }
+}
+
+uint32_t oledRefreshBytes(void) { return oled_refresh_bytes; }
+
 /*
  * Return the state of the pixel at x, y
  */
@@ -82,6 +131,7 @@ void oledDrawPixel(int x, int y) {
     return;
   }
   _oledbuffer[OLED_OFFSET(x, y)] |= OLED_MASK(x, y);
+  oledMarkDirty(OLED_OFFSET(x, y), OLED_OFFSET(x, y));
 }
 
 /*
@@ -92,6 +142,7 @@ void oledClearPixel(int x, int y) {
     return;
   }
   _oledbuffer[OLED_OFFSET(x, y)] &= ~OLED_MASK(x, y);
+  oledMarkDirty(OLED_OFFSET(x, y), OLED_OFFSET(x, y));
 }
 
 /*
@@ -102,6 +153,7 @@ void oledInvertPixel(int x, int y) {
     return;
   }
   _oledbuffer[OLED_OFFSET(x, y)] ^= OLED_MASK(x, y);
+  oledMarkDirty(OLED_OFFSET(x, y), OLED_OFFSET(x, y));
 }
 
 #if !EMULATOR
@@ -172,11 +224,15 @@ void oledInit() {
 /*
  * Clears the display buffer (sets all pixels to black)
  */
-void oledClear() { memzero(_oledbuffer, sizeof(_oledbuffer)); }
+void oledClear() {
+  memzero(_oledbuffer, sizeof(_oledbuffer));
+  oledMarkDirty(0, OLED_BUFSIZE - 1);
+}
 
 void oledClearPart() {
   // do not clear logo status,logo line 12
   memzero(_oledbuffer, sizeof(_oledbuffer) - (OLED_WIDTH * (LOGO_HEIGHT / 8)));
+  oledMarkDirty(0, OLED_BUFSIZE - (OLED_WIDTH * (LOGO_HEIGHT / 8)) - 1);
 }
 
 void oledInvertDebugLink() {
@@ -203,14 +259,11 @@ void oledInvertDebugLink() {
  * Refresh the display. This copies the buffer to the display to show the
  * contents.  This must be called after every operation to the buffer to
  * make the change visible.  All other operations only change the buffer
- * not the content of the display.
+ * not the content of the display.  Only the columns of the pages that
+ * changed since the last refresh are sent.
  */
 #if !EMULATOR
 void oledRefresh() {
-  static const uint8_t s[3] = {OLED_SETLOWCOLUMN | 0x00,
-                               OLED_SETHIGHCOLUMN | 0x00,
-                               OLED_SETSTARTLINE | 0x00};
-
   static bool refreshing = false;
 
   if (refreshing == true) return;
@@ -219,15 +272,25 @@ void oledRefresh() {
   // draw triangle in upper right corner
   oledInvertDebugLink();
 
-  gpio_clear(OLED_CS_PORT, OLED_CS_PIN);  // SPI select
-  SPISend(SPI_BASE, s, 3);
-  gpio_set(OLED_CS_PORT, OLED_CS_PIN);  // SPI deselect
-
-  gpio_set(OLED_DC_PORT, OLED_DC_PIN);    // set to DATA
-  gpio_clear(OLED_CS_PORT, OLED_CS_PIN);  // SPI select
-  SPISend(SPI_BASE, _oledbuffer, sizeof(_oledbuffer));
-  gpio_set(OLED_CS_PORT, OLED_CS_PIN);    // SPI deselect
-  gpio_clear(OLED_DC_PORT, OLED_DC_PIN);  // set to CMD
+  for (int page = 0; page < OLED_HEIGHT / 8; page++) {
+    const uint8_t start = oled_dirty[page].start, end = oled_dirty[page].end;
+    if (start >= end) {
+      continue;
+    }
+    const uint8_t s[OLED_WINDOW_LEN] = {
+        OLED_COLUMNADDR, start, end - 1, OLED_PAGEADDR, page, page};
+
+    gpio_clear(OLED_CS_PORT, OLED_CS_PIN);  // SPI select
+    SPISend(SPI_BASE, s, OLED_WINDOW_LEN);
+    gpio_set(OLED_CS_PORT, OLED_CS_PIN);  // SPI deselect
+
+    gpio_set(OLED_DC_PORT, OLED_DC_PIN);    // set to DATA
+    gpio_clear(OLED_CS_PORT, OLED_CS_PIN);  // SPI select
+    SPISend(SPI_BASE, _oledbuffer + page * OLED_WIDTH + start, end - start);
+    gpio_set(OLED_CS_PORT, OLED_CS_PIN);    // SPI deselect
+    gpio_clear(OLED_DC_PORT, OLED_DC_PIN);  // set to CMD
+  }
+  oledClearDirty();
 
   refreshing = false;
   // return it back
@@ -246,16 +309,20 @@ void oledSetDebugLink(bool set) {
 void oledBufferBak(void) { memcpy(_oledbuffer_bak, _oledbuffer, OLED_BUFSIZE); }
 void oledBufferResume(void) {
   memcpy(_oledbuffer, _oledbuffer_bak, OLED_BUFSIZE);
+  oledMarkDirty(0, OLED_BUFSIZE - 1);
 }
 
 void oledSetBuffer(uint8_t *buf, uint16_t usLen) {
+  if (usLen == 0) return;
   memcpy(_oledbuffer, buf, usLen);
+  oledMarkDirty(0, usLen - 1);
 }
 
 void oledclearLine(uint8_t line) {
   if (line < (OLED_HEIGHT / 8)) {
-    memzero(_oledbuffer + OLED_WIDTH * (OLED_HEIGHT / 8 - line - 1),
-            OLED_WIDTH);
+    const int offset = OLED_WIDTH * (OLED_HEIGHT / 8 - line - 1);
+    memzero(_oledbuffer + offset, OLED_WIDTH);
+    oledMarkDirty(offset, offset + OLED_WIDTH - 1);
   }
 }
 
@@ -448,6 +515,7 @@ void oledSwipeLeft(void) {
       }
       _oledbuffer[j * OLED_WIDTH] = 0;
     }
+    oledMarkDirty(0, OLED_BUFSIZE - 1);
     oledRefresh();
   }
 }
@@ -474,6 +542,7 @@ void oledSwipeRight(void) {
       _oledbuffer[j * OLED_WIDTH + OLED_WIDTH - 3] = 0;
       _oledbuffer[j * OLED_WIDTH + OLED_WIDTH - 4] = 0;
     }
+    oledMarkDirty(0, OLED_BUFSIZE - 1);
     oledRefresh();
   }
 }
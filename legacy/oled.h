@@ -55,6 +55,8 @@ void oledClear(void);
 void oledClearPart(void);
 
 void oledRefresh(void);
+void oledClearDirty(void);
+uint32_t oledRefreshBytes(void);
 
 void oledSetDebugLink(bool set);
 void oledInvertDebugLink(void);
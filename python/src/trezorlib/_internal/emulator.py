@@ -16,6 +16,7 @@
 
 import logging
 import os
+import select
 import subprocess
 import time
 from pathlib import Path
@@ -47,6 +48,8 @@ class Emulator:
         storage=None,
         headless=False,
         debug=True,
+        port=None,
+        flash_template=None,
         extra_args=()
     ):
         self.executable = Path(executable).resolve()
@@ -74,8 +77,14 @@ class Emulator:
 
         self.client = None
         self.process = None
-
-        self.port = 21324
+        self.ready_pipe = None
+        self.startup_time = None
+
+        # port 0 lets the emulator pick free ports and report them when ready
+        self.auto_port = port == 0
+        self.port = 21324 if port is None else port
+        # shared flash image mapped copy-on-write, the storage is not persisted
+        self.flash_template = flash_template
         self.headless = headless
         self.debug = debug
         self.extra_args = list(extra_args)
@@ -84,12 +93,28 @@ class Emulator:
         return []
 
     def make_env(self):
-        return os.environ.copy()
+        env = os.environ.copy()
+        if self.flash_template:
+            env["TREZOR_FLASH_TEMPLATE"] = str(Path(self.flash_template).resolve())
+        return env
 
     def _get_transport(self):
         return UdpTransport("127.0.0.1:{}".format(self.port))
 
+    def _read_ready_port(self, timeout):
+        with os.fdopen(self.ready_pipe) as f:
+            self.ready_pipe = None
+            readable, _, _ = select.select([f], [], [], timeout)
+            if not readable:
+                raise TimeoutError("Can't connect to emulator")
+            line = f.readline()
+        if not line:
+            raise RuntimeError("Emulator proces died")
+        self.port = int(line)
+
     def wait_until_ready(self, timeout=EMULATOR_WAIT_TIME):
+        if self.ready_pipe is not None:
+            self._read_ready_port(timeout)
         transport = self._get_transport()
         transport.open()
         LOG.info("Waiting for emulator to come up...")
@@ -118,21 +143,33 @@ class Emulator:
         return ret
 
     def launch_process(self):
+        if self.auto_port:
+            self.port = 0
         args = self.make_args()
         env = self.make_env()
+        pass_fds = ()
+        if self.auto_port:
+            self.ready_pipe, ready_w = os.pipe()
+            env["TREZOR_READY_FD"] = str(ready_w)
+            pass_fds = (ready_w,)
 
         if hasattr(self.logfile, "write"):
             output = self.logfile
         else:
             output = open(self.logfile, "w")
 
-        return subprocess.Popen(
-            [self.executable] + args + self.extra_args,
-            cwd=self.workdir,
-            stdout=output,
-            stderr=subprocess.STDOUT,
-            env=env,
-        )
+        try:
+            return subprocess.Popen(
+                [self.executable] + args + self.extra_args,
+                cwd=self.workdir,
+                stdout=output,
+                stderr=subprocess.STDOUT,
+                env=env,
+                pass_fds=pass_fds,
+            )
+        finally:
+            for fd in pass_fds:
+                os.close(fd)
 
     def start(self):
         if self.process:
@@ -144,6 +181,7 @@ class Emulator:
                 # process is running, no need to start again
                 return
 
+        start = time.monotonic()
         self.process = self.launch_process()
         try:
             self.wait_until_ready()
@@ -154,6 +192,7 @@ class Emulator:
             )
             self.process.kill()
             raise
+        self.startup_time = time.monotonic() - start
 
         (self.profile_dir / "trezor.pid").write_text(str(self.process.pid) + "\n")
         (self.profile_dir / "trezor.port").write_text(str(self.port) + "\n")
@@ -180,6 +219,10 @@ class Emulator:
                 LOG.info("Emulator seems stuck. Sending kill signal.")
                 self.process.kill()
 
+        if self.ready_pipe is not None:
+            os.close(self.ready_pipe)
+            self.ready_pipe = None
+
         _rm_f(self.profile_dir / "trezor.pid")
         _rm_f(self.profile_dir / "trezor.port")
         self.process = None
@@ -204,7 +247,6 @@ class CoreEmulator(Emulator):
     def __init__(
         self,
         *args,
-        port=None,
         main_args=("-m", "main"),
         workdir=None,
         sdcard=None,
@@ -220,8 +262,6 @@ class CoreEmulator(Emulator):
         if sdcard is not None:
             self.sdcard.write_bytes(sdcard)
 
-        if port:
-            self.port = port
         self.disable_animation = disable_animation
         self.main_args = list(main_args)
         self.heap_size = heap_size
@@ -255,6 +295,7 @@ class LegacyEmulator(Emulator):
 
     def make_env(self):
         env = super().make_env()
+        env["TREZOR_UDP_PORT"] = str(self.port)
         if self.headless:
             env["SDL_VIDEODRIVER"] = "dummy"
         return env
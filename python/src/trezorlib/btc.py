@@ -198,6 +198,12 @@ def sign_tx(client, coin_name, inputs, outputs, details=None, prev_txes=None):
         tx_copy.extra_data = None
         return tx_copy
 
+    def request_range(details):
+        # With SignTx.batch_size set, the device may request several
+        # consecutive items at once. Each of them is sent in its own TxAck.
+        count = details.request_count or 1
+        return range(details.request_index, details.request_index + count)
+
     R = messages.RequestType
     while isinstance(res, messages.TxRequest):
         # If there's some part of signed transaction, let's add it
@@ -226,18 +232,23 @@ def sign_tx(client, coin_name, inputs, outputs, details=None, prev_txes=None):
             res = client.call(messages.TxAck(tx=msg))
 
         elif res.request_type == R.TXINPUT:
-            msg = messages.TransactionType()
-            msg.inputs = [current_tx.inputs[res.details.request_index]]
-            res = client.call(messages.TxAck(tx=msg))
+            acks = []
+            for i in request_range(res.details):
+                msg = messages.TransactionType()
+                msg.inputs = [current_tx.inputs[i]]
+                acks.append(messages.TxAck(tx=msg))
+            res = client.call_batch(acks)
 
         elif res.request_type == R.TXOUTPUT:
-            msg = messages.TransactionType()
-            if res.details.tx_hash:
-                msg.bin_outputs = [current_tx.bin_outputs[res.details.request_index]]
-            else:
-                msg.outputs = [current_tx.outputs[res.details.request_index]]
-
-            res = client.call(messages.TxAck(tx=msg))
+            acks = []
+            for i in request_range(res.details):
+                msg = messages.TransactionType()
+                if res.details.tx_hash:
+                    msg.bin_outputs = [current_tx.bin_outputs[i]]
+                else:
+                    msg.outputs = [current_tx.outputs[i]]
+                acks.append(messages.TxAck(tx=msg))
+            res = client.call_batch(acks)
 
         elif res.request_type == R.TXEXTRADATA:
             o, l = res.details.extra_data_offset, res.details.extra_data_len
@@ -168,6 +168,9 @@ def get_public_node(client, address, show_display):
 @click.option("-p", "--publish", is_flag=True, help="Publish transaction via RPC")
 @click.option("-x", "--tx-type", type=int, help="TX type (used only for Wanchain)")
 @click.option("-t", "--token", help="ERC20 token address")
+@click.option(
+    "--chunk-window", type=int, help="Number of data chunks sent without waiting"
+)
 @click.option(
     "--list-units",
     is_flag=True,
@@ -192,6 +195,7 @@ def sign_tx(
     to_address,
     tx_type,
     token,
+    chunk_window,
 ):
     """Sign (and optionally publish) Ethereum transaction.
 
@@ -273,6 +277,7 @@ def sign_tx(
         value=amount,
         data=data,
         chain_id=chain_id,
+        chunk_window=chunk_window,
     )
 
     to = _decode_hex(to_address)
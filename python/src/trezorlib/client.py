@@ -208,6 +208,17 @@ class TrezorClient:
         self.ui.button_request(msg.code)
         return self._raw_read()
 
+    @tools.session
+    def call_batch(self, msgs):
+        """Send several messages and return the response to the last one.
+
+        The device must not respond to the other messages, i.e. it must have
+        requested all of them at once.
+        """
+        for msg in msgs[:-1]:
+            self._raw_write(msg)
+        return self.call(msgs[-1])
+
     @tools.session
     def call(self, msg):
         self.check_firmware_version()
@@ -51,6 +51,7 @@ def sign_tx(
     data=None,
     chain_id=None,
     tx_type=None,
+    chunk_window=None,
 ):
     msg = messages.EthereumSignTx(
         address_n=n,
@@ -61,6 +62,7 @@ def sign_tx(
         to=to,
         chain_id=chain_id,
         tx_type=tx_type,
+        chunk_window=chunk_window,
     )
 
     if data:
@@ -71,9 +73,13 @@ def sign_tx(
     response = client.call(msg)
 
     while response.data_length is not None:
+        # with chunk_window set, the device may request several chunks at once
         data_length = response.data_length
-        data, chunk = data[data_length:], data[:data_length]
-        response = client.call(messages.EthereumTxAck(data_chunk=chunk))
+        acks = []
+        for _ in range(response.chunk_count or 1):
+            data, chunk = data[data_length:], data[:data_length]
+            acks.append(messages.EthereumTxAck(data_chunk=chunk))
+        response = client.call_batch(acks)
 
     # https://github.com/trezor/trezor-core/pull/311
     # only signature bit returned. recalculate signature_v
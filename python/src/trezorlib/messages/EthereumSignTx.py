@@ -25,6 +25,7 @@ class EthereumSignTx(p.MessageType):
         data_length: int = None,
         chain_id: int = None,
         tx_type: int = None,
+        chunk_window: int = None,
     ) -> None:
         self.address_n = address_n if address_n is not None else []
         self.nonce = nonce
@@ -36,6 +37,7 @@ class EthereumSignTx(p.MessageType):
         self.data_length = data_length
         self.chain_id = chain_id
         self.tx_type = tx_type
+        self.chunk_window = chunk_window
 
     @classmethod
     def get_fields(cls) -> Dict:
@@ -50,4 +52,5 @@ class EthereumSignTx(p.MessageType):
             8: ('data_length', p.UVarintType, 0),
             9: ('chain_id', p.UVarintType, 0),
             10: ('tx_type', p.UVarintType, 0),
+            12: ('chunk_window', p.UVarintType, 0),
         }
@@ -57,6 +57,58 @@ static uint32_t norcow_active_version = 0;
 // The offset of the first free item in the writing sector.
 static uint32_t norcow_free_offset = 0;
 
+// The number of bytes taken by deleted items in the writing sector.
+static uint32_t norcow_garbage = 0;
+
+// The number of items in the writing sector which are shadowed by a newer
+// instance of the same key written by norcow_append(). If the index overflowed
+// while the sector was scanned, it is an upper bound.
+static uint32_t norcow_shadowed = 0;
+
+// The state of the incremental compaction.
+typedef enum {
+  COMPACT_NONE = 0,  // no compaction is in progress
+  COMPACT_ERASE,     // the compaction sector has to be erased
+  COMPACT_COPY,      // items are being copied to the compaction sector
+} norcow_compact_state;
+
+// The compaction sector receives the live items of the writing sector. It
+// gets its magic only after all items have been copied, so until then an
+// interrupted compaction leaves the writing sector as the only valid one.
+static norcow_compact_state norcow_compact = COMPACT_NONE;
+static uint8_t norcow_compact_sector = 0;
+// The offset of the next item to be copied from the writing sector.
+static uint32_t norcow_compact_offsetr = 0;
+// The offset of the first free item in the compaction sector.
+static uint32_t norcow_compact_offsetw = 0;
+
+// The maximum number of keys in the RAM index of the writing sector. If the
+// sector contains more keys, lookups fall back to scanning the sector. Setting
+// it to 0 disables the index.
+#ifndef NORCOW_INDEX_SIZE
+#define NORCOW_INDEX_SIZE 128
+#endif
+
+#if NORCOW_INDEX_SIZE > 0
+
+#if NORCOW_SECTOR_SIZE > 4 * 0x10000
+#error The norcow index cannot address sectors larger than 256 KiB
+#endif
+
+// An entry of the index, the offset is stored in words, because item values
+// always start at a word boundary.
+typedef struct {
+  uint16_t key;
+  uint16_t offset_words;
+} norcow_index_entry;
+
+// Entries of the writing sector sorted by key, deleted items are excluded.
+static norcow_index_entry norcow_index[NORCOW_INDEX_SIZE];
+static uint16_t norcow_index_count = 0;
+static secbool norcow_index_valid = secfalse;
+
+#endif
+
 /*
  * Returns pointer to sector, starting with offset
  * Fails when there is not enough space for data of given size
@@ -86,17 +138,23 @@ static secbool norcow_write(uint8_t sector, uint32_t offset, uint32_t prefix,
   offset += NORCOW_PREFIX_LEN;
 
   if (data != NULL) {
-    // write data
-    for (uint16_t i = 0; i < len; i++, offset++) {
-      ensure(flash_write_byte(norcow_sectors[sector], offset, data[i]), NULL);
+    // write data, the last incomplete word is padded with zeroes
+    const uint16_t aligned = len - len % NORCOW_WORD_SIZE;
+    ensure(flash_write_block(norcow_sectors[sector], offset, data, aligned),
+           NULL);
+    offset += aligned;
+    if (aligned < len) {
+      uint32_t last = 0;
+      memcpy(&last, data + aligned, len - aligned);
+      ensure(flash_write_word(norcow_sectors[sector], offset, last), NULL);
     }
   } else {
     offset += len;
-  }
 
-  // pad with zeroes
-  for (; offset % NORCOW_WORD_SIZE; offset++) {
-    ensure(flash_write_byte(norcow_sectors[sector], offset, 0x00), NULL);
+    // pad with zeroes
+    for (; offset % NORCOW_WORD_SIZE; offset++) {
+      ensure(flash_write_byte(norcow_sectors[sector], offset, 0x00), NULL);
+    }
   }
 
   ensure(flash_lock_write(), NULL);
@@ -119,11 +177,9 @@ static void erase_sector(uint8_t sector, secbool set_magic) {
 #if NORCOW_HEADER_LEN > 0
   // Copy the sector header back.
   ensure(flash_unlock_write(), NULL);
-  for (uint32_t i = 0; i < NORCOW_HEADER_LEN / sizeof(uint32_t); ++i) {
-    ensure(flash_write_word(norcow_sectors[sector], i * sizeof(uint32_t),
-                            header_backup[i]),
-           NULL);
-  }
+  ensure(flash_write_block(norcow_sectors[sector], 0,
+                           (const uint8_t *)header_backup, NORCOW_HEADER_LEN),
+         NULL);
   ensure(flash_lock_write(), NULL);
 #endif
 
@@ -176,6 +232,97 @@ static secbool write_item(uint8_t sector, uint32_t offset, uint16_t key,
   return norcow_write(sector, offset, prefix, val, len);
 }
 
+#if NORCOW_INDEX_SIZE > 0
+
+/*
+ * Returns the position of key in the index, or the position where it would
+ * have to be inserted
+ */
+static uint16_t index_position(uint16_t key) {
+  uint16_t lo = 0, hi = norcow_index_count;
+  while (lo < hi) {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (norcow_index[mid].key < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/*
+ * Records that the value of key starts at offset in the writing sector
+ */
+static void index_set(uint16_t key, uint32_t offset) {
+  if (sectrue != norcow_index_valid || key == NORCOW_KEY_DELETED) {
+    return;
+  }
+  uint16_t i = index_position(key);
+  if (i >= norcow_index_count || norcow_index[i].key != key) {
+    if (norcow_index_count >= NORCOW_INDEX_SIZE) {
+      // Too many keys, fall back to scanning until the index is rebuilt.
+      norcow_index_valid = secfalse;
+      return;
+    }
+    memmove(&norcow_index[i + 1], &norcow_index[i],
+            (norcow_index_count - i) * sizeof(norcow_index_entry));
+    norcow_index_count++;
+    norcow_index[i].key = key;
+  }
+  norcow_index[i].offset_words = offset / NORCOW_WORD_SIZE;
+}
+
+/*
+ * Removes key from the index
+ */
+static void index_delete(uint16_t key) {
+  if (sectrue != norcow_index_valid) {
+    return;
+  }
+  uint16_t i = index_position(key);
+  if (i < norcow_index_count && norcow_index[i].key == key) {
+    norcow_index_count--;
+    memmove(&norcow_index[i], &norcow_index[i + 1],
+            (norcow_index_count - i) * sizeof(norcow_index_entry));
+  }
+}
+
+static void index_clear(void) {
+  norcow_index_count = 0;
+  norcow_index_valid = sectrue;
+}
+
+static secbool index_is_valid(void) { return norcow_index_valid; }
+
+/*
+ * Returns sectrue if key is in the index, only meaningful if it is valid
+ */
+static secbool index_has(uint16_t key) {
+  uint16_t i = index_position(key);
+  return sectrue * (i < norcow_index_count && norcow_index[i].key == key);
+}
+
+#else
+
+static void index_set(uint16_t key, uint32_t offset) {
+  (void)key;
+  (void)offset;
+}
+
+static void index_delete(uint16_t key) { (void)key; }
+
+static void index_clear(void) {}
+
+static secbool index_is_valid(void) { return secfalse; }
+
+static secbool index_has(uint16_t key) {
+  (void)key;
+  return secfalse;
+}
+
+#endif
+
 /*
  * Finds the offset from the beginning of the sector where stored items start.
  */
@@ -231,11 +378,80 @@ static secbool find_item(uint8_t sector, uint16_t key, const void **val,
 }
 
 /*
- * Finds first unused offset in given sector
+ * Finds item in the writing sector, using the index if possible
+ */
+static secbool find_write_item(uint16_t key, const void **val, uint16_t *len) {
+#if NORCOW_INDEX_SIZE > 0
+  if (sectrue == norcow_index_valid && key != NORCOW_KEY_DELETED) {
+    secbool ret = secfalse;
+    *val = NULL;
+    *len = 0;
+    uint16_t i = index_position(key);
+    if (i < norcow_index_count && norcow_index[i].key == key) {
+      uint32_t offset = norcow_index[i].offset_words * NORCOW_WORD_SIZE;
+      const void *l =
+          norcow_ptr(norcow_write_sector, offset - sizeof(uint16_t), 2);
+      if (l != NULL) {
+        memcpy(len, l, sizeof(uint16_t));
+        *val = norcow_ptr(norcow_write_sector, offset, *len);
+        ret = sectrue * (*val != NULL);
+      }
+    }
+#ifndef NDEBUG
+    // Validate the index against the flash contents.
+    const void *v = NULL;
+    uint16_t n = 0;
+    secbool r = find_item(norcow_write_sector, key, &v, &n);
+    ensure(sectrue * (r == ret && v == *val && n == *len),
+           "norcow index mismatch");
+#endif
+    return ret;
+  }
+#endif
+  return find_item(norcow_write_sector, key, val, len);
+}
+
+/*
+ * Finds the newest instance of key in the writing sector before the given
+ * offset, returns the offset of its value
+ */
+static secbool find_older_item(uint16_t key, uint32_t before,
+                               uint32_t *older) {
+  uint32_t offset = 0;
+  uint32_t version = 0;
+  secbool found = secfalse;
+  if (sectrue != find_start_offset(norcow_write_sector, &offset, &version)) {
+    return secfalse;
+  }
+
+  while (offset < before) {
+    uint16_t k = 0, l = 0;
+    const void *v = NULL;
+    uint32_t pos = 0;
+    if (sectrue != read_item(norcow_write_sector, offset, &k, &v, &l, &pos)) {
+      break;
+    }
+    if (k == key && offset + NORCOW_PREFIX_LEN < before) {
+      *older = offset + NORCOW_PREFIX_LEN;
+      found = sectrue;
+    }
+    offset = pos;
+  }
+  return found;
+}
+
+/*
+ * Finds first unused offset in given sector and rebuilds the index if it is
+ * the writing sector
  */
 static uint32_t find_free_offset(uint8_t sector) {
   uint32_t offset = 0;
   uint32_t version = 0;
+  if (sector == norcow_write_sector) {
+    index_clear();
+    norcow_garbage = 0;
+    norcow_shadowed = 0;
+  }
   if (sectrue != find_start_offset(sector, &offset, &version)) {
     return secfalse;
   }
@@ -247,52 +463,243 @@ static uint32_t find_free_offset(uint8_t sector) {
     if (sectrue != read_item(sector, offset, &key, &val, &len, &pos)) {
       break;
     }
+    if (sector == norcow_write_sector) {
+      // Later instances of a key replace earlier ones. Once the index is full,
+      // a key missing from it may or may not have been seen before, so it is
+      // counted as shadowed. The count is then only an upper bound, which
+      // costs an extra scan in find_older_item() but is never wrong.
+      if (key == NORCOW_KEY_DELETED) {
+        norcow_garbage += pos - offset;
+      } else if (sectrue == index_has(key) || sectrue != index_is_valid()) {
+        norcow_shadowed++;
+      }
+      index_set(key, offset + NORCOW_PREFIX_LEN);
+    }
     offset = pos;
   }
   return offset;
 }
 
 /*
- * Compacts active sector and sets new active sector
+ * Starts a compaction of the active sector into the next sector
  */
-static void compact(void) {
-  uint32_t offsetr = 0;
+static void compact_start(void) {
+  norcow_compact_sector = (norcow_active_sector + 1) % NORCOW_SECTOR_COUNT;
+  norcow_compact = COMPACT_ERASE;
+}
+
+/*
+ * Makes the compaction sector the new active sector and erases the old one
+ */
+static void compact_finish(void) {
+  ensure(norcow_write(norcow_compact_sector, NORCOW_HEADER_LEN, NORCOW_MAGIC,
+                      NULL, 0),
+         "set magic failed");
+  ensure(norcow_write(norcow_compact_sector,
+                      NORCOW_HEADER_LEN + NORCOW_MAGIC_LEN, ~NORCOW_VERSION,
+                      NULL, 0),
+         "set version failed");
+
+  // Invalidate the old sector first, so that an interrupted erasure cannot
+  // leave behind a partially erased sector with a valid magic.
+  ensure(flash_unlock_write(), NULL);
+  ensure(flash_write_word(norcow_sectors[norcow_active_sector],
+                          NORCOW_HEADER_LEN, 0x00000000),
+         NULL);
+  ensure(flash_lock_write(), NULL);
+  erase_sector(norcow_active_sector, secfalse);
+
+  norcow_compact = COMPACT_NONE;
+  norcow_active_sector = norcow_compact_sector;
+  norcow_write_sector = norcow_compact_sector;
+  norcow_active_version = NORCOW_VERSION;
+  norcow_free_offset = find_free_offset(norcow_write_sector);
+}
+
+/*
+ * Performs one step of the compaction, which erases the compaction sector or
+ * copies at most max_items items and finishes the compaction when all items
+ * have been copied. Returns secfalse when the compaction is finished.
+ */
+static secbool compact_step(uint16_t max_items) {
   uint32_t version = 0;
-  if (sectrue != find_start_offset(norcow_active_sector, &offsetr, &version)) {
+  switch (norcow_compact) {
+    case COMPACT_NONE:
+      return secfalse;
+
+    case COMPACT_ERASE:
+      if (sectrue != find_start_offset(norcow_active_sector,
+                                       &norcow_compact_offsetr, &version)) {
+        norcow_compact = COMPACT_NONE;
+        return secfalse;
+      }
+      erase_sector(norcow_compact_sector, secfalse);
+      norcow_compact_offsetw = NORCOW_STORAGE_START;
+      norcow_compact = COMPACT_COPY;
+      return sectrue;
+
+    case COMPACT_COPY:
+      for (uint16_t i = 0; i < max_items;) {
+        // read item
+        uint16_t k = 0, l = 0;
+        const void *v = NULL;
+        uint32_t posr = 0;
+        secbool r = read_item(norcow_active_sector, norcow_compact_offsetr, &k,
+                              &v, &l, &posr);
+        if (sectrue != r) {
+          compact_finish();
+          return secfalse;
+        }
+        norcow_compact_offsetr = posr;
+
+        // skip deleted items
+        if (k == NORCOW_KEY_DELETED) {
+          continue;
+        }
+
+        // copy the item
+        uint32_t posw = 0;
+        ensure(write_item(norcow_compact_sector, norcow_compact_offsetw, k, v,
+                          l, &posw),
+               "compaction write failed");
+        norcow_compact_offsetw = posw;
+        i++;
+      }
+      return sectrue;
+  }
+  return secfalse;
+}
+
+/*
+ * Propagates a change of an item in the writing sector to its copy in the
+ * compaction sector. The value of the item starts at offset and the change
+ * may only clear bits, e.g. by updating the value or deleting the item.
+ */
+static void compact_sync(uint16_t key, uint32_t offset) {
+  if (norcow_compact != COMPACT_COPY || offset >= norcow_compact_offsetr) {
+    // The item has not been copied yet.
     return;
   }
 
-  norcow_write_sector = (norcow_active_sector + 1) % NORCOW_SECTOR_COUNT;
-  erase_sector(norcow_write_sector, sectrue);
-  uint32_t offsetw = NORCOW_STORAGE_START;
+  // Count the instances of the key before the item, the copy of the item
+  // follows the copies of all of them.
+  uint32_t offsetr = 0;
+  uint32_t version = 0;
+  uint32_t count = 0;
+  uint16_t k = 0, l = 0;
+  const void *v = NULL;
+  uint32_t pos = 0;
+  ensure(find_start_offset(norcow_write_sector, &offsetr, &version), NULL);
+  while (offsetr + NORCOW_PREFIX_LEN < offset) {
+    ensure(read_item(norcow_write_sector, offsetr, &k, &v, &l, &pos), NULL);
+    if (k == key) {
+      count++;
+    }
+    offsetr = pos;
+  }
 
+  // Find the copy of the item.
+  uint32_t offsetw = NORCOW_STORAGE_START;
   for (;;) {
-    // read item
-    uint16_t k = 0, l = 0;
-    const void *v = NULL;
-    uint32_t posr = 0;
-    secbool r = read_item(norcow_active_sector, offsetr, &k, &v, &l, &posr);
-    if (sectrue != r) {
+    if (offsetw >= norcow_compact_offsetw ||
+        sectrue != read_item(norcow_compact_sector, offsetw, &k, &v, &l,
+                             &pos)) {
+      return;
+    }
+    if (k == key && count-- == 0) {
       break;
     }
-    offsetr = posr;
+    offsetw = pos;
+  }
 
-    // skip deleted items
-    if (k == NORCOW_KEY_DELETED) {
-      continue;
+  uint32_t size = NORCOW_PREFIX_LEN + l;
+  ALIGN4(size);
+  const uint32_t *src =
+      norcow_ptr(norcow_write_sector, offset - NORCOW_PREFIX_LEN, size);
+  const uint32_t *dst = norcow_ptr(norcow_compact_sector, offsetw, size);
+  ensure(sectrue * (src != NULL && dst != NULL), "compaction sync failed");
+
+  ensure(flash_unlock_write(), NULL);
+  for (uint32_t i = 0; i < size / NORCOW_WORD_SIZE; i++) {
+    if (src[i] != dst[i]) {
+      ensure(flash_write_word(norcow_sectors[norcow_compact_sector],
+                              offsetw + i * NORCOW_WORD_SIZE, src[i]),
+             "compaction sync failed");
     }
+  }
+  ensure(flash_lock_write(), NULL);
+}
 
-    // copy the item
-    uint32_t posw = 0;
-    ensure(write_item(norcow_write_sector, offsetw, k, v, l, &posw),
-           "compaction write failed");
-    offsetw = posw;
+/*
+ * Compacts active sector and sets new active sector
+ */
+static void compact(void) {
+  if (norcow_compact == COMPACT_NONE) {
+    compact_start();
+  }
+  while (sectrue == compact_step(UINT16_MAX)) {
   }
+}
 
-  erase_sector(norcow_active_sector, secfalse);
-  norcow_active_sector = norcow_write_sector;
-  norcow_active_version = NORCOW_VERSION;
-  norcow_free_offset = find_free_offset(norcow_write_sector);
+/*
+ * Deletes the item whose value of length len starts at offset in the writing
+ * sector
+ */
+static void delete_item(uint16_t key, uint32_t offset, uint16_t len) {
+  const uint8_t sector_num = norcow_sectors[norcow_write_sector];
+  ensure(flash_unlock_write(), NULL);
+
+  // Update the prefix to indicate that the item has been deleted.
+  uint32_t prefix = (uint32_t)len << 16;
+  ensure(flash_write_word(sector_num, offset - NORCOW_PREFIX_LEN, prefix),
+         NULL);
+
+  // Delete the item data.
+  uint32_t end = offset + len;
+  uint32_t pos = offset;
+  while (pos < end) {
+    ensure(flash_write_word(sector_num, pos, 0x00000000), NULL);
+    pos += NORCOW_WORD_SIZE;
+  }
+
+  ensure(flash_lock_write(), NULL);
+  compact_sync(key, offset);
+  norcow_garbage += NORCOW_PREFIX_LEN + pos - offset;
+}
+
+/*
+ * Deletes the newest instance of key, returns sectrue if an older instance
+ * became the current one
+ */
+static secbool delete_newest(uint16_t key, uint32_t offset, uint16_t len) {
+  delete_item(key, offset, len);
+  index_delete(key);
+  uint32_t older = 0;
+  if (norcow_shadowed > 0 && sectrue == find_older_item(key, offset, &older)) {
+    index_set(key, older);
+    norcow_shadowed--;
+    return sectrue;
+  }
+  return secfalse;
+}
+
+/*
+ * Writes a new item at the end of the writing sector, compacting it if full
+ */
+static secbool append_item(uint16_t key, const void *val, uint16_t len) {
+  // Check whether there is enough free space and compact if full.
+  if (norcow_free_offset + NORCOW_PREFIX_LEN + len > NORCOW_SECTOR_SIZE) {
+    compact();
+  }
+  // Write new item.
+  uint32_t pos = 0;
+  secbool ret =
+      write_item(norcow_write_sector, norcow_free_offset, key, val, len, &pos);
+  if (sectrue == ret) {
+    index_set(key, norcow_free_offset + NORCOW_PREFIX_LEN);
+    norcow_free_offset = pos;
+  }
+  return ret;
 }
 
 /*
@@ -303,6 +710,7 @@ void norcow_init(uint32_t *norcow_version) {
   secbool found = secfalse;
   *norcow_version = 0;
   norcow_active_sector = 0;
+  norcow_compact = COMPACT_NONE;
   // detect active sector - starts with magic and has highest version
   for (uint8_t i = 0; i < NORCOW_SECTOR_COUNT; i++) {
     uint32_t offset = 0;
@@ -344,12 +752,19 @@ void norcow_wipe(void) {
   norcow_active_version = NORCOW_VERSION;
   norcow_write_sector = norcow_active_sector;
   norcow_free_offset = NORCOW_STORAGE_START;
+  norcow_garbage = 0;
+  norcow_shadowed = 0;
+  norcow_compact = COMPACT_NONE;
+  index_clear();
 }
 
 /*
  * Looks for the given key, returns status of the operation
  */
 secbool norcow_get(uint16_t key, const void **val, uint16_t *len) {
+  if (norcow_active_sector == norcow_write_sector) {
+    return find_write_item(key, val, len);
+  }
   return find_item(norcow_active_sector, key, val, len);
 }
 
@@ -424,7 +839,7 @@ secbool norcow_set_ex(uint16_t key, const void *val, uint16_t len,
   secbool ret = secfalse;
   const void *ptr = NULL;
   uint16_t len_old = 0;
-  *found = find_item(norcow_write_sector, key, &ptr, &len_old);
+  *found = find_write_item(key, &ptr, &len_old);
 
   // Try to update the entry if it already exists.
   uint32_t offset = 0;
@@ -433,54 +848,54 @@ secbool norcow_set_ex(uint16_t key, const void *val, uint16_t len,
         (const uint8_t *)ptr -
         (const uint8_t *)norcow_ptr(norcow_write_sector, 0, NORCOW_SECTOR_SIZE);
     if (val != NULL && len_old == len) {
-      ret = sectrue;
       ensure(flash_unlock_write(), NULL);
-      for (uint16_t i = 0; i < len; i++) {
-        if (sectrue != flash_write_byte(sector_num, offset + i,
-                                        ((const uint8_t *)val)[i])) {
-          ret = secfalse;
-          break;
-        }
-      }
+      ret = flash_write_block(sector_num, offset, val, len);
       ensure(flash_lock_write(), NULL);
+      compact_sync(key, offset);
     }
   }
 
   // If the update was not possible then write the entry as a new item.
   if (secfalse == ret) {
+    // An item which does not fit into an empty sector can never be written,
+    // so keep the old one.
+    if (NORCOW_STORAGE_START + NORCOW_PREFIX_LEN + (uint32_t)len >
+        NORCOW_SECTOR_SIZE) {
+      return secfalse;
+    }
     // Delete the old item.
+    secbool shadowing = secfalse;
     if (sectrue == *found) {
-      ensure(flash_unlock_write(), NULL);
-
-      // Update the prefix to indicate that the old item has been deleted.
-      uint32_t prefix = (uint32_t)len_old << 16;
-      ensure(flash_write_word(sector_num, offset - NORCOW_PREFIX_LEN, prefix),
-             NULL);
-
-      // Delete the old item data.
-      uint32_t end = offset + len_old;
-      while (offset < end) {
-        ensure(flash_write_word(sector_num, offset, 0x00000000), NULL);
-        offset += NORCOW_WORD_SIZE;
-      }
-
-      ensure(flash_lock_write(), NULL);
+      shadowing = delete_newest(key, offset, len_old);
     }
-    // Check whether there is enough free space and compact if full.
-    if (norcow_free_offset + NORCOW_PREFIX_LEN + len > NORCOW_SECTOR_SIZE) {
-      compact();
-    }
-    // Write new item.
-    uint32_t pos = 0;
-    ret = write_item(norcow_write_sector, norcow_free_offset, key, val, len,
-                     &pos);
-    if (sectrue == ret) {
-      norcow_free_offset = pos;
+    ret = append_item(key, val, len);
+    if (sectrue == ret && sectrue == shadowing) {
+      norcow_shadowed++;
     }
   }
   return ret;
 }
 
+/*
+ * Writes a new instance of the given key without deleting the previous one,
+ * which can be restored by norcow_revert() or deleted by norcow_delete_older().
+ */
+secbool norcow_append(uint16_t key, const void *val, uint16_t len) {
+  // Key 0xffff is used as a marker to indicate that the entry is not set.
+  if (key == NORCOW_KEY_FREE) {
+    return secfalse;
+  }
+
+  const void *ptr = NULL;
+  uint16_t len_old = 0;
+  secbool found = find_write_item(key, &ptr, &len_old);
+  secbool ret = append_item(key, val, len);
+  if (sectrue == ret && sectrue == found) {
+    norcow_shadowed++;
+  }
+  return ret;
+}
+
 /*
  * Deletes the given key, returns status of the operation.
  */
@@ -490,33 +905,62 @@ secbool norcow_delete(uint16_t key) {
     return secfalse;
   }
 
-  const uint8_t sector_num = norcow_sectors[norcow_write_sector];
   const void *ptr = NULL;
   uint16_t len = 0;
-  if (sectrue != find_item(norcow_write_sector, key, &ptr, &len)) {
+  if (sectrue != find_write_item(key, &ptr, &len)) {
     return secfalse;
   }
 
   uint32_t offset =
       (const uint8_t *)ptr -
       (const uint8_t *)norcow_ptr(norcow_write_sector, 0, NORCOW_SECTOR_SIZE);
+  delete_newest(key, offset, len);
+  return sectrue;
+}
 
-  ensure(flash_unlock_write(), NULL);
-
-  // Update the prefix to indicate that the item has been deleted.
-  uint32_t prefix = (uint32_t)len << 16;
-  ensure(flash_write_word(sector_num, offset - NORCOW_PREFIX_LEN, prefix),
-         NULL);
+/*
+ * Deletes all instances of the given key except for the newest one.
+ */
+secbool norcow_delete_older(uint16_t key) {
+  const void *ptr = NULL;
+  uint16_t len = 0;
+  if (key == NORCOW_KEY_FREE || sectrue != find_write_item(key, &ptr, &len)) {
+    return secfalse;
+  }
 
-  // Delete the item data.
-  uint32_t end = offset + len;
-  while (offset < end) {
-    ensure(flash_write_word(sector_num, offset, 0x00000000), NULL);
-    offset += NORCOW_WORD_SIZE;
+  uint32_t newest =
+      (const uint8_t *)ptr -
+      (const uint8_t *)norcow_ptr(norcow_write_sector, 0, NORCOW_SECTOR_SIZE);
+  uint32_t offset = 0;
+  while (norcow_shadowed > 0 && sectrue == find_older_item(key, newest, &offset)) {
+    const uint16_t *l = norcow_ptr(norcow_write_sector,
+                                   offset - sizeof(uint16_t), sizeof(uint16_t));
+    delete_item(key, offset, *l);
+    norcow_shadowed--;
   }
+  return sectrue;
+}
 
-  ensure(flash_lock_write(), NULL);
+/*
+ * Deletes the newest instance of the given key if there is an older one, which
+ * becomes the current instance again.
+ */
+secbool norcow_revert(uint16_t key) {
+  const void *ptr = NULL;
+  uint16_t len = 0;
+  if (key == NORCOW_KEY_FREE || norcow_shadowed == 0 ||
+      sectrue != find_write_item(key, &ptr, &len)) {
+    return secfalse;
+  }
 
+  uint32_t offset =
+      (const uint8_t *)ptr -
+      (const uint8_t *)norcow_ptr(norcow_write_sector, 0, NORCOW_SECTOR_SIZE);
+  uint32_t older = 0;
+  if (sectrue != find_older_item(key, offset, &older)) {
+    return secfalse;
+  }
+  delete_newest(key, offset, len);
   return sectrue;
 }
 
@@ -527,7 +971,7 @@ secbool norcow_delete(uint16_t key) {
 secbool norcow_update_word(uint16_t key, uint16_t offset, uint32_t value) {
   const void *ptr = NULL;
   uint16_t len = 0;
-  if (sectrue != find_item(norcow_write_sector, key, &ptr, &len)) {
+  if (sectrue != find_write_item(key, &ptr, &len)) {
     return secfalse;
   }
   if ((offset & 3) != 0 || offset >= len) {
@@ -542,6 +986,7 @@ secbool norcow_update_word(uint16_t key, uint16_t offset, uint32_t value) {
                           value),
          NULL);
   ensure(flash_lock_write(), NULL);
+  compact_sync(key, sector_offset - offset);
   return sectrue;
 }
 
@@ -552,7 +997,7 @@ secbool norcow_update_bytes(const uint16_t key, const uint16_t offset,
                             const uint8_t *data, const uint16_t len) {
   const void *ptr = NULL;
   uint16_t allocated_len = 0;
-  if (sectrue != find_item(norcow_write_sector, key, &ptr, &allocated_len)) {
+  if (sectrue != find_write_item(key, &ptr, &allocated_len)) {
     return secfalse;
   }
   if (offset + len > allocated_len) {
@@ -564,13 +1009,41 @@ secbool norcow_update_bytes(const uint16_t key, const uint16_t offset,
       offset;
   uint8_t sector = norcow_sectors[norcow_write_sector];
   ensure(flash_unlock_write(), NULL);
-  for (uint16_t i = 0; i < len; i++, sector_offset++) {
-    ensure(flash_write_byte(sector, sector_offset, data[i]), NULL);
-  }
+  ensure(flash_write_block(sector, sector_offset, data, len), NULL);
   ensure(flash_lock_write(), NULL);
+  compact_sync(key, sector_offset - offset);
   return sectrue;
 }
 
+/*
+ * Returns how much of the writing sector is used and how much of it is taken
+ * by deleted items, both in percent of the sector size
+ */
+void norcow_get_pressure(uint8_t *used, uint8_t *reclaimable) {
+  *used = norcow_free_offset * 100 / NORCOW_SECTOR_SIZE;
+  *reclaimable = norcow_garbage * 100 / NORCOW_SECTOR_SIZE;
+}
+
+/*
+ * Performs a bounded part of an incremental compaction, i.e. either erases a
+ * sector or copies at most max_items items. If no compaction is in progress, a
+ * new one is started only if start is sectrue and there are deleted items.
+ * Returns sectrue if the compaction has not finished yet.
+ */
+secbool norcow_compact_step(uint16_t max_items, secbool start) {
+  // Compaction is not possible during a storage upgrade.
+  if (norcow_active_sector != norcow_write_sector) {
+    return secfalse;
+  }
+  if (norcow_compact == COMPACT_NONE) {
+    if (sectrue != start || norcow_garbage == 0) {
+      return secfalse;
+    }
+    compact_start();
+  }
+  return compact_step(max_items > 0 ? max_items : 1);
+}
+
 /*
  * Complete storage version upgrade
  */
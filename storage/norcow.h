@@ -60,11 +60,29 @@ secbool norcow_set(uint16_t key, const void *val, uint16_t len);
 secbool norcow_set_ex(uint16_t key, const void *val, uint16_t len,
                       secbool *found);
 
+/*
+ * Writes a new instance of the given key without deleting the previous one,
+ * which can be restored by norcow_revert() or deleted by norcow_delete_older().
+ * Only the newest instance is visible to norcow_get().
+ */
+secbool norcow_append(uint16_t key, const void *val, uint16_t len);
+
 /*
  * Deletes the given key, returns status of the operation.
  */
 secbool norcow_delete(uint16_t key);
 
+/*
+ * Deletes all instances of the given key except for the newest one.
+ */
+secbool norcow_delete_older(uint16_t key);
+
+/*
+ * Deletes the newest instance of the given key if there is an older one, which
+ * becomes the current instance again.
+ */
+secbool norcow_revert(uint16_t key);
+
 /*
  * Update a word in flash in the given key at the given offset.
  * Note that you can only change bits from 1 to 0.
@@ -78,6 +96,19 @@ secbool norcow_update_word(uint16_t key, uint16_t offset, uint32_t value);
 secbool norcow_update_bytes(const uint16_t key, const uint16_t offset,
                             const uint8_t *data, const uint16_t len);
 
+/*
+ * Returns how much of the writing sector is used and how much of it can be
+ * reclaimed by compaction, both in percent of the sector size.
+ */
+void norcow_get_pressure(uint8_t *used, uint8_t *reclaimable);
+
+/*
+ * Performs a bounded part of an incremental compaction. If none is in progress,
+ * a new one is started only if start is sectrue and there are deleted items.
+ * Returns sectrue if the compaction has not finished yet.
+ */
+secbool norcow_compact_step(uint16_t max_items, secbool start);
+
 /*
  * Complete storage version upgrade
  */
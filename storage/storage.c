@@ -61,6 +61,9 @@
 // Norcow storage key of the storage upgrade flag.
 #define STORAGE_UPGRADED_KEY ((APP_STORAGE << 8) | 0x07)
 
+// Norcow storage key of the journal of a batch of changes.
+#define BATCH_KEY ((APP_STORAGE << 8) | 0x08)
+
 #define APP_PIN (0x01 << 8)
 #define PIN_PUBLIC_SHIFTED (FLAG_PUBLIC << 8)
 
@@ -146,6 +149,25 @@
 // The length of the counter tail in words.
 #define COUNTER_TAIL_WORDS 2
 
+// The storage pressure in percent at which storage_idle() starts compacting.
+#define COMPACT_PRESSURE 75
+
+// The maximum number of items copied by one call of storage_idle().
+#define COMPACT_IDLE_ITEMS 16
+
+// The maximum number of keys changed in one batch.
+#define BATCH_MAX_KEYS 32
+
+// The size of the batch journal, which consists of the commit word followed by
+// one word for every changed key.
+#define BATCH_JOURNAL_SIZE ((1 + BATCH_MAX_KEYS) * WORD_SIZE)
+
+// Operations in the upper half of a journal word, the lower half is the key. A
+// word of zeroes is a cancelled operation.
+#define BATCH_OP_SET_NEW 0x1E1E  // set a key which did not exist before
+#define BATCH_OP_SET_OLD 0x2D2D  // set a key which existed before
+#define BATCH_OP_DELETE 0x4B4B   // delete a key at commit
+
 // Values used in the guard key integrity check.
 #define GUARD_KEY_MODULUS 6311
 #define GUARD_KEY_REMAINDER 15
@@ -170,6 +192,11 @@ static uint8_t *const cached_sak = cached_keys + DEK_SIZE;
 static uint8_t authentication_sum[SHA256_DIGEST_LENGTH] = {0};
 static uint8_t hardware_salt[HARDWARE_SALT_SIZE] = {0};
 static uint32_t norcow_active_version = 0;
+static secbool batch_active = secfalse;
+static uint32_t batch_journal[BATCH_MAX_KEYS] = {0};
+static uint16_t batch_count = 0;
+static secbool batch_failed = secfalse;
+static uint8_t batch_sum[SHA256_DIGEST_LENGTH] = {0};
 static const uint8_t TRUE_BYTE = 0x01;
 static const uint8_t FALSE_BYTE = 0x00;
 static const uint32_t TRUE_WORD = 0xC35A69A5;
@@ -184,6 +211,9 @@ static secbool storage_set_encrypted(const uint16_t key, const void *val,
                                      const uint16_t len);
 static secbool storage_get_encrypted(const uint16_t key, void *val_dest,
                                      const uint16_t max_len, uint16_t *len);
+static secbool batch_set(const uint16_t key, const void *val,
+                         const uint16_t len);
+static void batch_finish(void);
 
 static secbool secequal(const void *ptr1, const void *ptr2, size_t n) {
   const uint8_t *p1 = ptr1;
@@ -245,6 +275,17 @@ static secbool auth_init(void) {
   return norcow_set(STORAGE_TAG_KEY, tag, STORAGE_TAG_SIZE);
 }
 
+/*
+ * Add or remove the given key from an authentication sum.
+ */
+static void auth_sum_toggle(uint8_t *sum, uint16_t key) {
+  uint8_t tag[SHA256_DIGEST_LENGTH] = {0};
+  hmac_sha256(cached_sak, SAK_SIZE, (uint8_t *)&key, sizeof(key), tag);
+  for (uint32_t i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+    sum[i] ^= tag[i];
+  }
+}
+
 /*
  * Update the storage authentication tag with the given key.
  */
@@ -254,10 +295,7 @@ static secbool auth_update(uint16_t key) {
   }
 
   uint8_t tag[SHA256_DIGEST_LENGTH] = {0};
-  hmac_sha256(cached_sak, SAK_SIZE, (uint8_t *)&key, sizeof(key), tag);
-  for (uint32_t i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-    authentication_sum[i] ^= tag[i];
-  }
+  auth_sum_toggle(authentication_sum, key);
   hmac_sha256(cached_sak, SAK_SIZE, authentication_sum,
               sizeof(authentication_sum), tag);
   return norcow_set(STORAGE_TAG_KEY, tag, STORAGE_TAG_SIZE);
@@ -279,6 +317,22 @@ static secbool auth_set(uint16_t key, const void *val, uint16_t len) {
   return ret;
 }
 
+/*
+ * Returns the position of the given operation on key in the batch journal or
+ * -1 if there is none. BATCH_OP_SET_NEW matches both set operations.
+ */
+static int batch_find(uint16_t key, uint16_t op) {
+  for (int i = 0; i < batch_count; i++) {
+    uint16_t k = batch_journal[i] & 0xFFFF;
+    uint16_t o = batch_journal[i] >> 16;
+    if (k == key && (o == op || (op == BATCH_OP_SET_NEW &&
+                                 o == BATCH_OP_SET_OLD))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
 /*
  * A secure version of norcow_get(), which checks the storage authentication
  * tag.
@@ -323,6 +377,27 @@ static secbool auth_get(uint16_t key, const void **val, uint16_t *len) {
       }
       continue;
     }
+    if (batch_find(k, BATCH_OP_SET_NEW) >= 0) {
+      // Keys set in the current batch are counted below.
+      continue;
+    }
+    g[0] = (((uint32_t)k & 0xff) << 24) | (((uint32_t)k & 0xff00) << 8) |
+           0x8000;  // Add SHA message padding.
+    sha256_Transform(idig, g, h);
+    sha256_Transform(odig, h, h);
+    for (uint32_t i = 0; i < SHA256_DIGEST_LENGTH / sizeof(uint32_t); i++) {
+      sum[i] ^= h[i];
+    }
+  }
+
+  // The stored tag does not include the changes of the current batch, so
+  // count only the keys which existed before it.
+  for (int j = 0; j < batch_count; j++) {
+    k = batch_journal[j] & 0xFFFF;
+    if ((batch_journal[j] >> 16) != BATCH_OP_SET_OLD ||
+        sectrue != is_protected(k)) {
+      continue;
+    }
     g[0] = (((uint32_t)k & 0xff) << 24) | (((uint32_t)k & 0xff00) << 8) |
            0x8000;  // Add SHA message padding.
     sha256_Transform(idig, g, h);
@@ -690,6 +765,9 @@ void storage_init(PIN_UI_WAIT_CALLBACK callback, const uint8_t *salt,
     }
   }
 
+  // Complete a batch which was interrupted by a power loss.
+  batch_finish();
+
   // If there is no EDEK, then generate a random DEK and SAK and store them.
   const void *val = NULL;
   uint16_t len = 0;
@@ -881,6 +959,7 @@ secbool storage_is_unlocked(void) {
 }
 
 void storage_lock(void) {
+  storage_abort_batch();
   unlocked = secfalse;
   memzero(cached_keys, sizeof(cached_keys));
   memzero(authentication_sum, sizeof(authentication_sum));
@@ -1145,6 +1224,106 @@ static secbool storage_get_encrypted(const uint16_t key, void *val_dest,
   return sectrue;
 }
 
+/*
+ * Passes the plaintext of the value stored under key to cb in chunks. The
+ * authentication tag is checked over the whole ciphertext first, so that no
+ * unauthenticated data is released.
+ */
+static secbool storage_get_encrypted_stream(const uint16_t key,
+                                            STORAGE_CHUNK_CALLBACK cb,
+                                            void *cb_ctx, uint16_t *len) {
+  const void *val_stored = NULL;
+
+  if (sectrue != auth_get(key, &val_stored, len)) {
+    return secfalse;
+  }
+
+  if (*len < CHACHA20_IV_SIZE + POLY1305_TAG_SIZE) {
+    handle_fault("ciphertext length check");
+    return secfalse;
+  }
+  *len -= CHACHA20_IV_SIZE + POLY1305_TAG_SIZE;
+
+  const uint8_t *iv = (const uint8_t *)val_stored;
+  const uint8_t *tag_stored = (const uint8_t *)val_stored + CHACHA20_IV_SIZE;
+  const uint8_t *ciphertext =
+      (const uint8_t *)val_stored + CHACHA20_IV_SIZE + POLY1305_TAG_SIZE;
+  uint8_t tag_computed[POLY1305_TAG_SIZE] = {0};
+  chacha20poly1305_ctx ctx = {0};
+  rfc7539_init(&ctx, cached_dek, iv);
+  rfc7539_auth(&ctx, (const uint8_t *)&key, sizeof(key));
+  chacha20poly1305_auth(&ctx, ciphertext, *len);
+  rfc7539_finish(&ctx, sizeof(key), *len, tag_computed);
+  memzero(&ctx, sizeof(ctx));
+
+  // Verify authentication tag.
+  if (secequal(tag_computed, tag_stored, POLY1305_TAG_SIZE) != sectrue) {
+    memzero(tag_computed, sizeof(tag_computed));
+    handle_fault("authentication tag check");
+    return secfalse;
+  }
+  memzero(tag_computed, sizeof(tag_computed));
+
+  // Decrypt the verified ciphertext, the MAC is not needed anymore.
+  uint8_t buffer[STORAGE_CHUNK_SIZE] = {0};
+  secbool ret = sectrue;
+  rfc7539_init(&ctx, cached_dek, iv);
+  for (uint32_t i = 0; i < *len && sectrue == ret; i += STORAGE_CHUNK_SIZE) {
+    const uint16_t n =
+        (*len - i < STORAGE_CHUNK_SIZE) ? *len - i : STORAGE_CHUNK_SIZE;
+    ECRYPT_encrypt_bytes(&ctx.chacha20, ciphertext + i, buffer, n);
+    ret = cb(cb_ctx, i, buffer, n);
+  }
+  memzero(&ctx, sizeof(ctx));
+  memzero(buffer, sizeof(buffer));
+  return ret;
+}
+
+/*
+ * Finds the data stored under key, writes its length to len and passes it to cb
+ * in chunks of at most STORAGE_CHUNK_SIZE bytes. Unlike storage_get(), it needs
+ * only a single chunk of RAM regardless of the length of the value.
+ */
+secbool storage_get_stream(const uint16_t key, STORAGE_CHUNK_CALLBACK cb,
+                           void *ctx, uint16_t *len) {
+  const uint8_t app = key >> 8;
+  // APP == 0 is reserved for PIN related values
+  if (sectrue != initialized || app == APP_STORAGE || cb == NULL) {
+    return secfalse;
+  }
+
+  // The values stored in the SE are not streamed.
+  if (g_bSelectSEFlag && !(app & FLAG_ST)) {
+    return secfalse;
+  }
+
+  // Keys deleted in the current batch are gone already.
+  if (batch_find(key, BATCH_OP_DELETE) >= 0) {
+    return secfalse;
+  }
+
+  if ((app & FLAG_PUBLIC) == 0) {
+    if (sectrue != unlocked) {
+      return secfalse;
+    }
+    return storage_get_encrypted_stream(key, cb, ctx, len);
+  }
+
+  const void *val_stored = NULL;
+  if (sectrue != norcow_get(key, &val_stored, len)) {
+    return secfalse;
+  }
+  uint8_t buffer[STORAGE_CHUNK_SIZE] = {0};
+  secbool ret = sectrue;
+  for (uint32_t i = 0; i < *len && sectrue == ret; i += STORAGE_CHUNK_SIZE) {
+    const uint16_t n =
+        (*len - i < STORAGE_CHUNK_SIZE) ? *len - i : STORAGE_CHUNK_SIZE;
+    memcpy(buffer, (const uint8_t *)val_stored + i, n);
+    ret = cb(ctx, i, buffer, n);
+  }
+  return ret;
+}
+
 secbool storage_has(const uint16_t key) {
   uint16_t len = 0;
   return storage_get(key, NULL, 0, &len);
@@ -1163,6 +1342,11 @@ secbool storage_get(const uint16_t key, void *val_dest, const uint16_t max_len,
   }
 
   if (!g_bSelectSEFlag || app & FLAG_ST) {
+    // Keys deleted in the current batch are gone already.
+    if (batch_find(key, BATCH_OP_DELETE) >= 0) {
+      return secfalse;
+    }
+
     // If the top bit of APP is set, then the value is not encrypted and can be
     // read from a locked device.
     if ((app & FLAG_PUBLIC) != 0) {
@@ -1192,50 +1376,56 @@ secbool storage_get(const uint16_t key, void *val_dest, const uint16_t max_len,
   }
 }
 /*
- * Encrypts the data at val using cached_dek as the encryption key and stores
- * the ciphertext under key.
+ * Encrypts the data produced by cb in chunks using cached_dek as the
+ * encryption key and stores the ciphertext under key. On return, allocated
+ * tells whether the item was allocated on the flash, i.e. whether a failure
+ * left a partially written value behind.
  */
-static secbool storage_set_encrypted(const uint16_t key, const void *val,
-                                     const uint16_t len) {
+static secbool storage_set_encrypted_stream(const uint16_t key,
+                                            const uint16_t len,
+                                            STORAGE_CHUNK_CALLBACK cb,
+                                            void *cb_ctx, secbool *allocated) {
+  *allocated = secfalse;
   if (len > UINT16_MAX - CHACHA20_IV_SIZE - POLY1305_TAG_SIZE) {
     return secfalse;
   }
 
   // Preallocate space on the flash storage.
-  if (sectrue !=
-      auth_set(key, NULL, CHACHA20_IV_SIZE + POLY1305_TAG_SIZE + len)) {
+  const uint16_t size = CHACHA20_IV_SIZE + POLY1305_TAG_SIZE + len;
+  if (sectrue == batch_active && (key >> 8) != APP_STORAGE) {
+    if (sectrue != batch_set(key, NULL, size)) {
+      return secfalse;
+    }
+  } else if (sectrue != auth_set(key, NULL, size)) {
     return secfalse;
   }
+  *allocated = sectrue;
 
   // Write the IV to the flash.
-  uint8_t buffer[CHACHA20_BLOCK_SIZE] = {0};
+  uint8_t buffer[STORAGE_CHUNK_SIZE] = {0};
   random_buffer(buffer, CHACHA20_IV_SIZE);
-  uint16_t offset = 0;
-  if (sectrue != norcow_update_bytes(key, offset, buffer, CHACHA20_IV_SIZE)) {
+  if (sectrue != norcow_update_bytes(key, 0, buffer, CHACHA20_IV_SIZE)) {
     return secfalse;
   }
-  offset += CHACHA20_IV_SIZE + POLY1305_TAG_SIZE;
 
-  // Encrypt all blocks except for the last one.
+  // Encrypt the chunks in place. All of them except for the last one are a
+  // multiple of the block size.
   chacha20poly1305_ctx ctx = {0};
   rfc7539_init(&ctx, cached_dek, buffer);
   rfc7539_auth(&ctx, (const uint8_t *)&key, sizeof(key));
-  size_t i = 0;
-  for (i = 0; i + CHACHA20_BLOCK_SIZE < len;
-       i += CHACHA20_BLOCK_SIZE, offset += CHACHA20_BLOCK_SIZE) {
-    chacha20poly1305_encrypt(&ctx, ((const uint8_t *)val) + i, buffer,
-                             CHACHA20_BLOCK_SIZE);
-    if (sectrue !=
-        norcow_update_bytes(key, offset, buffer, CHACHA20_BLOCK_SIZE)) {
-      memzero(&ctx, sizeof(ctx));
-      memzero(buffer, sizeof(buffer));
-      return secfalse;
+  secbool ret = sectrue;
+  for (uint32_t i = 0; i < len && sectrue == ret; i += STORAGE_CHUNK_SIZE) {
+    const uint16_t n =
+        (len - i < STORAGE_CHUNK_SIZE) ? len - i : STORAGE_CHUNK_SIZE;
+    ret = cb(cb_ctx, i, buffer, n);
+    if (sectrue == ret) {
+      chacha20poly1305_encrypt(&ctx, buffer, buffer, n);
+      ret = norcow_update_bytes(
+          key, CHACHA20_IV_SIZE + POLY1305_TAG_SIZE + i, buffer, n);
     }
   }
 
-  // Encrypt final block and compute message authentication tag.
-  chacha20poly1305_encrypt(&ctx, ((const uint8_t *)val) + i, buffer, len - i);
-  secbool ret = norcow_update_bytes(key, offset, buffer, len - i);
+  // Compute message authentication tag.
   if (sectrue == ret) {
     rfc7539_finish(&ctx, sizeof(key), len, buffer);
     ret = norcow_update_bytes(key, CHACHA20_IV_SIZE, buffer, POLY1305_TAG_SIZE);
@@ -1245,6 +1435,208 @@ static secbool storage_set_encrypted(const uint16_t key, const void *val,
   return ret;
 }
 
+static secbool copy_chunk(void *ctx, uint16_t offset, uint8_t *chunk,
+                          uint16_t len) {
+  memcpy(chunk, (const uint8_t *)ctx + offset, len);
+  return sectrue;
+}
+
+/*
+ * Encrypts the data at val using cached_dek as the encryption key and stores
+ * the ciphertext under key.
+ */
+static secbool storage_set_encrypted(const uint16_t key, const void *val,
+                                     const uint16_t len) {
+  secbool allocated = secfalse;
+  return storage_set_encrypted_stream(key, len, copy_chunk, (void *)val,
+                                      &allocated);
+}
+
+/*
+ * Adds an operation to the batch journal.
+ */
+static secbool batch_add(uint16_t key, uint16_t op) {
+  if (batch_count >= BATCH_MAX_KEYS) {
+    batch_failed = sectrue;
+    return secfalse;
+  }
+  uint32_t word = ((uint32_t)op << 16) | key;
+  if (sectrue != norcow_update_word(BATCH_KEY, (1 + batch_count) * WORD_SIZE,
+                                    word)) {
+    batch_failed = sectrue;
+    return secfalse;
+  }
+  batch_journal[batch_count++] = word;
+  return sectrue;
+}
+
+/*
+ * Returns sectrue if the key exists and is not deleted in the current batch.
+ */
+static secbool batch_exists(uint16_t key) {
+  const void *val = NULL;
+  uint16_t len = 0;
+  return sectrue * (sectrue == norcow_get(key, &val, &len) &&
+                    batch_find(key, BATCH_OP_DELETE) < 0);
+}
+
+/*
+ * A version of auth_set() used during a batch. The first write of a key keeps
+ * its previous value in the storage until the batch is committed.
+ */
+static secbool batch_set(const uint16_t key, const void *val,
+                         const uint16_t len) {
+  const void *val_old = NULL;
+  uint16_t len_old = 0;
+  secbool found = norcow_get(key, &val_old, &len_old);
+  secbool exists = batch_exists(key);
+
+  // Setting a key cancels its pending deletion.
+  int i = batch_find(key, BATCH_OP_DELETE);
+  if (i >= 0) {
+    if (sectrue != norcow_update_word(BATCH_KEY, (1 + i) * WORD_SIZE, 0)) {
+      batch_failed = sectrue;
+      return secfalse;
+    }
+    batch_journal[i] = 0;
+  }
+
+  if (sectrue != exists && sectrue == is_protected(key)) {
+    auth_sum_toggle(batch_sum, key);
+  }
+
+  secbool ret = secfalse;
+  if (batch_find(key, BATCH_OP_SET_NEW) >= 0) {
+    ret = norcow_set(key, val, len);
+  } else if (sectrue == batch_add(key, sectrue == found ? BATCH_OP_SET_OLD
+                                                         : BATCH_OP_SET_NEW)) {
+    ret = norcow_append(key, val, len);
+  }
+  if (sectrue != ret) {
+    batch_failed = sectrue;
+  }
+  return ret;
+}
+
+/*
+ * A version of storage_delete() used during a batch. The key is deleted when
+ * the batch is committed.
+ */
+static secbool batch_delete(const uint16_t key) {
+  if (sectrue != batch_exists(key) ||
+      sectrue != batch_add(key, BATCH_OP_DELETE)) {
+    return secfalse;
+  }
+  if (sectrue == is_protected(key)) {
+    auth_sum_toggle(batch_sum, key);
+  }
+  return sectrue;
+}
+
+/*
+ * Completes the batch in the journal, i.e. deletes the previous values of the
+ * changed keys if it has been committed or the new values if it has not.
+ */
+static void batch_finish(void) {
+  uint32_t journal[1 + BATCH_MAX_KEYS] = {0};
+  const void *val = NULL;
+  uint16_t len = 0;
+
+  batch_active = secfalse;
+  batch_failed = secfalse;
+  batch_count = 0;
+  memzero(batch_journal, sizeof(batch_journal));
+  memzero(batch_sum, sizeof(batch_sum));
+  if (sectrue != norcow_get(BATCH_KEY, &val, &len)) {
+    return;
+  }
+  if (len == sizeof(journal)) {
+    memcpy(journal, val, sizeof(journal));
+  }
+
+  secbool committed = sectrue * (journal[0] == TRUE_WORD);
+  for (size_t i = 1; i < 1 + BATCH_MAX_KEYS; i++) {
+    uint16_t key = journal[i] & 0xFFFF;
+    switch (journal[i] >> 16) {
+      case BATCH_OP_SET_NEW:
+        if (sectrue == committed) {
+          norcow_delete_older(key);
+        } else {
+          while (sectrue == norcow_delete(key)) {
+          }
+        }
+        break;
+      case BATCH_OP_SET_OLD:
+        if (sectrue == committed) {
+          norcow_delete_older(key);
+        } else {
+          norcow_revert(key);
+        }
+        break;
+      case BATCH_OP_DELETE:
+        if (sectrue == committed) {
+          while (sectrue == norcow_delete(key)) {
+          }
+        }
+        break;
+    }
+  }
+  if (sectrue == committed) {
+    norcow_delete_older(STORAGE_TAG_KEY);
+  } else {
+    norcow_revert(STORAGE_TAG_KEY);
+  }
+  ensure(norcow_delete(BATCH_KEY), NULL);
+}
+
+secbool storage_begin_batch(void) {
+  if (sectrue != initialized || sectrue != unlocked ||
+      sectrue == batch_active || g_bSelectSEFlag) {
+    return secfalse;
+  }
+
+  // Allocate an empty journal.
+  if (sectrue != norcow_set(BATCH_KEY, NULL, BATCH_JOURNAL_SIZE)) {
+    return secfalse;
+  }
+  memcpy(batch_sum, authentication_sum, sizeof(batch_sum));
+  batch_count = 0;
+  batch_failed = secfalse;
+  batch_active = sectrue;
+  return sectrue;
+}
+
+secbool storage_commit_batch(void) {
+  if (sectrue != batch_active) {
+    return secfalse;
+  }
+  // A change which could not be recorded would be lost by the commit, so the
+  // whole batch is rolled back instead.
+  if (sectrue != unlocked || sectrue == batch_failed) {
+    batch_finish();
+    return secfalse;
+  }
+
+  // Write the new authentication tag next to the old one and mark the batch as
+  // committed, which atomically switches to the new values.
+  uint8_t tag[SHA256_DIGEST_LENGTH] = {0};
+  hmac_sha256(cached_sak, SAK_SIZE, batch_sum, sizeof(batch_sum), tag);
+  if (sectrue != norcow_append(STORAGE_TAG_KEY, tag, STORAGE_TAG_SIZE) ||
+      sectrue != norcow_update_word(BATCH_KEY, 0, TRUE_WORD)) {
+    batch_finish();
+    return secfalse;
+  }
+  memcpy(authentication_sum, batch_sum, sizeof(authentication_sum));
+  batch_finish();
+  return sectrue;
+}
+
+void storage_abort_batch(void) {
+  if (sectrue == batch_active) {
+    batch_finish();
+  }
+}
+
 secbool storage_set(const uint16_t key, const void *val, const uint16_t len) {
   const uint8_t app = key >> 8;
 
@@ -1261,7 +1653,11 @@ secbool storage_set(const uint16_t key, const void *val, const uint16_t len) {
   secbool ret = secfalse;
   if (!g_bSelectSEFlag || app & FLAG_ST) {
     if ((app & FLAG_PUBLIC) != 0) {
-      ret = norcow_set(key, val, len);
+      if (sectrue == batch_active) {
+        ret = batch_set(key, val, len);
+      } else {
+        ret = norcow_set(key, val, len);
+      }
     } else {
       ret = storage_set_encrypted(key, val, len);
     }
@@ -1274,6 +1670,60 @@ secbool storage_set(const uint16_t key, const void *val, const uint16_t len) {
   return ret;
 }
 
+/*
+ * Stores len bytes under key, which cb fills in chunks of at most
+ * STORAGE_CHUNK_SIZE bytes. If cb fails, then the key is deleted. If the
+ * value cannot be allocated, then the old value is kept.
+ */
+secbool storage_set_stream(const uint16_t key, const uint16_t len,
+                           STORAGE_CHUNK_CALLBACK cb, void *ctx) {
+  const uint8_t app = key >> 8;
+
+  // APP == 0 is reserved for PIN related values
+  if (sectrue != initialized || app == APP_STORAGE || cb == NULL) {
+    return secfalse;
+  }
+
+  // The values stored in the SE are not streamed.
+  if (g_bSelectSEFlag && !(app & FLAG_ST)) {
+    return secfalse;
+  }
+
+  if (sectrue != unlocked && (app & FLAGS_WRITE) != FLAGS_WRITE) {
+    return secfalse;
+  }
+
+  secbool ret = secfalse;
+  secbool allocated = secfalse;
+  if ((app & FLAG_PUBLIC) != 0) {
+    // Allocate the item and fill it chunk by chunk.
+    if (sectrue == batch_active) {
+      ret = batch_set(key, NULL, len);
+    } else {
+      ret = norcow_set(key, NULL, len);
+    }
+    allocated = ret;
+    uint8_t buffer[STORAGE_CHUNK_SIZE] = {0};
+    for (uint32_t i = 0; i < len && sectrue == ret; i += STORAGE_CHUNK_SIZE) {
+      const uint16_t n =
+          (len - i < STORAGE_CHUNK_SIZE) ? len - i : STORAGE_CHUNK_SIZE;
+      ret = cb(ctx, i, buffer, n);
+      if (sectrue == ret) {
+        ret = norcow_update_bytes(key, i, buffer, n);
+      }
+    }
+  } else {
+    ret = storage_set_encrypted_stream(key, len, cb, ctx, &allocated);
+  }
+
+  // Do not leave a partially written value behind. If the new item could not
+  // even be allocated, then the old value is still intact and is kept.
+  if (sectrue != ret && sectrue == allocated) {
+    storage_delete(key);
+  }
+  return ret;
+}
+
 secbool storage_delete(const uint16_t key) {
   const uint8_t app = key >> 8;
 
@@ -1286,6 +1736,9 @@ secbool storage_delete(const uint16_t key) {
     return secfalse;
   }
   if (!g_bSelectSEFlag || app & FLAG_ST) {
+    if (sectrue == batch_active) {
+      return batch_delete(key);
+    }
     secbool ret = norcow_delete(key);
     if (sectrue == ret) {
       ret = auth_update(key);
@@ -1401,8 +1854,9 @@ uint32_t storage_get_pin_rem(void) {
 secbool storage_change_pin(uint32_t oldpin, uint32_t newpin,
                            const uint8_t *old_ext_salt,
                            const uint8_t *new_ext_salt) {
-  if (sectrue != initialized || oldpin == PIN_INVALID ||
-      newpin == PIN_INVALID) {
+  // The PIN keys are not part of a batch.
+  if (sectrue != initialized || sectrue == batch_active ||
+      oldpin == PIN_INVALID || newpin == PIN_INVALID) {
     return secfalse;
   }
 
@@ -1461,10 +1915,42 @@ secbool storage_change_wipe_code(uint32_t pin, const uint8_t *ext_salt,
   return ret;
 }
 
+uint8_t storage_pressure(void) {
+  uint8_t used = 0, reclaimable = 0;
+  if (sectrue != initialized || g_bSelectSEFlag) {
+    return 0;
+  }
+  norcow_get_pressure(&used, &reclaimable);
+  return used;
+}
+
+secbool storage_compact_step(uint16_t max_items) {
+  if (sectrue != initialized || g_bSelectSEFlag) {
+    return secfalse;
+  }
+  return norcow_compact_step(max_items, sectrue);
+}
+
+void storage_idle(void) {
+  uint8_t used = 0, reclaimable = 0;
+  if (sectrue != initialized || g_bSelectSEFlag) {
+    return;
+  }
+  // Start a new compaction only if it at least doubles the free space, so
+  // that a nearly full storage is not compacted over and over again.
+  norcow_get_pressure(&used, &reclaimable);
+  secbool start = (used >= COMPACT_PRESSURE && reclaimable >= 100 - used)
+                      ? sectrue
+                      : secfalse;
+  norcow_compact_step(COMPACT_IDLE_ITEMS, start);
+}
+
 void storage_wipe(void) {
   if (!g_bSelectSEFlag) {
     norcow_wipe();
     norcow_active_version = NORCOW_VERSION;
+    batch_active = secfalse;
+    batch_count = 0;
     memzero(authentication_sum, sizeof(authentication_sum));
     memzero(cached_keys, sizeof(cached_keys));
     init_wiped_storage();
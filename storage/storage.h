@@ -40,9 +40,18 @@
 
 #define FLAG_ST 0x02
 
+// The size of the chunks passed to a STORAGE_CHUNK_CALLBACK. It must be a
+// multiple of the ChaCha20 block size.
+#define STORAGE_CHUNK_SIZE 256
+
 typedef secbool (*PIN_UI_WAIT_CALLBACK)(uint32_t wait, uint32_t progress,
                                         const char *message);
 
+// Receives len bytes of a value starting at offset from storage_get_stream()
+// or fills them in for storage_set_stream().
+typedef secbool (*STORAGE_CHUNK_CALLBACK)(void *ctx, uint16_t offset,
+                                          uint8_t *chunk, uint16_t len);
+
 void storage_init(PIN_UI_WAIT_CALLBACK callback, const uint8_t *salt,
                   const uint16_t salt_len);
 void storage_wipe(void);
@@ -63,8 +72,18 @@ secbool storage_has(const uint16_t key);
 secbool storage_get(const uint16_t key, void *val, const uint16_t max_len,
                     uint16_t *len);
 secbool storage_set(const uint16_t key, const void *val, const uint16_t len);
+secbool storage_get_stream(const uint16_t key, STORAGE_CHUNK_CALLBACK cb,
+                           void *ctx, uint16_t *len);
+secbool storage_set_stream(const uint16_t key, const uint16_t len,
+                           STORAGE_CHUNK_CALLBACK cb, void *ctx);
 secbool storage_delete(const uint16_t key);
 secbool storage_set_counter(const uint16_t key, const uint32_t count);
 secbool storage_next_counter(const uint16_t key, uint32_t *count);
+secbool storage_begin_batch(void);
+secbool storage_commit_batch(void);
+void storage_abort_batch(void);
+uint8_t storage_pressure(void);
+secbool storage_compact_step(uint16_t max_items);
+void storage_idle(void);
 
 #endif
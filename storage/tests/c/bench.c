@@ -0,0 +1,237 @@
+/*
+ * This file is part of the Trezor project, https://trezor.io/
+ *
+ * Copyright (c) SatoshiLabs
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Micro-benchmark of storage_get and storage_set latency as the number of
+ * stored items grows. Build with "make bench" and compare the output of
+ * ./bench with ./bench_noindex, which is built without the norcow index.
+ *
+ * The second part estimates the worst-case storage_set latency on real flash
+ * from the number of erasures and writes, with and without compacting the
+ * storage from the idle hook.
+ *
+ * The next part compares the flash writes of a device load, which stores a
+ * dozen protected keys, with and without a storage batch.
+ *
+ * The last part counts the flash operations needed to store, update and
+ * compact values of various sizes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "flash.h"
+#include "norcow.h"
+#include "storage.h"
+
+extern const uint32_t FLASH_SIZE;
+extern uint8_t *FLASH_BUFFER;
+extern uint32_t FLASH_ERASE_COUNT;
+extern uint32_t FLASH_WRITE_COUNT;
+extern uint32_t FLASH_WRITE_BYTES;
+
+// typical STM32F4 timings of a 64 KiB sector erasure and of a single write
+#define ERASE_TIME 0.55
+#define WRITE_TIME 16e-6
+
+// public keys of app 1, they are stored without encryption
+#define BENCH_KEY(i) ((uint16_t)(((FLAG_PUBLIC | 0x01) << 8) | (i)))
+// private keys of app 1, they are encrypted and protected by the storage tag
+#define LOAD_KEY(i) ((uint16_t)((0x01 << 8) | (i)))
+#define LOAD_KEYS 12
+#define LOAD_ROUNDS 50
+#define VALUE_LEN 16
+#define ROUNDS 20
+
+static const uint8_t uid[] = {0x67, 0xce, 0x6a, 0xe8, 0xf7, 0x9b,
+                              0x73, 0x96, 0x83, 0x88, 0x21, 0x5e};
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench(int items) {
+  uint8_t val[VALUE_LEN] = {0};
+  uint16_t len = 0;
+
+  memset(FLASH_BUFFER, 0xff, FLASH_SIZE);
+  storage_init(NULL, uid, sizeof(uid));
+  storage_wipe();
+  ensure(storage_unlock(1, NULL), "unlock failed");
+  for (int i = 0; i < items; i++) {
+    memset(val, i, sizeof(val));
+    ensure(storage_set(BENCH_KEY(i), val, sizeof(val)), "set failed");
+  }
+
+  double start = now();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < items; i++) {
+      ensure(storage_get(BENCH_KEY(i), val, sizeof(val), &len), "get failed");
+    }
+  }
+  double get = (now() - start) / (ROUNDS * items);
+
+  start = now();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < items; i++) {
+      memset(val, r + i + 1, sizeof(val));
+      ensure(storage_set(BENCH_KEY(i), val, sizeof(val)), "set failed");
+    }
+  }
+  double set = (now() - start) / (ROUNDS * items);
+
+  printf("%5d items: get %8.2f us, set %8.2f us\n", items, get * 1e6,
+         set * 1e6);
+}
+
+static double flash_time(void) {
+  return FLASH_ERASE_COUNT * ERASE_TIME + FLASH_WRITE_COUNT * WRITE_TIME;
+}
+
+// overwrites 32 keys with values of pseudo-random length, calling the idle
+// hook idle_calls times after every write
+static void bench_compaction(int idle_calls) {
+  uint8_t val[256] = {0};
+  uint32_t rnd = 1;
+  double worst_set = 0, total_set = 0, worst_idle = 0;
+  int sets = 4000, slow_sets = 0;
+
+  memset(FLASH_BUFFER, 0xff, FLASH_SIZE);
+  storage_init(NULL, uid, sizeof(uid));
+  storage_wipe();
+  ensure(storage_unlock(1, NULL), "unlock failed");
+  for (int i = 0; i < sets; i++) {
+    rnd = rnd * 1103515245 + 12345;
+    uint16_t len = 16 + (rnd >> 16) % 200;
+    memset(val, i, len);
+
+    double start = flash_time();
+    ensure(storage_set(BENCH_KEY(i % 32), val, len), "set failed");
+    double t = flash_time() - start;
+    total_set += t;
+    if (t > worst_set) worst_set = t;
+    if (t >= ERASE_TIME) slow_sets++;
+
+    for (int j = 0; j < idle_calls; j++) {
+      start = flash_time();
+      storage_idle();
+      t = flash_time() - start;
+      if (t > worst_idle) worst_idle = t;
+    }
+  }
+  printf("%d idle calls: set worst %8.2f ms, mean %6.2f ms, %d sets erased a "
+         "sector, idle call worst %8.2f ms\n",
+         idle_calls, worst_set * 1e3, total_set * 1e3 / sets, slow_sets,
+         worst_idle * 1e3);
+}
+
+// stores LOAD_KEYS keys of various lengths like a device load does, on an
+// empty storage, optionally in a single batch
+static void bench_load(secbool batch) {
+  static const uint16_t lens[LOAD_KEYS] = {1,  1, 4,  4,   16, 32,
+                                           33, 1, 65, 240, 4,  1};
+  uint8_t val[256] = {0};
+  uint32_t bytes = 0, writes = 0;
+  double elapsed = 0;
+
+  for (int r = 0; r < LOAD_ROUNDS; r++) {
+    memset(FLASH_BUFFER, 0xff, FLASH_SIZE);
+    storage_init(NULL, uid, sizeof(uid));
+    storage_wipe();
+    ensure(storage_unlock(1, NULL), "unlock failed");
+
+    FLASH_WRITE_BYTES = 0;
+    FLASH_WRITE_COUNT = 0;
+    double start = now();
+    if (sectrue == batch) {
+      ensure(storage_begin_batch(), "begin failed");
+    }
+    for (int i = 0; i < LOAD_KEYS; i++) {
+      memset(val, i, lens[i]);
+      ensure(storage_set(LOAD_KEY(i), val, lens[i]), "set failed");
+    }
+    if (sectrue == batch) {
+      ensure(storage_commit_batch(), "commit failed");
+    }
+    elapsed += now() - start;
+    bytes += FLASH_WRITE_BYTES;
+    writes += FLASH_WRITE_COUNT;
+  }
+  printf("load %s: %5u bytes, %4u writes, %8.2f us, %6.2f ms on flash\n",
+         sectrue == batch ? "batched" : "single ", bytes / LOAD_ROUNDS,
+         writes / LOAD_ROUNDS, elapsed * 1e6 / LOAD_ROUNDS,
+         (double)writes / LOAD_ROUNDS * WRITE_TIME * 1e3);
+}
+
+// stores a public value of len bytes, updates it in place, overwrites it
+// with a new copy and compacts the storage, counting the flash writes of each
+// step
+static void bench_value(uint16_t len) {
+  static const uint8_t fill[] = {0x5a, 0x50, 0xa5};
+  static uint8_t val[1024];
+  uint32_t writes[4] = {0};
+
+  memset(FLASH_BUFFER, 0xff, FLASH_SIZE);
+  storage_init(NULL, uid, sizeof(uid));
+  storage_wipe();
+  ensure(storage_unlock(1, NULL), "unlock failed");
+
+  // the second value only clears bits, so it is updated in place
+  for (int i = 0; i < 3; i++) {
+    memset(val, fill[i], len);
+    FLASH_WRITE_COUNT = 0;
+    ensure(storage_set(BENCH_KEY(0), val, len), "set failed");
+    writes[i] = FLASH_WRITE_COUNT;
+  }
+
+  FLASH_WRITE_COUNT = 0;
+  while (sectrue == storage_compact_step(UINT16_MAX)) {
+  }
+  writes[3] = FLASH_WRITE_COUNT;
+
+  printf("value %4u bytes: set %4u, update %4u, overwrite %4u, compaction "
+         "%4u writes, %6.2f ms on flash\n",
+         len, writes[0], writes[1], writes[2], writes[3],
+         (writes[0] + writes[1] + writes[2] + writes[3]) * WRITE_TIME * 1e3);
+}
+
+int main(void) {
+  FLASH_BUFFER = malloc(FLASH_SIZE);
+  if (FLASH_BUFFER == NULL) {
+    return 1;
+  }
+  for (int items = 8; items <= 255; items *= 2) {
+    bench(items);
+  }
+  bench(255);
+  bench_compaction(0);
+  bench_compaction(1);
+  bench_load(secfalse);
+  bench_load(sectrue);
+  bench_value(33);
+  bench_value(240);
+  bench_value(1024);
+  free(FLASH_BUFFER);
+  return 0;
+}
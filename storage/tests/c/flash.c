@@ -54,6 +54,12 @@ static const uint32_t FLASH_SECTOR_TABLE[FLASH_SECTOR_COUNT + 1] = {
 const uint32_t FLASH_SIZE = 0x200000;
 uint8_t *FLASH_BUFFER = NULL;
 
+// The number of erased sectors, write operations and written bytes, used by
+// the benchmark.
+uint32_t FLASH_ERASE_COUNT = 0;
+uint32_t FLASH_WRITE_COUNT = 0;
+uint32_t FLASH_WRITE_BYTES = 0;
+
 void flash_init(void) {
   assert(FLASH_SIZE ==
          FLASH_SECTOR_TABLE[FLASH_SECTOR_COUNT] - FLASH_SECTOR_TABLE[0]);
@@ -86,6 +92,7 @@ secbool flash_erase_sectors(const uint8_t *sectors, int len,
     const uint32_t size =
         FLASH_SECTOR_TABLE[sector + 1] - FLASH_SECTOR_TABLE[sector];
     memset(FLASH_BUFFER + offset, 0xFF, size);
+    FLASH_ERASE_COUNT++;
     if (progress) {
       progress(i + 1, len);
     }
@@ -102,6 +109,8 @@ secbool flash_write_byte(uint8_t sector, uint32_t offset, uint8_t data) {
     return secfalse;  // we cannot change zeroes to ones
   }
   flash[0] = data;
+  FLASH_WRITE_COUNT++;
+  FLASH_WRITE_BYTES++;
   return sectrue;
 }
 
@@ -117,5 +126,44 @@ secbool flash_write_word(uint8_t sector, uint32_t offset, uint32_t data) {
     return secfalse;  // we cannot change zeroes to ones
   }
   flash[0] = data;
+  FLASH_WRITE_COUNT++;
+  FLASH_WRITE_BYTES += sizeof(data);
+  return sectrue;
+}
+
+secbool flash_write_block(uint8_t sector, uint32_t offset, const uint8_t *data,
+                          uint32_t len) {
+  uint8_t *flash = (uint8_t *)flash_get_address(sector, offset, len);
+  if (!flash) {
+    return secfalse;
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    if ((flash[i] & data[i]) != data[i]) {
+      return secfalse;  // we cannot change zeroes to ones
+    }
+  }
+  // Count the operations of the hardware implementation, which programs the
+  // unaligned head and tail in bytes and the rest in words, skipping the
+  // bytes and words that already hold the data.
+  uint32_t i = 0;
+  for (; i < len && (offset + i) % 4; i++) {
+    if (flash[i] != data[i]) {
+      FLASH_WRITE_COUNT++;
+      FLASH_WRITE_BYTES++;
+    }
+  }
+  for (; i + 4 <= len; i += 4) {
+    if (memcmp(flash + i, data + i, 4) != 0) {
+      FLASH_WRITE_COUNT++;
+      FLASH_WRITE_BYTES += 4;
+    }
+  }
+  for (; i < len; i++) {
+    if (flash[i] != data[i]) {
+      FLASH_WRITE_COUNT++;
+      FLASH_WRITE_BYTES++;
+    }
+  }
+  memcpy(flash, data, len);
   return sectrue;
 }
@@ -40,5 +40,9 @@ static inline secbool flash_erase(uint8_t sector) {
 }
 secbool __wur flash_write_byte(uint8_t sector, uint32_t offset, uint8_t data);
 secbool __wur flash_write_word(uint8_t sector, uint32_t offset, uint32_t data);
+// Writes len bytes of data starting at offset, the aligned part in words.
+// Fails without writing anything if a bit would have to change from 0 to 1.
+secbool __wur flash_write_block(uint8_t sector, uint32_t offset,
+                                const uint8_t *data, uint32_t len);
 
 #endif
@@ -39,6 +39,14 @@
 #error Unknown Trezor model
 #endif
 
+/*
+ * The maximum number of keys in the RAM index of the norcow sector, every
+ * entry takes 4 bytes of RAM.
+ */
+#ifndef NORCOW_INDEX_SIZE
+#define NORCOW_INDEX_SIZE 512
+#endif
+
 /*
  * Current storage version.
  */
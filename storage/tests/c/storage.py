@@ -4,6 +4,9 @@ import os
 EXTERNAL_SALT_LEN = 32
 sectrue = -1431655766  # 0xAAAAAAAAA
 fname = os.path.join(os.path.dirname(__file__), "libtrezor-storage.so")
+CHUNK_CALLBACK = c.CFUNCTYPE(
+    c.c_int, c.c_void_p, c.c_uint16, c.POINTER(c.c_uint8), c.c_uint16
+)
 
 
 class Storage:
@@ -65,6 +68,36 @@ class Storage:
         if sectrue != self.lib.storage_set(c.c_uint16(key), val, c.c_uint16(len(val))):
             raise RuntimeError("Failed to set value in storage.")
 
+    def get_stream(self, key: int) -> list:
+        chunks = []
+
+        def cb(ctx, offset, chunk, length):
+            chunks.append((offset, c.string_at(chunk, length)))
+            return sectrue
+
+        val_len = c.c_uint16()
+        if sectrue != self.lib.storage_get_stream(
+            c.c_uint16(key), CHUNK_CALLBACK(cb), None, c.byref(val_len)
+        ):
+            raise RuntimeError("Failed to get value from storage.")
+        return chunks
+
+    def set_stream(self, key: int, val: bytes, fail_at: int = None) -> list:
+        offsets = []
+
+        def cb(ctx, offset, chunk, length):
+            if offset == fail_at:
+                return 0
+            offsets.append(offset)
+            c.memmove(chunk, val[offset : offset + length], length)
+            return sectrue
+
+        if sectrue != self.lib.storage_set_stream(
+            c.c_uint16(key), c.c_uint16(len(val)), CHUNK_CALLBACK(cb), None
+        ):
+            raise RuntimeError("Failed to set value in storage.")
+        return offsets
+
     def set_counter(self, key: int, count: int) -> bool:
         return sectrue == self.lib.storage_set_counter(
             c.c_uint16(key), c.c_uint32(count)
@@ -80,6 +113,24 @@ class Storage:
     def delete(self, key: int) -> bool:
         return sectrue == self.lib.storage_delete(c.c_uint16(key))
 
+    def begin_batch(self) -> bool:
+        return sectrue == self.lib.storage_begin_batch()
+
+    def commit_batch(self) -> bool:
+        return sectrue == self.lib.storage_commit_batch()
+
+    def abort_batch(self) -> None:
+        self.lib.storage_abort_batch()
+
+    def pressure(self) -> int:
+        return self.lib.storage_pressure()
+
+    def compact_step(self, max_items: int) -> bool:
+        return sectrue == self.lib.storage_compact_step(c.c_uint16(max_items))
+
+    def idle(self) -> None:
+        self.lib.storage_idle()
+
     def _dump(self) -> bytes:
         # return just sectors 4 and 16 of the whole flash
         return [
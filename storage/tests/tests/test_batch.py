@@ -0,0 +1,152 @@
+import pytest
+
+from c.storage import Storage as StorageC
+
+from . import common
+
+
+def reboot(flash: bytes) -> StorageC:
+    # All instances share the library, so the previous one must not be used
+    # after the reboot.
+    sc = StorageC()
+    sc._set_flash_buffer(flash)
+    sc.init(common.test_uid)
+    assert sc.unlock(1)
+    return sc
+
+
+def test_batch_commit():
+    sc, _ = common.init(unlock=True)
+    sc.set(0x0101, b"old")
+    sc.set(0x0102, b"deleted")
+    sc.set(0x8103, b"public")
+    assert sc.begin_batch()
+    assert not sc.begin_batch()
+    sc.set(0x0101, b"new")
+    sc.set(0x0101, b"newer")
+    sc.set(0x0104, b"added")
+    assert sc.delete(0x0102)
+    assert not sc.delete(0x0102)
+    assert not sc.delete(0x0105)
+    sc.set(0x8103, b"changed")
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
+    assert sc.get(0x0101) == b"newer"
+    assert sc.commit_batch()
+    assert not sc.commit_batch()
+
+    assert sc.get(0x0101) == b"newer"
+    assert sc.get(0x0104) == b"added"
+    assert sc.get(0x8103) == b"changed"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
+
+    # The old values are gone after a compaction.
+    assert sc.compact_step(0xFFFF)
+    while sc.compact_step(0xFFFF):
+        pass
+    assert sc.pressure() < 10
+
+    sc = reboot(sc._get_flash_buffer())
+    assert sc.get(0x0101) == b"newer"
+    assert sc.get(0x0104) == b"added"
+    assert sc.get(0x8103) == b"changed"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
+
+
+def test_batch_delete_and_set():
+    sc, _ = common.init(unlock=True)
+    sc.set(0x0101, b"old")
+    assert sc.begin_batch()
+    assert sc.delete(0x0101)
+    sc.set(0x0101, b"new")
+    sc.set(0x0102, b"added")
+    assert sc.delete(0x0102)
+    assert sc.commit_batch()
+
+    sc = reboot(sc._get_flash_buffer())
+    assert sc.get(0x0101) == b"new"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
+
+
+def test_batch_abort():
+    sc, _ = common.init(unlock=True)
+    sc.set(0x0101, b"old")
+    sc.set(0x0102, b"kept")
+    assert sc.begin_batch()
+    sc.set(0x0101, b"new")
+    sc.set(0x0103, b"added")
+    assert sc.delete(0x0102)
+    sc.abort_batch()
+    assert sc.get(0x0101) == b"old"
+    assert sc.get(0x0102) == b"kept"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0103)
+
+    # Locking the storage aborts the batch as well.
+    assert sc.begin_batch()
+    sc.set(0x0101, b"new")
+    sc.lock()
+    assert not sc.commit_batch()
+    assert sc.unlock(1)
+    assert sc.get(0x0101) == b"old"
+
+    sc = reboot(sc._get_flash_buffer())
+    assert sc.get(0x0101) == b"old"
+    assert sc.get(0x0102) == b"kept"
+
+
+def test_batch_power_loss():
+    sc, _ = common.init(unlock=True)
+    sc.set(0x0101, b"old")
+    sc.set(0x0102, b"kept")
+    assert sc.begin_batch()
+    snapshots = [sc._get_flash_buffer()]
+    sc.set(0x0101, b"new")
+    snapshots.append(sc._get_flash_buffer())
+    sc.set(0x0103, b"added")
+    snapshots.append(sc._get_flash_buffer())
+    assert sc.delete(0x0102)
+    snapshots.append(sc._get_flash_buffer())
+    assert sc.commit_batch()
+    committed = sc._get_flash_buffer()
+
+    # A batch interrupted before the commit is rolled back.
+    for flash in snapshots:
+        sc = reboot(flash)
+        assert sc.get(0x0101) == b"old"
+        assert sc.get(0x0102) == b"kept"
+        with pytest.raises(RuntimeError):
+            sc.get(0x0103)
+        sc.set(0x0104, b"after")
+        sc = reboot(sc._get_flash_buffer())
+        assert sc.get(0x0104) == b"after"
+
+    sc = reboot(committed)
+    assert sc.get(0x0101) == b"new"
+    assert sc.get(0x0103) == b"added"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
+
+
+def test_batch_journal_full():
+    sc, _ = common.init(unlock=True)
+    sc.set(0x0101, b"old")
+    assert sc.begin_batch()
+    sc.set(0x0101, b"new")
+    # One key more than the journal holds fails and so does the commit.
+    for key in range(0x0102, 0x0102 + 31):
+        sc.set(key, b"added")
+    with pytest.raises(RuntimeError):
+        sc.set(0x0102 + 31, b"lost")
+    assert not sc.commit_batch()
+    assert sc.get(0x0101) == b"old"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
+
+    sc = reboot(sc._get_flash_buffer())
+    assert sc.get(0x0101) == b"old"
+    with pytest.raises(RuntimeError):
+        sc.get(0x0102)
@@ -1,5 +1,6 @@
 import pytest
 
+from c.storage import Storage as StorageC
 from python.src import consts
 
 from . import common
@@ -30,3 +31,75 @@ def test_compact():
             s.set(0x0101, b"a" * (consts.NORCOW_SECTOR_SIZE - 100))
         s.set(0x0101, b"hello")
     assert common.memory_equals(sc, sp)
+
+
+def test_compact_incremental():
+    sc, sp = common.init(unlock=True)
+    for s in (sc, sp):
+        s.set(0xBEEF, b"hello")
+        s.set(0xBEEF, b"asdasdasdasd")
+        s.set(0x0101, b"a" * 1000)
+        s.set(0x03FE, b"world!")
+        s.set(0x0101, b"s")
+        s.set_counter(0x8002, 5)
+    assert sc.pressure() > 0
+
+    # The erasure is one step, then every step copies a single item.
+    steps = 1
+    while sc.compact_step(1):
+        steps += 1
+        assert sc.get(0xBEEF) == b"asdasdasdasd"
+    assert steps > 3
+    sp.nc._compact()
+    assert common.memory_equals(sc, sp)
+    assert not sc.compact_step(1)
+
+
+def test_compact_interleaved():
+    sc, sp = common.init(unlock=True)
+    for s in (sc, sp):
+        for i in range(20):
+            s.set(0x0100 + i, bytes([i]) * (i + 1))
+        s.set_counter(0x8002, 5)
+        s.set(0x0105, b"new value")
+    assert sc.compact_step(1)  # erase
+    assert sc.compact_step(10)
+
+    # Change items that have and have not been copied yet.
+    for s in (sc, sp):
+        s.set(0x0101, b"updated")
+        s.set(0x0102, b"\x02\x02\x02")
+        s.delete(0x0103)
+        s.set(0x0110, b"x" * 100)
+        s.delete(0x0111)
+        s.set(0x0200, b"appended")
+        assert s.next_counter(0x8002) == 6
+
+    # An interrupted compaction must leave the storage intact.
+    flash = sc._get_flash_buffer()
+    while sc.compact_step(3):
+        assert sc.next_counter(0x8002) == sp.next_counter(0x8002)
+    assert sc.pressure() < 10
+
+    for s in (sc, sp):
+        s.delete(0x0104)
+    for key in [0x0200, 0x8002] + [0x0100 + i for i in range(20)]:
+        if key in (0x0103, 0x0104, 0x0111):
+            with pytest.raises(RuntimeError):
+                sc.get(key)
+        else:
+            assert sc.get(key) == sp.get(key)
+
+    sc1 = StorageC()
+    sc1._set_flash_buffer(sc._get_flash_buffer())
+    sc1.init(common.test_uid)
+    assert sc1.unlock(1)
+    assert sc1.get(0x0101) == b"updated"
+    assert sc1.get(0x0200) == b"appended"
+
+    sc2 = StorageC()
+    sc2._set_flash_buffer(flash)
+    sc2.init(common.test_uid)
+    assert sc2.unlock(1)
+    assert sc2.get(0x0101) == b"updated"
+    assert sc2.next_counter(0x8002) == 7
@@ -0,0 +1,58 @@
+import pytest
+
+from . import common
+
+CHUNK_SIZE = 256
+
+
+def test_stream_set_get():
+    for key in (0x0101, 0x8101):
+        for length in (0, 1, CHUNK_SIZE, CHUNK_SIZE + 1, 5000):
+            val = bytes(i % 251 for i in range(length))
+            sc, sp = common.init(unlock=True)
+            offsets = sc.set_stream(key, val)
+            assert offsets == list(range(0, length, CHUNK_SIZE))
+            sp.set(key, val)
+            # The streamed value is stored exactly like a regular one.
+            assert common.memory_equals(sc, sp)
+            assert sc.get(key) == val
+
+            chunks = sc.get_stream(key)
+            assert [offset for offset, _ in chunks] == offsets
+            assert all(len(chunk) <= CHUNK_SIZE for _, chunk in chunks)
+            assert b"".join(chunk for _, chunk in chunks) == val
+
+
+def test_stream_get_regular():
+    sc, _ = common.init(unlock=True)
+    val = b"x" * 3000
+    sc.set(0x0102, val)
+    assert b"".join(chunk for _, chunk in sc.get_stream(0x0102)) == val
+    with pytest.raises(RuntimeError):
+        sc.get_stream(0x0103)
+
+    sc.lock()
+    with pytest.raises(RuntimeError):
+        sc.get_stream(0x0102)
+
+
+def test_stream_failure():
+    sc, _ = common.init(unlock=True)
+    sc.set(0x0101, b"old")
+    with pytest.raises(RuntimeError):
+        sc.set_stream(0x0101, b"y" * 1000, fail_at=2 * CHUNK_SIZE)
+    with pytest.raises(RuntimeError):
+        sc.get(0x0101)
+    sc.set(0x0102, b"kept")
+    assert sc.get(0x0102) == b"kept"
+
+
+def test_stream_too_long():
+    for key in (0x0101, 0x8101):
+        sc, _ = common.init(unlock=True)
+        sc.set(key, b"precious")
+        # The value cannot be allocated, so nothing was written and the old
+        # value must be kept.
+        with pytest.raises(RuntimeError):
+            sc.set_stream(key, b"y" * 65530)
+        assert sc.get(key) == b"precious"
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2020 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+"""Measure the signing of Ethereum transactions with large data.
+
+A contract deployment with the given data lengths is signed once for every
+chunk window and the number of round trips (responses read from the device)
+and the wall time are printed.
+"""
+
+import shutil
+import tempfile
+import time
+from pathlib import Path
+
+import click
+
+from trezorlib import debuglink, device, ethereum
+from trezorlib.tools import parse_path
+
+from bench_signtx import CORE_EXECUTABLE, LEGACY_EXECUTABLE, make_emulator
+
+
+def sign(client, data, chunk_window):
+    reads = 0
+    raw_read = client._raw_read
+
+    def counting_read():
+        nonlocal reads
+        reads += 1
+        return raw_read()
+
+    client._raw_read = counting_read
+    try:
+        start = time.monotonic()
+        sig = ethereum.sign_tx(
+            client,
+            n=parse_path("44'/60'/0'/0/0"),
+            nonce=0,
+            gas_price=20000,
+            gas_limit=20000,
+            to="",
+            value=0,
+            data=data,
+            chain_id=1,
+            chunk_window=chunk_window,
+        )
+        elapsed = time.monotonic() - start
+    finally:
+        client._raw_read = raw_read
+    return sig, reads, elapsed
+
+
+@click.command()
+# fmt: off
+@click.option("-g", "--gen", type=click.Choice(["core", "legacy"]), default="legacy", help="Emulator generation")
+@click.option("-e", "--executable", type=click.Path(exists=True, dir_okay=False), help="Emulator executable")
+@click.option("-l", "--data-length", "lengths", type=click.IntRange(1, None), multiple=True, default=[4096, 65536, 262144, 524288], help="Data lengths in bytes")
+@click.option("-w", "--chunk-window", "windows", type=int, multiple=True, default=[1, 4, 16], help="Chunk windows to compare")
+# fmt: on
+def cli(gen, executable, lengths, windows):
+    if executable is None:
+        executable = CORE_EXECUTABLE if gen == "core" else LEGACY_EXECUTABLE
+
+    workdir = Path(tempfile.mkdtemp(prefix="trezor-bench-"))
+    try:
+        with make_emulator(gen, Path(executable), workdir) as emu:
+            emu.start()
+            client = emu.client
+            device.wipe(client)
+            debuglink.load_device(
+                client,
+                mnemonic=" ".join(["all"] * 12),
+                pin=None,
+                passphrase_protection=False,
+                label="bench",
+            )
+            client.init_device()
+
+            for length in lengths:
+                data = bytes(i & 0xFF for i in range(length))
+                expected = None
+                for window in windows:
+                    sig, reads, elapsed = sign(client, data, window)
+                    # the window must not change the result
+                    if expected is None:
+                        expected = sig
+                    elif sig != expected:
+                        raise click.ClickException(
+                            "Chunk window {} produced a different signature".format(
+                                window
+                            )
+                        )
+                    click.echo(
+                        "{:7d} bytes, chunk window {:2d}: {:4d} round trips, "
+                        "{:7.2f} s, {:6.1f} kB/s".format(
+                            length, window, reads, elapsed, length / elapsed / 1000
+                        )
+                    )
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    cli()
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2020 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+"""Measure the signing of large legacy transactions.
+
+The transactions spend the outputs of the 100-output mainnet transaction
+4a7b7e from the test cache, the larger ones spend them repeatedly. Every input
+requests the whole previous transaction and, unless the device keeps a copy
+of the transaction, all inputs and outputs again in phase 2. Each transaction
+is signed once for every batch size and the number of round trips (responses
+read from the device) and the wall time are printed.
+"""
+
+import shutil
+import tempfile
+import time
+from pathlib import Path
+
+import click
+
+from trezorlib import btc, debuglink, device, messages
+from trezorlib._internal.emulator import CoreEmulator, LegacyEmulator
+from trezorlib.tools import parse_path, tx_hash
+
+from tx_cache import TxCache
+
+ROOT = Path(__file__).parent.parent.resolve()
+CORE_EXECUTABLE = ROOT / "core" / "build" / "unix" / "micropython"
+LEGACY_EXECUTABLE = ROOT / "legacy" / "firmware" / "bixin.elf"
+CORE_SRC_DIR = ROOT / "core" / "src"
+
+TXHASH_4a7b7e = bytes.fromhex(
+    "4a7b7e0403ae5607e473949cfa03f09f2cd8b0f404bf99ce10b7303d86280bf7"
+)
+
+
+def make_emulator(gen, executable, profile_dir):
+    if gen == "core":
+        return CoreEmulator(
+            executable, profile_dir, workdir=CORE_SRC_DIR, headless=True, debug=True
+        )
+    else:
+        return LegacyEmulator(executable, profile_dir, headless=True, debug=True)
+
+
+def make_tx(count):
+    inputs = [
+        messages.TxInputType(
+            address_n=parse_path(f"44h/0h/0h/0/{i}"),
+            prev_hash=TXHASH_4a7b7e,
+            prev_index=i % 100,
+        )
+        for i in range(count)
+    ]
+    out = messages.TxOutputType(
+        address="19dvDdyxxptP9dGvozYe8BP6tgFV9L4jg5",
+        amount=count * 26000 - 15 * 10000,
+        script_type=messages.OutputScriptType.PAYTOADDRESS,
+    )
+    return inputs, [out]
+
+
+def sign(client, inputs, outputs, batch_size):
+    reads = 0
+    raw_read = client._raw_read
+
+    def counting_read():
+        nonlocal reads
+        reads += 1
+        return raw_read()
+
+    client._raw_read = counting_read
+    try:
+        start = time.monotonic()
+        _, serialized_tx = btc.sign_tx(
+            client,
+            "Bitcoin",
+            inputs,
+            outputs,
+            details=messages.SignTx(batch_size=batch_size),
+            prev_txes=TxCache("Bitcoin"),
+        )
+        elapsed = time.monotonic() - start
+    finally:
+        client._raw_read = raw_read
+    return serialized_tx, reads, elapsed
+
+
+@click.command()
+# fmt: off
+@click.option("-g", "--gen", type=click.Choice(["core", "legacy"]), default="legacy", help="Emulator generation")
+@click.option("-e", "--executable", type=click.Path(exists=True, dir_okay=False), help="Emulator executable")
+@click.option("-i", "--inputs", "counts", type=click.IntRange(10, 1000), multiple=True, default=[10, 50, 200], help="Numbers of inputs")
+@click.option("-b", "--batch-size", "batch_sizes", type=int, multiple=True, default=[1, 64], help="Batch sizes to compare")
+# fmt: on
+def cli(gen, executable, counts, batch_sizes):
+    if executable is None:
+        executable = CORE_EXECUTABLE if gen == "core" else LEGACY_EXECUTABLE
+
+    workdir = Path(tempfile.mkdtemp(prefix="trezor-bench-"))
+    try:
+        with make_emulator(gen, Path(executable), workdir) as emu:
+            emu.start()
+            client = emu.client
+            device.wipe(client)
+            debuglink.load_device(
+                client,
+                mnemonic=" ".join(["all"] * 12),
+                pin=None,
+                passphrase_protection=False,
+                label="bench",
+            )
+            client.init_device()
+
+            for count in counts:
+                inputs, outputs = make_tx(count)
+                txid = None
+                for batch_size in batch_sizes:
+                    serialized_tx, reads, elapsed = sign(
+                        client, inputs, outputs, batch_size
+                    )
+                    # batching must not change the result
+                    if txid is None:
+                        txid = tx_hash(serialized_tx)
+                    elif tx_hash(serialized_tx) != txid:
+                        raise click.ClickException(
+                            "Batch size {} produced a different transaction".format(
+                                batch_size
+                            )
+                        )
+                    click.echo(
+                        "{:4d} inputs, batch size {:3d}: {:6d} round trips, "
+                        "{:7.2f} s".format(count, batch_size, reads, elapsed)
+                    )
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    cli()
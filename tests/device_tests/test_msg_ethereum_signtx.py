@@ -296,6 +296,43 @@ class TestMsgEthereumSigntx:
             == "60a77558f28d483d476f9507cd8a6a4bb47b86611aaff95fd5499b9ee9ebe7ee"
         )
 
+    @pytest.mark.setup_client(mnemonic=MNEMONIC12)
+    def test_ethereum_signtx_data_window(self, client):
+        # the same transaction as in test_ethereum_signtx_data, with two
+        # chunks requested at once
+        with client:
+            client.set_expected_responses(
+                [
+                    messages.ButtonRequest(code=messages.ButtonRequestType.SignTx),
+                    messages.ButtonRequest(code=messages.ButtonRequestType.SignTx),
+                    messages.ButtonRequest(code=messages.ButtonRequestType.SignTx),
+                    messages.EthereumTxRequest(data_length=1024, chunk_count=2),
+                    messages.EthereumTxRequest(data_length=1024, chunk_count=2),
+                    messages.EthereumTxRequest(),
+                ]
+            )
+
+            sig_v, sig_r, sig_s = ethereum.sign_tx(
+                client,
+                n=parse_path("44'/60'/0'/0/0"),
+                nonce=123456,
+                gas_price=20000,
+                gas_limit=20000,
+                to=TO_ADDR,
+                value=12345678901234567890,
+                data=b"ABCDEFGHIJKLMNOP" * 256 + b"!!!",
+                chunk_window=2,
+            )
+        assert sig_v == 27
+        assert (
+            sig_r.hex()
+            == "dd96d82d791118a55601dfcede237760d2e9734b76c373ede5362a447c42ac48"
+        )
+        assert (
+            sig_s.hex()
+            == "60a77558f28d483d476f9507cd8a6a4bb47b86611aaff95fd5499b9ee9ebe7ee"
+        )
+
     @pytest.mark.setup_client(mnemonic=MNEMONIC12)
     def test_ethereum_signtx_message(self, client):
         with client:
@@ -450,6 +450,57 @@ class TestMsgSigntx:
             == "f90cdc2224366312be28166e2afe198ece7a60e86e25f5a50f5b14d811713da8"
         )
 
+    @pytest.mark.skip_ui
+    @pytest.mark.slow
+    @pytest.mark.parametrize("batch_size", (2, 7, 64))
+    def test_lots_of_inputs_batched(self, client, monkeypatch, batch_size):
+        # Same as test_lots_of_inputs, with several inputs and outputs requested
+        # at once. Devices without batch mode ignore batch_size.
+        requests = []
+        raw_read = client._raw_read
+
+        def recording_read():
+            resp = raw_read()
+            if isinstance(resp, proto.TxRequest) and resp.details:
+                requests.append(resp.details.request_count or 1)
+            return resp
+
+        monkeypatch.setattr(client, "_raw_read", recording_read)
+
+        inputs = []
+        for i in range(100):
+            inputs.append(
+                proto.TxInputType(
+                    address_n=parse_path(f"44h/0h/0h/0/{i}"),
+                    prev_hash=TXHASH_4a7b7e,
+                    prev_index=i,
+                )
+            )
+        out = proto.TxOutputType(
+            address="19dvDdyxxptP9dGvozYe8BP6tgFV9L4jg5",
+            amount=100 * 26000 - 15 * 10000,
+            script_type=proto.OutputScriptType.PAYTOADDRESS,
+        )
+        _, serialized_tx = btc.sign_tx(
+            client,
+            "Bitcoin",
+            inputs,
+            [out],
+            details=proto.SignTx(batch_size=batch_size),
+            prev_txes=TX_CACHE_MAINNET,
+        )
+        assert (
+            tx_hash(serialized_tx).hex()
+            == "f90cdc2224366312be28166e2afe198ece7a60e86e25f5a50f5b14d811713da8"
+        )
+
+        # The 100 outputs of the previous transaction and the 100 inputs in
+        # phase 2 fill whole batches.
+        if client.features.model == "1":
+            assert max(requests) == batch_size
+        else:
+            assert max(requests) == 1
+
     @pytest.mark.skip_ui
     @pytest.mark.slow
     def test_lots_of_outputs(self, client):
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+
+# This file is part of the Trezor project.
+#
+# Copyright (C) 2012-2020 SatoshiLabs and contributors
+#
+# This library is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3
+# as published by the Free Software Foundation.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the License along with this library.
+# If not, see <https://www.gnu.org/licenses/lgpl-3.0.html>.
+
+"""Run a farm of headless emulators for load tests.
+
+All instances map the same flash template copy-on-write, so their storage
+changes are private and discarded at exit, and they listen on automatically
+allocated UDP ports. The ports are printed once every instance is ready,
+together with the startup times, and the farm runs until interrupted.
+"""
+
+import shutil
+import signal
+import statistics
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+import click
+
+from trezorlib._internal.emulator import CoreEmulator, LegacyEmulator
+
+ROOT = Path(__file__).parent.parent.resolve()
+CORE_EXECUTABLE = ROOT / "core" / "build" / "unix" / "micropython"
+LEGACY_EXECUTABLE = ROOT / "legacy" / "firmware" / "bixin.elf"
+CORE_SRC_DIR = ROOT / "core" / "src"
+
+
+def make_emulator(gen, executable, profile_dir, **kwargs):
+    if gen == "core":
+        return CoreEmulator(
+            executable,
+            profile_dir,
+            workdir=CORE_SRC_DIR,
+            headless=True,
+            debug=True,
+            **kwargs
+        )
+    else:
+        return LegacyEmulator(
+            executable, profile_dir, headless=True, debug=True, **kwargs
+        )
+
+
+def prepare_template(gen, executable, workdir, template):
+    """Boot a single instance on a fresh flash and keep it as the template."""
+    profile_dir = workdir / "template"
+    with make_emulator(gen, executable, profile_dir, port=0) as emu:
+        emu.start()
+        emu.stop()
+        shutil.copyfile(emu.storage, template)
+
+
+@click.command()
+# fmt: off
+@click.option("-g", "--gen", type=click.Choice(["core", "legacy"]), default="core", help="Emulator generation")
+@click.option("-e", "--executable", type=click.Path(exists=True, dir_okay=False), help="Emulator executable")
+@click.option("-n", "--count", type=int, default=16, help="Number of instances")
+@click.option("-j", "--jobs", type=int, default=8, help="Instances started in parallel")
+@click.option("-t", "--template", type=click.Path(dir_okay=False), help="Flash template, created if it does not exist")
+@click.option("-x", "--exit", "exit_when_ready", is_flag=True, help="Stop the farm once all instances are ready")
+# fmt: on
+def cli(gen, executable, count, jobs, template, exit_when_ready):
+    if executable is None:
+        executable = CORE_EXECUTABLE if gen == "core" else LEGACY_EXECUTABLE
+    executable = Path(executable)
+
+    workdir = Path(tempfile.mkdtemp(prefix="trezor-farm-"))
+    emulators = []
+    try:
+        template = Path(template) if template else workdir / "flash.template"
+        if not template.exists():
+            prepare_template(gen, executable, workdir, template)
+
+        emulators = [
+            make_emulator(
+                gen,
+                executable,
+                workdir / str(i),
+                port=0,
+                flash_template=template,
+                logfile=workdir / "{}.log".format(i),
+            )
+            for i in range(count)
+        ]
+
+        start = time.monotonic()
+        with ThreadPoolExecutor(max_workers=jobs) as pool:
+            list(pool.map(lambda emu: emu.start(), emulators))
+        total = time.monotonic() - start
+
+        times = [emu.startup_time for emu in emulators]
+        for i, emu in enumerate(emulators):
+            click.echo("{:4d}: udp:127.0.0.1:{}".format(i, emu.port))
+        click.echo(
+            "{} instances ready in {:.2f} s, startup min {:.3f} s, "
+            "median {:.3f} s, max {:.3f} s".format(
+                count, total, min(times), statistics.median(times), max(times)
+            )
+        )
+
+        if not exit_when_ready:
+            try:
+                signal.pause()
+            except KeyboardInterrupt:
+                pass
+    finally:
+        for emu in emulators:
+            emu.stop()
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    cli()